@@ -0,0 +1,130 @@
+// -----------------------------------------------------------------------------
+// File:    FramerBench.cpp
+// Created: 10-17-2026
+//
+// Packet framer throughput. Replays a synthetic stream of telemetry and MJPEG
+// packets through the framer in socket sized chunks and reports packets/s.
+// -----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "PacketFramer.h"
+#include "Utility.h"
+#include "uav_protocol.h"
+
+#define BENCH_STREAM_SECONDS    10      // seconds of simulated traffic
+#define BENCH_PASSES            20      // replays of that traffic per run
+
+struct TrafficMix
+{
+    const char *name;
+    int frame_rate;     // MJPEG frames per second
+    int frame_min;      // frame size range in bytes
+    int frame_max;
+    int telem_rate;     // telemetry packets per second
+};
+
+static const TrafficMix g_mixes[] =
+{
+    { "video heavy",     30, 30000, 60000,  50 },
+    { "telemetry heavy",  5, 30000, 60000, 200 },
+    { "telemetry only",   0,     0,     0, 1000 },
+};
+
+static const size_t g_chunks[] = { 1460, 16384, 65536 };
+
+// -----------------------------------------------------------------------------
+static void appendPacket(std::vector<char> &stream, uint32_t command,
+        uint32_t length)
+{
+    size_t offset = stream.size();
+    stream.resize(offset + length, (char)0xA5);
+    uint32_t *words = (uint32_t *)&stream[offset];
+    words[PKT_COMMAND] = command;
+    words[PKT_LENGTH]  = length;
+}
+
+// -----------------------------------------------------------------------------
+static size_t buildStream(const TrafficMix &mix, std::vector<char> &stream)
+{
+    // interleave the two channels on a 1 ms grid as the vehicle would
+    size_t packets = 0;
+    for (int ms = 0; ms < BENCH_STREAM_SECONDS * 1000; ++ms)
+    {
+        if (mix.telem_rate && 0 == (ms % (1000 / mix.telem_rate)))
+        {
+            appendPacket(stream, SERVER_ACK_TELEMETRY, PKT_VTI_LENGTH);
+            ++packets;
+        }
+
+        if (mix.frame_rate && 0 == (ms % (1000 / mix.frame_rate)))
+        {
+            int size = mix.frame_min + rand() % (mix.frame_max - mix.frame_min);
+            appendPacket(stream, SERVER_ACK_MJPG_FRAME,
+                    PKT_MJPG_LENGTH + (size & ~3));
+            ++packets;
+        }
+    }
+    return packets;
+}
+
+// -----------------------------------------------------------------------------
+static void runMix(const TrafficMix &mix, size_t chunk)
+{
+    std::vector<char> stream;
+    size_t expected = buildStream(mix, stream) * BENCH_PASSES;
+
+    PacketFramer framer;
+    PacketView view;
+    size_t packets = 0, checksum = 0;
+
+    uint64_t start = MonotonicMicros();
+    for (int pass = 0; pass < BENCH_PASSES; ++pass)
+    {
+        size_t offset = 0;
+        while (offset < stream.size())
+        {
+            // emulate one readyRead(), copying at most one segment in
+            size_t avail;
+            char *dst = framer.prepare(avail);
+            size_t count = std::min(std::min(avail, chunk),
+                    stream.size() - offset);
+            memcpy(dst, &stream[offset], count);
+            framer.commit(count);
+            offset += count;
+
+            // touch the payload the way the controller does
+            while (framer.next(view))
+            {
+                checksum += view.command() + view.words[view.length / 4 - 1];
+                ++packets;
+            }
+        }
+    }
+    uint64_t elapsed = MonotonicMicros() - start;
+
+    double seconds = elapsed / 1e6;
+    double bytes = (double)stream.size() * BENCH_PASSES;
+    printf("%-16s %6u B chunks: %10.0f pkts/s %9.1f MB/s  (%s, checksum %lu)\n",
+            mix.name, (unsigned)chunk, packets / seconds,
+            bytes / seconds / (1024.0 * 1024.0),
+            (packets == expected && !framer.error()) ? "ok" : "MISMATCH",
+            (unsigned long)checksum);
+}
+
+// -----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    srand(1);
+    for (size_t m = 0; m < sizeof(g_mixes) / sizeof(g_mixes[0]); ++m)
+        for (size_t c = 0; c < sizeof(g_chunks) / sizeof(g_chunks[0]); ++c)
+            runMix(g_mixes[m], g_chunks[c]);
+
+    return 0;
+}
@@ -0,0 +1,129 @@
+// -----------------------------------------------------------------------------
+// File:    LoggerBench.cpp
+// Created: 10-17-2026
+//
+// Logger throughput. Several threads log as fast as they can and the harness
+// reports calls/s seen by the callers, messages/s delivered by the logger
+// thread, and how many were dropped to full rings. Covers messages filtered
+// out by level, deferred formatting and messages built by the caller.
+// -----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <vector>
+#include <QCoreApplication>
+#include <QThread>
+#include <cstdio>
+#include "Logger.h"
+#include "LoggerBench.h"
+#include "Utility.h"
+
+#define BENCH_MESSAGES      200000  // per thread
+#define BENCH_DRAIN_MS      5000    // longest wait for the logger to catch up
+
+enum BenchMode
+{
+    MODE_FILTERED,      // debug messages while only info is logged
+    MODE_DEFERRED,      // format and arguments, built by the logger thread
+    MODE_EAGER,         // QString built by the caller
+    MODE_COUNT
+};
+
+static const char *g_modes[MODE_COUNT] = { "filtered", "deferred", "eager" };
+static const int   g_threads[] = { 1, 2, 4, 8 };
+
+// -----------------------------------------------------------------------------
+class BenchProducer: public QThread
+{
+public:
+    BenchProducer(BenchMode mode) : m_mode(mode), m_elapsed(0) { }
+
+    virtual void run()
+    {
+        uint64_t start = MonotonicMicros();
+        for (int i = 0; i < BENCH_MESSAGES; ++i)
+        {
+            switch (m_mode)
+            {
+            case MODE_FILTERED:
+                Logger::dbg("sample %1 of %2 at %3\n", i, BENCH_MESSAGES, i * 0.01);
+                break;
+            case MODE_DEFERRED:
+                Logger::log(LOG_TYPE_INFO, "sample %1 of %2 at %3\n",
+                        i, BENCH_MESSAGES, i * 0.01);
+                break;
+            default:
+                Logger::info(QString("sample %1 of %2 at %3\n")
+                        .arg(i).arg(BENCH_MESSAGES).arg(i * 0.01));
+                break;
+            }
+        }
+        m_elapsed = MonotonicMicros() - start;
+    }
+
+    uint64_t elapsed() const { return m_elapsed; }
+
+protected:
+    BenchMode m_mode;
+    uint64_t  m_elapsed;
+};
+
+// -----------------------------------------------------------------------------
+static void runMode(BenchMode mode, int threads, DeliveryCounter &counter)
+{
+    Logger *logger = Logger::instance();
+    int dropped = logger->dropped();
+    counter.reset();
+
+    std::vector<BenchProducer *> producers;
+    for (int t = 0; t < threads; ++t)
+        producers.push_back(new BenchProducer(mode));
+
+    uint64_t start = MonotonicMicros();
+    for (int t = 0; t < threads; ++t)
+        producers[t]->start();
+
+    uint64_t calls = 0;
+    for (int t = 0; t < threads; ++t)
+    {
+        producers[t]->wait();
+        calls = std::max(calls, producers[t]->elapsed());
+        delete producers[t];
+    }
+
+    // wait for everything that made it into a ring to come out the other end
+    int total = threads * BENCH_MESSAGES;
+    int expected = (MODE_FILTERED == mode) ? 0 : total;
+    uint64_t deadline = MonotonicMicros() + BENCH_DRAIN_MS * 1000;
+    while (counter.count() + (logger->dropped() - dropped) < expected &&
+           MonotonicMicros() < deadline)
+    {
+        QThread::yieldCurrentThread();
+    }
+    uint64_t elapsed = MonotonicMicros() - start;
+
+    // the drop warning itself is delivered too
+    int delivered = std::min(counter.count(), expected);
+    printf("%-8s %d threads: %11.0f calls/s %11.0f delivered/s  %7d dropped\n",
+            g_modes[mode], threads, total / (calls / 1e6),
+            delivered / (elapsed / 1e6), logger->dropped() - dropped);
+}
+
+// -----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    // delivered straight from the logger thread, there is no event loop
+    DeliveryCounter counter;
+    QObject::connect(Logger::instance(),
+            SIGNAL(updateLog(int, const QString &)), &counter,
+            SLOT(onUpdateLog(int, const QString &)),
+            Qt::DirectConnection);
+
+    Logger::setTypes(LOG_TYPE_FAIL | LOG_TYPE_ERR | LOG_TYPE_WARN | LOG_TYPE_INFO);
+    for (int m = 0; m < MODE_COUNT; ++m)
+        for (size_t t = 0; t < sizeof(g_threads) / sizeof(g_threads[0]); ++t)
+            runMode((BenchMode)m, g_threads[t], counter);
+
+    return 0;
+}
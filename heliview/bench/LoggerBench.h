@@ -0,0 +1,37 @@
+// -----------------------------------------------------------------------------
+// File:    LoggerBench.h
+// Created: 10-17-2026
+//
+// Logger throughput harness: counts what the logger thread delivers.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_LOGGERBENCH__H_
+#define _HELIVIEW_LOGGERBENCH__H_
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QString>
+
+class DeliveryCounter : public QObject
+{
+    Q_OBJECT
+
+public:
+    DeliveryCounter() : m_count(0) { }
+
+    int count() const { return const_cast<QAtomicInt &>(m_count).fetchAndAddAcquire(0); }
+    void reset() { m_count.fetchAndStoreRelease(0); }
+
+public slots:
+    void onUpdateLog(int type, const QString &msg)
+    {
+        (void)type;
+        (void)msg;
+        m_count.fetchAndAddRelease(1);
+    }
+
+protected:
+    QAtomicInt m_count;
+};
+
+#endif // _HELIVIEW_LOGGERBENCH__H_
@@ -0,0 +1,114 @@
+// -----------------------------------------------------------------------------
+// File:    TrackerBench.cpp
+// Created: 10-17-2026
+//
+// Ground tracker throughput. Tracks a synthetic scene (noisy background, a
+// few coloured blobs) at common camera sizes and reports frames/s on one
+// core, plus the slowest band when the frame is split as the app would, which
+// bounds the frame time with one core per band.
+// -----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "ColorTracker.h"
+#include "Utility.h"
+
+#define BENCH_FRAMES    100
+#define BENCH_MAX_BANDS 8
+
+struct FrameSize
+{
+    int width;
+    int height;
+};
+
+static const FrameSize g_sizes[] =
+{
+    {  320,  240 },
+    {  640,  480 },
+    { 1280,  720 },
+    { 1920, 1080 },
+};
+
+// -----------------------------------------------------------------------------
+static void buildScene(std::vector<uint32_t> &pixels, int width, int height)
+{
+    pixels.resize((size_t)width * height);
+    for (size_t i = 0; i < pixels.size(); ++i)
+    {
+        // dull background with the odd stray red pixel in it
+        int v = 60 + rand() % 80;
+        pixels[i] = 0xFF000000 | (v << 16) | ((v - 10) << 8) | (v - 20);
+        if (0 == rand() % 200)
+            pixels[i] = 0xFFE01010;
+    }
+
+    for (int blob = 0; blob < 4; ++blob)
+    {
+        int r = height / (8 + blob * 4);
+        int cx = rand() % width, cy = rand() % height;
+        for (int y = std::max(0, cy - r); y < std::min(height, cy + r); ++y)
+            for (int x = std::max(0, cx - r); x < std::min(width, cx + r); ++x)
+                if ((x - cx) * (x - cx) + (y - cy) * (y - cy) < r * r)
+                    pixels[(size_t)y * width + x] = 0xFFD02020;
+    }
+}
+
+// -----------------------------------------------------------------------------
+static void runSize(const FrameSize &size)
+{
+    std::vector<uint32_t> pixels;
+    buildScene(pixels, size.width, size.height);
+
+    ColorTracker tracker;
+    tracker.setThreshold(ColorThreshold(220, 30, 30, 12, 100), 20);
+
+    TrackResult result;
+    uint64_t start = MonotonicMicros();
+    for (int i = 0; i < BENCH_FRAMES; ++i)
+        result = tracker.track(&pixels[0], size.width, size.width, size.height);
+    double single = (MonotonicMicros() - start) / (double)BENCH_FRAMES;
+
+    // banded, one band after another, timing each band and the merge
+    int bands = tracker.prepare(size.width, size.height, BENCH_MAX_BANDS);
+    uint64_t slowest = 0, merge = 0;
+    for (int i = 0; i < BENCH_FRAMES; ++i)
+    {
+        uint64_t frame_slowest = 0;
+        for (int b = 0; b < bands; ++b)
+        {
+            uint64_t t = MonotonicMicros();
+            tracker.scanBand(b, &pixels[0], size.width);
+            frame_slowest = std::max(frame_slowest, MonotonicMicros() - t);
+        }
+        slowest += frame_slowest;
+
+        uint64_t t = MonotonicMicros();
+        TrackResult banded = tracker.merge();
+        merge += MonotonicMicros() - t;
+        if (banded.area != result.area || banded.blobs != result.blobs)
+            printf("    banded result MISMATCH\n");
+    }
+
+    double parallel = (slowest + merge) / (double)BENCH_FRAMES;
+    printf("%4dx%-4d 1 core: %7.2f ms %7.0f fps   %d bands: %7.2f ms %7.0f fps"
+            "  (blob %d px, %d blobs)\n",
+            size.width, size.height, single / 1000.0, 1e6 / single,
+            bands, parallel / 1000.0, 1e6 / parallel,
+            result.area, result.blobs);
+}
+
+// -----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    (void)argc;
+    (void)argv;
+
+    srand(1);
+    for (size_t s = 0; s < sizeof(g_sizes) / sizeof(g_sizes[0]); ++s)
+        runSize(g_sizes[s]);
+
+    return 0;
+}
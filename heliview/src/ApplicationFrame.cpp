@@ -7,14 +7,18 @@
 // -----------------------------------------------------------------------------
 
 #include <QDateTime>
+#include <QFileDialog>
 #include <QMessageBox>
 #include <QTimer>
 #include <QTextStream>
 #include <iostream>
 #include "ApplicationFrame.h"
 #include "ConnectionDialog.h"
+#include "FlightRecorder.h"
 #include "Logger.h"
+#include "ReplayDeviceController.h"
 #include "SettingsDialog.h"
+#include "TelemetryStore.h"
 #include "Utility.h"
 #include "uav_protocol.h"
 
@@ -22,8 +26,8 @@ using namespace std;
 
 // -----------------------------------------------------------------------------
 ApplicationFrame::ApplicationFrame(bool noVirtualView)
-: m_virtual(NULL), m_video(NULL), m_file(NULL), m_tele_file(NULL), m_log(NULL), 
-  m_logbuffer(NULL), m_tele_log(NULL), m_tele_logbuffer(NULL), m_bufsize(1024),
+: m_graphTimer(NULL), m_console(NULL), m_virtual(NULL), m_video(NULL),
+  m_replay(NULL), m_diagnostics(NULL),
   m_logging(false), m_controller(NULL), m_gamepad(NULL)
 {
     setupUi(this);
@@ -35,9 +39,8 @@ ApplicationFrame::ApplicationFrame(bool noVirtualView)
 
     if (!noVirtualView)
         setupVirtualView();
-
-    m_logbuffer = new QByteArray();
-    m_tele_logbuffer = new QByteArray();
+    setupDiagnosticsView();
+    setupConsole();
 
     connect(Logger::instance(), SIGNAL(updateLog(int, const QString &)), this,
             SLOT(onUpdateLog(int, const QString &)));
@@ -48,6 +51,7 @@ ApplicationFrame::ApplicationFrame(bool noVirtualView)
 // -----------------------------------------------------------------------------
 ApplicationFrame::~ApplicationFrame()
 {
+    SafeDelete(m_graphTimer);
     for (int i = 0; i < AXIS_COUNT; ++i)
     {
         SafeDelete(m_graphs[i]);
@@ -63,6 +67,14 @@ void ApplicationFrame::setupCameraView()
 {
     m_video = new VideoView(tabPaneCamera);
     tabPaneCameraLayout->addWidget(m_video);
+
+    connect(m_video, SIGNAL(videoStatsUpdated(const QString &)),
+            m_videoStat, SLOT(setText(const QString &)));
+
+    connect(actionShow_Threshold, SIGNAL(toggled(bool)),
+            m_video, SLOT(setThresholdPreview(bool)));
+    connect(actionGround_Tracker, SIGNAL(toggled(bool)),
+            m_video, SLOT(setGroundTracking(bool)));
 }
 
 // -----------------------------------------------------------------------------
@@ -105,6 +117,23 @@ void ApplicationFrame::setupSensorView()
         //layout->insertWidget(i, m_graphs[i]->getPlot());
     }
 
+    // every graph reads its channel straight out of the telemetry store
+    m_graphs[AXIS_Z]->setSource(0, TELEM_YAW, 1.0f, 180.0f);
+    m_graphs[AXIS_Y]->setSource(0, TELEM_PITCH, 1.0f, 180.0f);
+    m_graphs[AXIS_X]->setSource(0, TELEM_ROLL, 1.0f, 180.0f);
+    m_graphs[CONNECTION]->setSource(0, TELEM_RSSI);
+    m_graphs[BATTERY]->setSource(0, TELEM_BATT);
+    m_graphs[AUXILIARY]->setSource(0, TELEM_AUX, 100.0f / 1150.0f,
+            -900.0f * 100.0f / 1150.0f);
+    m_graphs[ELEVATION]->setSource(0, TELEM_ALT);
+    m_graphs[CPU]->setSource(0, TELEM_CPU);
+
+    // samples are only stored as they arrive, the graphs are redrawn at
+    // most once per refresh however fast telemetry comes in
+    m_graphTimer = new QTimer(this);
+    connect(m_graphTimer, SIGNAL(timeout()), this, SLOT(onGraphRefresh()));
+    m_graphTimer->start(GRAPH_REFRESH_MS);
+
     m_lblNoAxes = new QLabel;
     m_lblNoAxes->setText("No Axes Selected");
     m_lblNoAxes->setAlignment(Qt::AlignCenter);
@@ -120,6 +149,25 @@ void ApplicationFrame::setupVirtualView()
     tabPaneVirtualLayout->addWidget(m_virtual);
 }
 
+// -----------------------------------------------------------------------------
+void ApplicationFrame::setupConsole()
+{
+    m_console = new ConsoleView(dockWidgetContents_6);
+    horizontalLayout_9->addWidget(m_console);
+}
+
+// -----------------------------------------------------------------------------
+void ApplicationFrame::setupDiagnosticsView()
+{
+    m_diagnostics = new DiagnosticsView(tabPane);
+    tabPane->addTab(m_diagnostics, tr("Diagnostics"));
+
+    connect(m_diagnostics, SIGNAL(refreshRequested()),
+            this, SLOT(onDiagnosticsRefresh()));
+    connect(m_diagnostics, SIGNAL(exportRequested()),
+            this, SLOT(onDiagnosticsExport()));
+}
+
 // -----------------------------------------------------------------------------
 void ApplicationFrame::setupStatusBar()
 {
@@ -129,6 +177,10 @@ void ApplicationFrame::setupStatusBar()
     m_connStat->setMaximumWidth(300);
     statusBar()->addPermanentWidget(m_connStat);
 
+    m_videoStat = new QLabel("Video: no frames");
+    m_videoStat->setFrameStyle(QFrame::Box);
+    statusBar()->addPermanentWidget(m_videoStat);
+
     connectionStatusBar->setRange(0, 256);
 }
 
@@ -136,9 +188,9 @@ void ApplicationFrame::setupStatusBar()
 void ApplicationFrame::connectDeviceController()
 {
     connect(m_controller,
-            SIGNAL(telemetryReady(float, float, float, float, int, int, int, int)),
+            SIGNAL(telemetryReady(float, float, float, float, int, int, int, int, uint64_t)),
             this,
-            SLOT(onTelemetryReady(float, float, float, float, int, int, int, int)));
+            SLOT(onTelemetryReady(float, float, float, float, int, int, int, int, uint64_t)));
 
     connect(m_controller, SIGNAL(connectionStatusChanged(const QString&, bool)),
             this, SLOT(onConnectionStatusChanged(const QString&, bool)));
@@ -149,8 +201,10 @@ void ApplicationFrame::connectDeviceController()
     connect(m_controller, SIGNAL(flightStateChanged(int)),
             this, SLOT(onFlightStateChanged(int)));
 
-    connect(m_controller, SIGNAL(videoFrameReady(const char *, size_t)),
-            m_video, SLOT(setVideoFrame(const char *, size_t)));
+    connect(m_controller,
+            SIGNAL(videoFrameReady(const char *, size_t, const FrameTiming &)),
+            m_video,
+            SLOT(setVideoFrame(const char *, size_t, const FrameTiming &)));
 
     connect(m_controller,
             SIGNAL(trackStatusUpdate(bool, const QRect &, const QPoint &)),
@@ -170,16 +224,46 @@ void ApplicationFrame::connectDeviceController()
             SLOT(onUpdateTrackControlEnable(int)));
     connect(m_controller, SIGNAL(updateColorTrackEnable(int)), m_video, 
                 SLOT(onUpdateColorTrackEnable(int)));
+
+    // keep the threshold preview on what the vehicle is using
+    connect(m_controller, SIGNAL(colorValuesUpdate(TrackSettings)),
+            m_video, SLOT(onColorValuesUpdated(TrackSettings)));
+    m_video->onColorValuesUpdated(m_controller->currentTrackSettings());
+}
+
+// -----------------------------------------------------------------------------
+void ApplicationFrame::connectReplay()
+{
+    SafeDelete(m_replay);
+
+    // only recordings get transport controls
+    ReplayDeviceController *replay =
+        qobject_cast<ReplayDeviceController *>(m_controller);
+    if (!replay)
+        return;
+
+    m_replay = new ReplayView(this);
+    statusBar()->addWidget(m_replay, 1);
+
+    connect(m_replay, SIGNAL(pausedChanged(bool)), replay, SLOT(setPaused(bool)));
+    connect(m_replay, SIGNAL(speedChanged(double)), replay, SLOT(setSpeed(double)));
+    connect(m_replay, SIGNAL(seekRequested(int)), replay, SLOT(seek(int)));
+    connect(replay, SIGNAL(positionChanged(int, int)),
+            m_replay, SLOT(setPosition(int, int)));
+    connect(replay, SIGNAL(finished()), m_replay, SLOT(onFinished()));
 }
 
 // -----------------------------------------------------------------------------
 void ApplicationFrame::connectGamepad()
 {
-    const QString dev = "/dev/input/js0";
+    // empty picks the first evdev pad, falling back on /dev/input/js0
+    const QString dev = "";
 
     // if a gamepad is already opened, close and destroy it
     if (m_gamepad)
     {
+        if (m_controller)
+            m_controller->setGamepad(NULL);
         m_gamepad->close();
         SafeDelete(m_gamepad);
     }
@@ -195,7 +279,8 @@ void ApplicationFrame::connectGamepad()
     // attempt to open the gamepad device
     if (!m_gamepad->open(dev))
     {
-        Logger::err(tr("failed to open gamepad device '%1'\n").arg(dev));
+        Logger::err(tr("failed to open gamepad device '%1'\n")
+                .arg(dev.isEmpty() ? QString("default") : dev));
         SafeDelete(m_gamepad);
         return;
     }
@@ -214,6 +299,7 @@ void ApplicationFrame::connectGamepad()
             m_controller, SLOT(onInputReady(GamepadEvent, int, float)));
 
     m_gamepad->start();
+    m_controller->setGamepad(m_gamepad);
 }
 
 // -----------------------------------------------------------------------------
@@ -242,88 +328,32 @@ void ApplicationFrame::setEnabledButtons(int buttons)
 // -----------------------------------------------------------------------------
 void ApplicationFrame::openLogFile(const QString &logfile, const QString &tlogfile)
 {
-    if (!m_file)
-    {
-        m_file = new QFile(logfile);
-        if (!m_file)
-        {
-            Logger::fail("failed to allocate file object\n");
-            return;
-        }
-    }
-    
-    if (!m_tele_file)
-    {
-        m_tele_file = new QFile(tlogfile);
-        if (!m_tele_file)
-        {
-            Logger::fail("failed to allocate file object\n");
-            return;
-        }
-    }
-
-    if (!m_file->open(QIODevice::WriteOnly | QIODevice::Text))
+    // written from the logger thread, which replaces any file already open
+    if (!Logger::instance()->openFile(logfile))
     {
         Logger::err("could not open new log file\n");
         return;
     }
-    Logger::info(tr("successfully opened log '%1'\n").arg(m_file->fileName()));
-    
-    if (!m_tele_file->open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-        Logger::err("could not open new log file\n");
-        return;
-    }
-    Logger::info(tr("successfully opened telemetry log '%1'\n")
-            .arg(m_tele_file->fileName()));
+    Logger::info(tr("successfully opened log '%1'\n").arg(logfile));
 
-    if (!m_log)
-    {
-        m_log = new QTextStream();
-        if (!m_log)
-        {
-            Logger::fail("failed to allocate log stream\n");
-            return;
-        }
-    }
-    m_log->setDevice(m_file);
-    
-    if (!m_tele_log)
-    {
-        m_tele_log = new QTextStream();
-        if (!m_tele_log)
-        {
-            Logger::fail("failed to allocate telemetry log stream\n");
-            return;
-        }
-    }
-    m_tele_log->setDevice(m_tele_file);
+    // telemetry goes to the binary flight recorder rather than a text log,
+    // none is given while replaying
+    if (!tlogfile.isEmpty())
+        FlightRecorder::instance()->open(tlogfile);
 }
 
 // -----------------------------------------------------------------------------
 void ApplicationFrame::closeLogFile()
 {
-    if (m_file)
-    {
-        m_log->flush();
-        m_file->close();
-        SafeDelete(m_file);
-        SafeDelete(m_log);
-    }
-    
-    if (m_tele_file)
-    {
-        m_tele_log->flush();
-        m_tele_file->close();
-        SafeDelete(m_tele_file);
-        SafeDelete(m_tele_log);
-    }
+    Logger::instance()->closeFile();
+    FlightRecorder::instance()->close();
 }
 
 // -----------------------------------------------------------------------------
 bool ApplicationFrame::enableLogging(bool enable, const QString &verbosity)
 {
     m_logging = enable;
+    bool valid = true;
 
     if (m_logging)
     {
@@ -336,160 +366,57 @@ bool ApplicationFrame::enableLogging(bool enable, const QString &verbosity)
         else
         {
             m_verbosity = LOG_MODE_NORMAL;
-            return false;
+            valid = false;
         }
     }
-    return true;
-}
 
-// -----------------------------------------------------------------------------
-void ApplicationFrame::writeToLog(const QString &plain, const QString &rich,
-        int log)
-{
-    txtCommandLog->textCursor().insertHtml(rich);
-   
-    QTextCursor c = txtCommandLog->textCursor();
-    c.movePosition(QTextCursor::End);
-    txtCommandLog->setTextCursor(c);
-
-    if (log == 0)
-    {
-        m_logbuffer->append(plain);
-        if (m_logbuffer->size() >= m_bufsize)
-        {
-            if (m_log)
-            {
-                // only write to file when we reach bufsize limit
-                *m_log << *m_logbuffer;
-                m_log->flush();
-            }
-            m_logbuffer->clear();
-        }
-    }
-    else if(log == 1)
+    // the logger drops everything else before it is even formatted
+    int types = 0;
+    if (m_logging)
     {
-        m_tele_logbuffer->append(plain);
-        if (m_tele_logbuffer->size() >= m_bufsize)
-        {
-            if (m_tele_log)
-            {
-                // only write to file when we reach bufsize limit
-                *m_tele_log << *m_tele_logbuffer;
-                m_tele_log->flush();
-            }
-            m_tele_logbuffer->clear();
-        }
+        types = LOG_TYPE_FAIL | LOG_TYPE_ERR | LOG_TYPE_WARN | LOG_TYPE_INFO;
+        if (LOG_MODE_NORMAL_DEBUG == m_verbosity)
+            types |= LOG_TYPE_DBG;
+        else if (LOG_MODE_EXCESSIVE == m_verbosity)
+            types = ~0;
     }
+    Logger::setTypes(types);
+    return valid;
 }
 
 // -----------------------------------------------------------------------------
 void ApplicationFrame::onUpdateLogFile(const QString &file,
         const QString &tfile, int bufsize)
 {
-    // close last file opened
-    m_log->flush();
-    m_file->flush();
-    m_file->close();
-    SafeDelete(m_file);
-    
-    m_tele_log->flush();
-    m_tele_file->flush();
-    m_tele_file->close();
-    SafeDelete(m_tele_file);
-
-    // clear buffer to start fresh
-    m_logbuffer->clear();
-    m_tele_logbuffer->clear();
-    
-    // open lof file and set buffer size limit
+    // set the buffer size limit and switch files, the logger writes out and
+    // closes the last one. this restarts the recorder
+    Logger::instance()->setFileBuffer(bufsize * 1024);
     openLogFile(file, tfile);
-    m_bufsize = bufsize * 1024;
 }
 
 // -----------------------------------------------------------------------------
 void ApplicationFrame::onUpdateLog(int type, const QString &msg)
 {
-    if (!m_logging)
-        return;
-
-    QString plain_msg = msg; // copy for plain text
-    QString rich_msg = msg;  // copy for rich text
-    int log = 0;
-
-    rich_msg.replace(QString("\n"), QString("<br>"));
-    rich_msg.replace(QString(" "), QString("&nbsp;"));
-
-    switch (type)
-    {
-        case LOG_TYPE_FAIL:
-            rich_msg.prepend("<font color=red><b>[failure] ");
-            rich_msg.append("</b></font>");
-            plain_msg.prepend("failure: ");
-            break;
-        case LOG_TYPE_ERR:
-            rich_msg.prepend("<font color=red>[error] ");
-            rich_msg.append("</font>");
-            plain_msg.prepend("error: ");
-            break;
-        case LOG_TYPE_WARN:
-            rich_msg.prepend("<font color=orange>[warning] ");
-            rich_msg.append("</font>");
-            plain_msg.prepend("warning: ");
-            break;
-        case LOG_TYPE_INFO:
-            break;
-        case LOG_TYPE_DBG:
-        case LOG_TYPE_EXTRADEBUG:
-            rich_msg.prepend("<font color=forestgreen>[debug] ");
-            rich_msg.append("</font>");
-            plain_msg.prepend("debug: ");
-            break;
-        case LOG_TYPE_TELEMETRY:
-            log = 1;
-        default:
-            // type is comprised of multiple flags
-            break;
-    }
-
-    switch (m_verbosity)
-    {
-        case LOG_MODE_EXCESSIVE:
-        // excessive mode logs any type of log message
-        // print debug statements to cmd line as well
-        if ((type & LOG_TYPE_DBG) || (type & LOG_TYPE_EXTRADEBUG))
-        {
-            cerr << plain_msg.toAscii().constData() << endl;
-        }
-        
-        writeToLog(plain_msg, rich_msg, log);
-        break;
-        case LOG_MODE_NORMAL_DEBUG:
-        // log debug messages plus normal messages
-        case LOG_MODE_NORMAL:
-        // normal mode watches for failures, errors, warnings, information
-        if ((type & LOG_TYPE_FAIL) ||
-            (type & LOG_TYPE_ERR)   ||
-            (type & LOG_TYPE_WARN) ||
-            (type & LOG_TYPE_INFO))
-        {
-            writeToLog(plain_msg, rich_msg, log);
-        }
-        else if ((m_verbosity == LOG_MODE_NORMAL_DEBUG) && (type & LOG_TYPE_DBG))
-        {
-            cerr << plain_msg.toAscii().constData() << endl;
-            writeToLog(plain_msg, rich_msg, log);
-        }
-        break;
-        default:
-        break;
-    }
+    // the logger only passes on what the verbosity lets through and has
+    // already written it to the file, the console shows it on its next refresh
+    m_console->append(type, msg);
 }
 
 // -----------------------------------------------------------------------------
 void ApplicationFrame::onTelemetryReady(float yaw, float pitch, float roll,
-        float alt, int rssi, int batt, int aux, int cpu)
-{
-    static float time = 0.0f;
+        float alt, int rssi, int batt, int aux, int cpu, uint64_t received)
+{
+    // stored once on receive time, graphs and anything else read it from there
+    float values[TELEM_CHANNELS];
+    values[TELEM_YAW] = yaw;
+    values[TELEM_PITCH] = pitch;
+    values[TELEM_ROLL] = roll;
+    values[TELEM_ALT] = alt;
+    values[TELEM_RSSI] = rssi;
+    values[TELEM_BATT] = batt;
+    values[TELEM_AUX] = aux;
+    values[TELEM_CPU] = cpu;
+    TelemetryStore::instance()->append(received, values);
 
     if (m_virtual)
     {
@@ -518,18 +445,15 @@ void ApplicationFrame::onTelemetryReady(float yaw, float pitch, float roll,
     }
     cpuStatusBar->setValue(cpu);    
     cpuStatusBar->setFormat(QString("%p%"));    
+}
 
-    // add new data to their respective plots
-    m_graphs[AXIS_Z]->addDataPoint(time, yaw + 180.0f, 0.0f);
-    m_graphs[AXIS_Y]->addDataPoint(time, pitch + 180.0f, 0.0f);
-    m_graphs[AXIS_X]->addDataPoint(time, roll + 180.0f, 0.0f);
-    m_graphs[CONNECTION]->addDataPoint(time, rssi, 0.0f);
-    m_graphs[BATTERY]->addDataPoint(time, batt, 0.0f);
-    m_graphs[AUXILIARY]->addDataPoint(time, aux, 0.0f);
-    m_graphs[ELEVATION]->addDataPoint(time, alt, 0.0f);
-    m_graphs[CPU]->addDataPoint(time, cpu, 0.0f);
-
-    time += 0.5f;
+// -----------------------------------------------------------------------------
+void ApplicationFrame::onGraphRefresh()
+{
+    // one snapshot shared by every graph
+    TelemetryView view = TelemetryStore::instance()->snapshot();
+    for (int i = 0; i < AXIS_COUNT; ++i)
+        m_graphs[i]->refresh(view);
 }
 
 // -----------------------------------------------------------------------------
@@ -645,6 +569,9 @@ bool ApplicationFrame::connectTo(const QString &source, const QString &device)
 {
     onFileDisconnectTriggered();
 
+    // a new session's graphs start again from its own first sample
+    TelemetryStore::instance()->reset();
+
     // attempt to allocate the specified device controller
     m_controller = CreateDeviceController(source, device);
     if (!m_controller)
@@ -655,9 +582,21 @@ bool ApplicationFrame::connectTo(const QString &source, const QString &device)
 
     // connect the signals and slots for this device
     connectDeviceController();
+    connectReplay();
     connectGamepad();
 
-    return openDevice();
+    if (!openDevice())
+        return false;
+
+    // the device options decide how playback starts
+    if (m_replay)
+    {
+        ReplayDeviceController *replay =
+            qobject_cast<ReplayDeviceController *>(m_controller);
+        m_replay->setPaused(replay->isPaused());
+        m_replay->setSpeed(replay->speed());
+    }
+    return true;
 }
 
 // -----------------------------------------------------------------------------
@@ -670,7 +609,7 @@ void ApplicationFrame::onFileExitTriggered()
 // -----------------------------------------------------------------------------
 void ApplicationFrame::onEditSettingsTriggered()
 {
-    QString filename = m_file ? m_file->fileName() : "";
+    QString filename = Logger::instance()->fileName();
     TrackSettings track;
     bool track_en = false, btn_track_en;
 
@@ -682,7 +621,8 @@ void ApplicationFrame::onEditSettingsTriggered()
 
     btn_track_en = btnColorTrack->isEnabled();
 
-    SettingsDialog sd(this, track_en, btn_track_en, track, filename, m_bufsize/1024);
+    SettingsDialog sd(this, track_en, btn_track_en, track, filename,
+            Logger::instance()->fileBuffer() / 1024);
     if (m_controller)
     {
         // allow settings dialog to communicate data to device controller
@@ -711,6 +651,10 @@ void ApplicationFrame::onEditSettingsTriggered()
         connect(&sd, SIGNAL(videoRotationChanged(int)),
                 m_video, SLOT(setRotation(int)));
 
+        connect(&sd, SIGNAL(trackPreviewChanged(int, int, int, int, int, int, int)),
+                m_video,
+                SLOT(setTrackSettings(int, int, int, int, int, int, int)));
+
         // populate the video device control pane
         connect(m_controller, SIGNAL(deviceControlUpdated(const QString &,
                         const QString &, int, int, int, int, int, int)),
@@ -753,6 +697,10 @@ void ApplicationFrame::onEditSettingsTriggered()
                 SLOT(onUpdateLogFile(const QString &, const QString &, int)));
         
     sd.exec();
+
+    // drop any preview values that were never applied
+    if (m_controller)
+        m_video->onColorValuesUpdated(m_controller->currentTrackSettings());
 }
 
 // -----------------------------------------------------------------------------
@@ -782,24 +730,31 @@ void ApplicationFrame::onFileSaveLogTriggered()
     else
     {
         Logger::info("Log successfully saved\n");
-
-        *m_log << *m_logbuffer;
-        m_log->flush();
-        m_file->flush();
+        Logger::instance()->flushFile();
     }
 }
 
 // -----------------------------------------------------------------------------
 void ApplicationFrame::onFileSaveFrameTriggered()
 {
-    bool saved = m_video->saveFrame();
-
-    if (saved)
-        Logger::info(("Frame successfully saved\n"));
-    else
+    // the write itself happens in the background and reports its outcome
+    if (!m_video->saveFrame())
         Logger::warn(("Failed to save frame\n"));
 }
 
+// -----------------------------------------------------------------------------
+void ApplicationFrame::onFileRecordVideoToggled(bool record)
+{
+    if (!record)
+    {
+        m_video->stopRecording();
+        return;
+    }
+
+    QString tstamp = QDateTime::currentDateTime().toString("MMM-dd-yyyy_hh-mm-ss");
+    m_video->startRecording(QString("heliview_%1.hvv").arg(tstamp));
+}
+
 // -----------------------------------------------------------------------------
 void ApplicationFrame::onTakeoffClicked()
 {
@@ -964,6 +919,74 @@ void ApplicationFrame::onTabChanged(int index)
     if (m_virtual) m_virtual->setRunning(index == 2);
 }
 
+// -----------------------------------------------------------------------------
+void ApplicationFrame::onDiagnosticsRefresh()
+{
+    const VideoLatency &latency = m_video->latency();
+    for (int i = 0; i < STAGE_COUNT; ++i)
+    {
+        m_diagnostics->setHistogram(tr("Video %1").arg(
+                    VideoLatency::stageName(i)), latency.stage(i));
+    }
+
+    m_diagnostics->setHistogram(tr("Ground tracker"),
+            m_video->groundStats().track_time);
+
+    if (m_controller)
+    {
+        ControlLatency control = m_controller->controlLatency();
+        for (int i = 0; i < CONTROL_STAGE_COUNT; ++i)
+        {
+            m_diagnostics->setHistogram(tr("Control %1").arg(
+                        ControlLatency::stageName(i)), control.stage(i));
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+void ApplicationFrame::onDiagnosticsExport()
+{
+    if (!m_controller)
+    {
+        Logger::err("no device, no control timings to export\n");
+        return;
+    }
+
+    QString tstamp = QDateTime::currentDateTime().toString("MMM-dd-yyyy_hh-mm-ss");
+    QString filename = QFileDialog::getSaveFileName(this,
+            tr("Export Control Timings"),
+            QString("heliview_control_%1.csv").arg(tstamp),
+            tr("CSV files (*.csv)"));
+    if (filename.isEmpty())
+        return;
+
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    {
+        Logger::err(tr("could not open '%1' for the control timings\n")
+                .arg(filename));
+        return;
+    }
+
+    // what was measured goes in the file, so runs with different pads,
+    // backends and loop settings can be told apart afterwards
+    QVector<ControlTiming> timings = m_controller->controlTimings();
+    QString summary = m_controller->controlLatency().summary();
+
+    QTextStream out(&file);
+    out << "# device: " << m_controller->controllerType() << " "
+        << m_controller->device() << "\n";
+    out << "# gamepad: " << (m_gamepad ? m_gamepad->driverName() :
+            QString("none")) << "\n";
+    QStringList lines = summary.split('\n', QString::SkipEmptyParts);
+    for (int i = 0; i < lines.size(); ++i)
+        out << "# " << lines[i] << "\n";
+    ControlLatency::writeCsv(out, timings);
+
+    Logger::info(tr("exported %1 control timings to '%2'\n")
+            .arg(timings.size()).arg(filename));
+}
+
 // -----------------------------------------------------------------------------
 void ApplicationFrame::onGraphsChanged()
 {
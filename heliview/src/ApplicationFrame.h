@@ -12,9 +12,12 @@
 #include <QWidget>
 #include <QFile>
 #include "ui_ApplicationFrame.h"
+#include "ConsoleView.h"
 #include "ControllerView.h"
 #include "DeviceController.h"
+#include "DiagnosticsView.h"
 #include "LineGraph.h"
+#include "ReplayView.h"
 #include "VirtualView.h"
 #include "VideoView.h"
 #include "Gamepad.h"
@@ -51,7 +54,7 @@ public slots:
     void onConnectionStatusChanged(const QString &text, bool status);
 
     void onTelemetryReady(float yaw, float pitch, float roll, float alt,
-            int rssi, int batt, int aux, int cpu);
+            int rssi, int batt, int aux, int cpu, uint64_t received);
     void onControlStateChanged(int state);
     void onFlightStateChanged(int state);
     void onUpdateTrackControlEnable(int track_en);
@@ -64,6 +67,7 @@ public slots:
     void onEditSettingsTriggered();
     void onHelpAboutTriggered();
     void onFileSaveFrameTriggered();
+    void onFileRecordVideoToggled(bool record);
     void onFileSaveLogTriggered();
 
     // control panel button click event callbacks
@@ -88,32 +92,35 @@ public slots:
 
     void onTabChanged(int index);
     void onGraphsChanged();
+    void onDiagnosticsRefresh();
+    void onDiagnosticsExport();
+    void onGraphRefresh();
 
 protected:
     void setupCameraView();
     void setupControllerPane();
     void setupSensorView();
     void setupVirtualView();
+    void setupDiagnosticsView();
+    void setupConsole();
     void setupStatusBar();
     void connectDeviceController();
+    void connectReplay();
     void connectGamepad();
     void setupSignalsSlots();
 
     bool openDevice();
     void setEnabledButtons(int buttons);
-    void writeToLog(const QString &plain, const QString &rich, int log);
 
     LineGraph        *m_graphs[AXIS_COUNT];
+    QTimer           *m_graphTimer;
+    ConsoleView      *m_console;
     VirtualView      *m_virtual;
     VideoView        *m_video;
-    QFile            *m_file;
-    QFile            *m_tele_file;
+    ReplayView       *m_replay;
+    DiagnosticsView  *m_diagnostics;
     QLabel           *m_connStat;
-    QTextStream      *m_log;
-    QByteArray       *m_logbuffer;
-    QTextStream      *m_tele_log;
-    QByteArray       *m_tele_logbuffer;
-    int               m_bufsize;
+    QLabel           *m_videoStat;
     bool              m_logging;
     DeviceController *m_controller;
     Gamepad          *m_gamepad;
@@ -0,0 +1,213 @@
+// -----------------------------------------------------------------------------
+// File:    ColorThreshold.cpp
+// Created: 10-17-2026
+//
+// Pixel kernels for colour selection.
+// -----------------------------------------------------------------------------
+
+#include "ColorThreshold.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COLOR_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// -----------------------------------------------------------------------------
+ColorThreshold::ColorThreshold()
+: hue(0.0f), hue_range(0.0f), saturation(0), valid(false)
+{
+}
+
+// -----------------------------------------------------------------------------
+ColorThreshold::ColorThreshold(int r, int g, int b, int ht, int st)
+: hue(ColorHue(r, g, b)), hue_range((float)ht), saturation(st),
+  valid(hue >= 0.0f)
+{
+}
+
+// -----------------------------------------------------------------------------
+float ColorHue(int r, int g, int b)
+{
+    // same operations, in the same order, as the vector kernel below so
+    // both paths agree on every pixel
+    float fr = (float)r, fg = (float)g, fb = (float)b;
+    float mx = fr > fg ? fr : fg;
+    mx = mx > fb ? mx : fb;
+    float mn = fr < fg ? fr : fg;
+    mn = mn < fb ? mn : fb;
+
+    float delta = mx - mn;
+    if (delta <= 0.0f)
+        return -1.0f;
+
+    float inv = 1.0f / delta;
+    float h;
+    if (mx == fr)
+        h = (fg - fb) * inv;
+    else if (mx == fg)
+        h = (fb - fr) * inv + 2.0f;
+    else
+        h = (fr - fg) * inv + 4.0f;
+
+    if (h < 0.0f)
+        h += 6.0f;
+    return h * (COLOR_HUE_WHEEL / 6.0f);
+}
+
+// -----------------------------------------------------------------------------
+bool ColorThreshold::matches(uint32_t pixel) const
+{
+    int r = (pixel >> 16) & 0xFF, g = (pixel >> 8) & 0xFF, b = pixel & 0xFF;
+    int mx = r > g ? r : g;
+    mx = mx > b ? mx : b;
+    int mn = r < g ? r : g;
+    mn = mn < b ? mn : b;
+
+    // saturation is delta / max, compared without the divide
+    if (!valid || mx == mn || (mx - mn) * 255 < saturation * mx)
+        return false;
+
+    float d = ColorHue(r, g, b) - hue;
+    d = d < 0.0f ? -d : d;
+    d = d < COLOR_HUE_WHEEL - d ? d : COLOR_HUE_WHEEL - d;
+    return d <= hue_range;
+}
+
+// -----------------------------------------------------------------------------
+void ColorSum(const uint32_t *pixels, int stride, int x, int y,
+        int width, int height, uint64_t sums[3])
+{
+    uint64_t r = 0, g = 0, b = 0;
+
+    for (int j = y; j < y + height; ++j)
+    {
+        const uint32_t *p = pixels + (size_t)j * stride + x;
+        int i = 0;
+
+#ifdef COLOR_USE_SSE2
+        // psadbw against zero adds the eight masked bytes of each half, so
+        // one channel of four pixels is summed per instruction
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i mask_b = _mm_set1_epi32(0x000000FF);
+        const __m128i mask_g = _mm_set1_epi32(0x0000FF00);
+        const __m128i mask_r = _mm_set1_epi32(0x00FF0000);
+        __m128i acc_r = zero, acc_g = zero, acc_b = zero;
+
+        for (; i + 4 <= width; i += 4)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i *)(p + i));
+            acc_b = _mm_add_epi64(acc_b, _mm_sad_epu8(_mm_and_si128(v, mask_b), zero));
+            acc_g = _mm_add_epi64(acc_g, _mm_sad_epu8(_mm_and_si128(v, mask_g), zero));
+            acc_r = _mm_add_epi64(acc_r, _mm_sad_epu8(_mm_and_si128(v, mask_r), zero));
+        }
+
+        uint64_t lanes[2];
+        _mm_storeu_si128((__m128i *)lanes, acc_r);
+        r += lanes[0] + lanes[1];
+        _mm_storeu_si128((__m128i *)lanes, acc_g);
+        g += lanes[0] + lanes[1];
+        _mm_storeu_si128((__m128i *)lanes, acc_b);
+        b += lanes[0] + lanes[1];
+#endif
+
+        for (; i < width; ++i)
+        {
+            r += (p[i] >> 16) & 0xFF;
+            g += (p[i] >> 8) & 0xFF;
+            b += p[i] & 0xFF;
+        }
+    }
+
+    sums[0] += r;
+    sums[1] += g;
+    sums[2] += b;
+}
+
+// -----------------------------------------------------------------------------
+int ColorThresholdRow(const uint32_t *row, int width,
+        const ColorThreshold &threshold, uint8_t *mask)
+{
+    int count = 0, i = 0;
+
+    if (!threshold.valid)
+    {
+        for (; i < width; ++i)
+            mask[i] = 0;
+        return 0;
+    }
+
+#ifdef COLOR_USE_SSE2
+    // four pixels per step in single precision, mirroring ColorHue()
+    const __m128i byte = _mm_set1_epi32(0xFF);
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 two = _mm_set1_ps(2.0f), four = _mm_set1_ps(4.0f);
+    const __m128 six = _mm_set1_ps(6.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 scale = _mm_set1_ps(COLOR_HUE_WHEEL / 6.0f);
+    const __m128 wheel = _mm_set1_ps(COLOR_HUE_WHEEL);
+    const __m128 sign = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 target = _mm_set1_ps(threshold.hue);
+    const __m128 range = _mm_set1_ps(threshold.hue_range);
+    const __m128i sat = _mm_set1_epi32(threshold.saturation);
+    const __m128i sat_scale = _mm_set1_epi32(255);
+
+    for (; i + 4 <= width; i += 4)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i *)(row + i));
+        __m128i ir = _mm_and_si128(_mm_srli_epi32(v, 16), byte);
+        __m128i ig = _mm_and_si128(_mm_srli_epi32(v, 8), byte);
+        __m128i ib = _mm_and_si128(v, byte);
+        __m128 r = _mm_cvtepi32_ps(ir);
+        __m128 g = _mm_cvtepi32_ps(ig);
+        __m128 b = _mm_cvtepi32_ps(ib);
+
+        __m128 mx = _mm_max_ps(_mm_max_ps(r, g), b);
+        __m128 mn = _mm_min_ps(_mm_min_ps(r, g), b);
+        __m128 delta = _mm_sub_ps(mx, mn);
+        __m128 chroma = _mm_cmpgt_ps(delta, zero);
+
+        // greys divide by zero here, but they're masked out by chroma
+        __m128 inv = _mm_div_ps(one, _mm_or_ps(delta, _mm_andnot_ps(chroma, one)));
+        __m128 hr = _mm_mul_ps(_mm_sub_ps(g, b), inv);
+        __m128 hg = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(b, r), inv), two);
+        __m128 hb = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(r, g), inv), four);
+
+        __m128 is_r = _mm_cmpeq_ps(mx, r);
+        __m128 is_g = _mm_andnot_ps(is_r, _mm_cmpeq_ps(mx, g));
+        __m128 is_b = _mm_andnot_ps(_mm_or_ps(is_r, is_g), _mm_castsi128_ps(
+                    _mm_set1_epi32(-1)));
+        __m128 h = _mm_or_ps(_mm_or_ps(_mm_and_ps(is_r, hr),
+                    _mm_and_ps(is_g, hg)), _mm_and_ps(is_b, hb));
+        h = _mm_add_ps(h, _mm_and_ps(_mm_cmplt_ps(h, zero), six));
+        h = _mm_mul_ps(h, scale);
+
+        __m128 d = _mm_and_ps(_mm_sub_ps(h, target), sign);
+        d = _mm_min_ps(d, _mm_sub_ps(wheel, d));
+        __m128 hue_ok = _mm_cmple_ps(d, range);
+
+        // (max - min) * 255 >= st * max, all well inside 16 bits so the
+        // 16 bit multiply of the low halves is exact
+        __m128i imx = _mm_cvtps_epi32(mx);
+        __m128i idelta = _mm_cvtps_epi32(delta);
+        __m128i lhs = _mm_mullo_epi16(idelta, sat_scale);
+        __m128i rhs = _mm_mullo_epi16(imx, sat);
+        __m128 sat_ok = _mm_castsi128_ps(_mm_or_si128(_mm_cmpgt_epi32(lhs, rhs),
+                    _mm_cmpeq_epi32(lhs, rhs)));
+
+        int bits = _mm_movemask_ps(_mm_and_ps(_mm_and_ps(hue_ok, sat_ok), chroma));
+        mask[i + 0] = (bits & 1) ? 0xFF : 0;
+        mask[i + 1] = (bits & 2) ? 0xFF : 0;
+        mask[i + 2] = (bits & 4) ? 0xFF : 0;
+        mask[i + 3] = (bits & 8) ? 0xFF : 0;
+        count += (bits & 1) + ((bits >> 1) & 1) + ((bits >> 2) & 1) + (bits >> 3);
+    }
+#endif
+
+    for (; i < width; ++i)
+    {
+        bool hit = threshold.matches(row[i]);
+        mask[i] = hit ? 0xFF : 0;
+        count += hit;
+    }
+    return count;
+}
@@ -0,0 +1,46 @@
+// -----------------------------------------------------------------------------
+// File:    ColorThreshold.h
+// Created: 10-17-2026
+//
+// Pixel kernels for colour selection on 32 bit RGB rows (QImage::Format_RGB32
+// and ARGB32 read as uint32_t, 0xAARRGGBB). A pixel matches the tracking colour
+// when its hue is within ht of the target hue, on a 0-256 hue wheel, and its
+// saturation (0-255) is at least st. Greys have no hue and never match. SSE2
+// is used where the compiler targets it, with a scalar path that gives the
+// same answers everywhere else.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_COLORTHRESHOLD__H_
+#define _HELIVIEW_COLORTHRESHOLD__H_
+
+#include "Utility.h"
+
+#define COLOR_HUE_WHEEL     256.0f
+
+struct ColorThreshold
+{
+    ColorThreshold();
+    ColorThreshold(int r, int g, int b, int ht, int st);
+
+    bool matches(uint32_t pixel) const;
+
+    float hue;          // of the target colour, 0 - COLOR_HUE_WHEEL
+    float hue_range;    // ht
+    int   saturation;   // st
+    bool  valid;        // false for a grey target, which matches nothing
+};
+
+// hue on the 0-256 wheel, or -1 for a grey
+float ColorHue(int r, int g, int b);
+
+// add the red, green and blue totals of a rectangle to sums[0..2]. stride is
+// the distance between rows in pixels.
+void ColorSum(const uint32_t *pixels, int stride, int x, int y,
+        int width, int height, uint64_t sums[3]);
+
+// write 0xFF to mask[i] where row[i] matches, 0 elsewhere, and return the
+// number of matches
+int ColorThresholdRow(const uint32_t *row, int width,
+        const ColorThreshold &threshold, uint8_t *mask);
+
+#endif // _HELIVIEW_COLORTHRESHOLD__H_
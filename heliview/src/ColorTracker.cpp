@@ -0,0 +1,243 @@
+// -----------------------------------------------------------------------------
+// File:    ColorTracker.cpp
+// Created: 10-17-2026
+//
+// Ground side colour tracker.
+// -----------------------------------------------------------------------------
+
+#include <algorithm>
+#include "ColorTracker.h"
+
+// -----------------------------------------------------------------------------
+ColorTracker::ColorTracker()
+: m_minArea(1), m_width(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+void ColorTracker::setThreshold(const ColorThreshold &threshold, int min_area)
+{
+    m_threshold = threshold;
+    m_minArea = std::max(min_area, 1);
+}
+
+// -----------------------------------------------------------------------------
+int ColorTracker::prepare(int width, int height, int max_bands)
+{
+    // small frames aren't worth waking other cores for
+    int count = (int)(((int64_t)width * height) / TRACKER_BAND_PIXELS);
+    count = std::max(1, std::min(count, std::min(max_bands, height)));
+
+    m_width = width;
+    m_bands.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        m_bands[i].y0 = (int)((int64_t)height * i / count);
+        m_bands[i].y1 = (int)((int64_t)height * (i + 1) / count);
+    }
+    return count;
+}
+
+// -----------------------------------------------------------------------------
+int ColorTracker::find(std::vector<int> &parent, int i)
+{
+    while (parent[i] != i)
+    {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+// -----------------------------------------------------------------------------
+void ColorTracker::join(std::vector<int> &parent, int a, int b)
+{
+    a = find(parent, a);
+    b = find(parent, b);
+
+    // the lower index wins so roots are stable for a given frame
+    if (a < b)
+        parent[b] = a;
+    else if (b < a)
+        parent[a] = b;
+}
+
+// -----------------------------------------------------------------------------
+void ColorTracker::scanBand(int index, const uint32_t *pixels, int stride)
+{
+    TrackBand &band = m_bands[index];
+    band.runs.clear();
+    band.parent.clear();
+    band.mask.resize(m_width + 1);
+    band.matched = 0;
+    band.first_end = 0;
+    band.last_begin = 0;
+
+    int prev_begin = 0, prev_end = 0;
+    for (int y = band.y0; y < band.y1; ++y)
+    {
+        const uint32_t *row = pixels + (size_t)y * stride;
+        band.matched += ColorThresholdRow(row, m_width, m_threshold,
+                &band.mask[0]);
+        band.mask[m_width] = 0;
+
+        // turn the row's mask into runs
+        int begin = (int)band.runs.size();
+        for (int x = 0; x < m_width; ++x)
+        {
+            if (!band.mask[x])
+                continue;
+
+            TrackRun run;
+            run.y = y;
+            run.x0 = x;
+            while (band.mask[x])
+                ++x;
+            run.x1 = x;
+            band.parent.push_back((int)band.runs.size());
+            band.runs.push_back(run);
+        }
+        int end = (int)band.runs.size();
+
+        // join each run with those above it that touch it, diagonals
+        // included. both rows are sorted so one sweep covers every pair.
+        int p = prev_begin;
+        for (int c = begin; c < end && p < prev_end; )
+        {
+            const TrackRun &above = band.runs[p];
+            const TrackRun &here = band.runs[c];
+            if (above.x1 < here.x0)
+                ++p;
+            else if (here.x1 < above.x0)
+                ++c;
+            else
+            {
+                join(band.parent, p, c);
+                if (above.x1 < here.x1)
+                    ++p;
+                else
+                    ++c;
+            }
+        }
+
+        if (y == band.y0)
+            band.first_end = end;
+        band.last_begin = begin;
+        prev_begin = begin;
+        prev_end = end;
+    }
+}
+
+// -----------------------------------------------------------------------------
+TrackResult ColorTracker::merge()
+{
+    TrackResult result;
+
+    // one union-find over every band's runs
+    std::vector<int> offsets(m_bands.size() + 1, 0);
+    for (size_t i = 0; i < m_bands.size(); ++i)
+        offsets[i + 1] = offsets[i] + (int)m_bands[i].runs.size();
+
+    int total = offsets.back();
+    m_parent.resize(total);
+    for (size_t i = 0; i < m_bands.size(); ++i)
+    {
+        const TrackBand &band = m_bands[i];
+        for (size_t j = 0; j < band.parent.size(); ++j)
+            m_parent[offsets[i] + j] = offsets[i] + band.parent[j];
+        result.matched += band.matched;
+    }
+
+    // blobs crossing from the last row of one band into the first of the next
+    for (size_t i = 0; i + 1 < m_bands.size(); ++i)
+    {
+        const TrackBand &upper = m_bands[i], &lower = m_bands[i + 1];
+        if (upper.runs.empty() || lower.runs.empty() ||
+            upper.runs.back().y != upper.y1 - 1 ||
+            lower.runs.front().y != lower.y0)
+        {
+            continue;
+        }
+
+        int p = upper.last_begin, c = 0;
+        while (p < (int)upper.runs.size() && c < lower.first_end)
+        {
+            const TrackRun &above = upper.runs[p];
+            const TrackRun &here = lower.runs[c];
+            if (above.x1 < here.x0)
+                ++p;
+            else if (here.x1 < above.x0)
+                ++c;
+            else
+            {
+                join(m_parent, offsets[i] + p, offsets[i + 1] + c);
+                if (above.x1 < here.x1)
+                    ++p;
+                else
+                    ++c;
+            }
+        }
+    }
+
+    // gather each blob's area, moments and extent under its root
+    std::vector<int64_t> area(total, 0), sum_x2(total, 0), sum_y(total, 0);
+    std::vector<int> x1(total), y1(total), x2(total), y2(total);
+    for (size_t i = 0; i < m_bands.size(); ++i)
+    {
+        const TrackBand &band = m_bands[i];
+        for (size_t j = 0; j < band.runs.size(); ++j)
+        {
+            const TrackRun &run = band.runs[j];
+            int root = find(m_parent, offsets[i] + (int)j);
+            int64_t length = run.x1 - run.x0;
+            if (!area[root])
+            {
+                x1[root] = run.x0;
+                x2[root] = run.x1 - 1;
+                y1[root] = y2[root] = run.y;
+            }
+            else
+            {
+                x1[root] = std::min(x1[root], run.x0);
+                x2[root] = std::max(x2[root], run.x1 - 1);
+                y2[root] = std::max(y2[root], run.y);
+            }
+            area[root] += length;
+            sum_x2[root] += length * (run.x0 + run.x1 - 1);
+            sum_y[root] += length * run.y;
+        }
+    }
+
+    int best = -1;
+    for (int i = 0; i < total; ++i)
+    {
+        if (m_parent[i] != i || area[i] < m_minArea)
+            continue;
+        result.blobs++;
+        if (best < 0 || area[i] > area[best])
+            best = i;
+    }
+
+    if (best >= 0)
+    {
+        result.found = true;
+        result.x1 = x1[best];
+        result.y1 = y1[best];
+        result.x2 = x2[best];
+        result.y2 = y2[best];
+        result.area = (int)area[best];
+        result.xc = (float)(sum_x2[best] / 2.0 / area[best]);
+        result.yc = (float)((double)sum_y[best] / area[best]);
+    }
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+TrackResult ColorTracker::track(const uint32_t *pixels, int stride, int width,
+        int height)
+{
+    int count = prepare(width, height, 1);
+    for (int i = 0; i < count; ++i)
+        scanBand(i, pixels, stride);
+    return merge();
+}
@@ -0,0 +1,86 @@
+// -----------------------------------------------------------------------------
+// File:    ColorTracker.h
+// Created: 10-17-2026
+//
+// Ground side colour tracker. Thresholds a frame with the same settings the
+// vehicle uses, labels 8-connected blobs of matching pixels and reports the
+// largest one's bounding box and centroid. Labelling works on horizontal runs
+// rather than pixels, and the frame can be cut into bands of rows that are
+// scanned independently (on as many threads as there are bands) before a
+// short single threaded merge joins blobs that cross band edges.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_COLORTRACKER__H_
+#define _HELIVIEW_COLORTRACKER__H_
+
+#include <vector>
+#include "ColorThreshold.h"
+
+#define TRACKER_BAND_PIXELS     (256 * 1024)    // least work worth a thread
+
+struct TrackResult
+{
+    TrackResult()
+    : found(false), x1(0), y1(0), x2(0), y2(0), xc(0.0f), yc(0.0f),
+      area(0), blobs(0), matched(0) { }
+
+    bool  found;
+    int   x1, y1, x2, y2;   // bounding box, inclusive, in image pixels
+    float xc, yc;           // centroid
+    int   area;             // pixels in the chosen blob
+    int   blobs;            // blobs at least min_area in size
+    int   matched;          // pixels that passed the threshold
+};
+
+// a horizontal stretch of matching pixels [x0, x1) on row y
+struct TrackRun
+{
+    int y, x0, x1;
+};
+
+// runs and their provisional labels for one band of rows
+struct TrackBand
+{
+    std::vector<TrackRun> runs;
+    std::vector<int>      parent;       // union-find over run indices
+    std::vector<uint8_t>  mask;
+    int                   first_end;    // runs on the band's first row end
+    int                   last_begin;   // and those on its last row start
+    int                   y0, y1;       // rows [y0, y1)
+    int                   matched;
+};
+
+class ColorTracker
+{
+public:
+    ColorTracker();
+
+    void setThreshold(const ColorThreshold &threshold, int min_area);
+
+    // split a frame of the given height into bands, at most max_bands
+    int prepare(int width, int height, int max_bands);
+
+    // scan one band, distinct bands may be scanned concurrently
+    void scanBand(int band, const uint32_t *pixels, int stride);
+
+    // join the bands and pick the largest blob
+    TrackResult merge();
+
+    // all of the above on the calling thread
+    TrackResult track(const uint32_t *pixels, int stride, int width,
+            int height);
+
+    int bands() const { return (int)m_bands.size(); }
+
+protected:
+    static int find(std::vector<int> &parent, int i);
+    static void join(std::vector<int> &parent, int a, int b);
+
+    std::vector<TrackBand> m_bands;
+    std::vector<int>       m_parent;    // merged union-find over all runs
+    ColorThreshold         m_threshold;
+    int                    m_minArea;
+    int                    m_width;
+};
+
+#endif // _HELIVIEW_COLORTRACKER__H_
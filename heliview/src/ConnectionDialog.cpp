@@ -53,16 +53,45 @@ void ConnectionDialog::onComboChanged(int index)
     if (text == "network")
     {
         lblDescription->setText("Connect to a device over a network. "
-                "Device string must be in the form address:port.\n\n"
-                "Example:\n    192.168.1.101:8090");
+                "Device string must be in the form address:port, optionally "
+                "followed by comma separated options.\n\n"
+                "Options:\n    thread - run socket i/o on its own thread\n"
+                "    telem=N, video=N - sample rates in Hz\n"
+                "    poll - never ask the vehicle to push samples\n"
+                "    shared - keep video on the control connection\n"
+                "    ctl=N - flight control rate in Hz, 50 to 200\n"
+                "    rt - send flight control at real-time priority\n\n"
+                "Use 'loopback' as the address for a local stand-in vehicle.\n\n"
+                "Example:\n    192.168.1.101:8090,thread,telem=50");
         editDevice->setEnabled(true);
     }
     else if (text == "serial")
     {
-        lblDescription->setText("Connect to a serial device. This must be the "
-                "serial port of either a 6DOF or 9DOF razor IMU.\n\n"
+        lblDescription->setText("Connect to a serial device. This is the "
+                "serial port of either a 6DOF or 9DOF razor IMU or, with the "
+                "binary option, a vehicle on a serial line or radio modem.\n\n"
+                "Options follow the port, separated by commas:\n"
+                "    baud=N - line rate, 57600 if not given\n"
+                "    binary - framed vehicle packets instead of razor text\n"
+                "    telem=N - telemetry rate in Hz (binary)\n"
+                "    poll - never ask the vehicle to push samples (binary)\n"
+                "    ctl=N, rt - flight control rate and priority (binary)\n\n"
                 "Example (Windows):\n    COM1\n"
-                "Example (Unix):\n    /dev/ttyUSB1\n");
+                "Example (Unix):\n    /dev/ttyUSB1,baud=921600,binary\n");
+        editDevice->setEnabled(true);
+    }
+    else if (text == "replay")
+    {
+        lblDescription->setText("Play back a flight recording (the telemetry "
+                "log file) through the normal displays. Device string is the "
+                "recording's path, optionally followed by comma separated "
+                "options.\n\n"
+                "Options:\n    speed=N - multiple of real time, or 'max' to "
+                "play as fast as possible\n"
+                "    start=N - seconds into the recording to begin at\n"
+                "    paused - open without starting playback\n"
+                "    loop - start over at the end\n\n"
+                "Example:\n    flight1.hvr,speed=10");
         editDevice->setEnabled(true);
     }
     else if (text == "simulated")
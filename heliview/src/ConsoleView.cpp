@@ -0,0 +1,264 @@
+// -----------------------------------------------------------------------------
+// File:    ConsoleView.cpp
+// Created: 10-17-2026
+//
+// Command log console model and view.
+// -----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstring>
+#include <QColor>
+#include <QFont>
+#include <QHBoxLayout>
+#include <QScrollBar>
+#include <QVBoxLayout>
+#include "ConsoleView.h"
+#include "Logger.h"
+
+#define CONSOLE_ALL_TYPES   (~0)
+#define CONSOLE_MAX_NAME    32      // longest word taken as a subsystem
+
+// -----------------------------------------------------------------------------
+ConsoleModel::ConsoleModel(QObject *parent)
+: QAbstractListModel(parent), m_first(0), m_end(0), m_types(CONSOLE_ALL_TYPES)
+{
+}
+
+// -----------------------------------------------------------------------------
+void ConsoleModel::append(int type, const QString &text)
+{
+    ConsoleLine line;
+    line.type = type;
+    line.subsystem = subsystemOf(type, text);
+
+    // one row per message, the trailing newline is the logger's convention
+    line.text = text;
+    while (line.text.endsWith('\n'))
+        line.text.chop(1);
+
+    m_pending.push_back(line);
+}
+
+// -----------------------------------------------------------------------------
+bool ConsoleModel::flush()
+{
+    if (m_pending.empty())
+        return false;
+
+    // a burst bigger than the ring only keeps its newest lines
+    size_t skip = 0;
+    if (m_pending.size() > CONSOLE_MAX_LINES)
+        skip = m_pending.size() - CONSOLE_MAX_LINES;
+
+    uint64_t end = m_end + (m_pending.size() - skip);
+    uint64_t first = std::max(m_first, (end > CONSOLE_MAX_LINES) ?
+            end - CONSOLE_MAX_LINES : 0);
+
+    // rows about to be overwritten go first, in one block
+    size_t expired = 0;
+    while (expired < m_rows.size() && m_rows[expired] < first)
+        ++expired;
+    if (expired)
+    {
+        beginRemoveRows(QModelIndex(), 0, (int)expired - 1);
+        m_rows.erase(m_rows.begin(), m_rows.begin() + expired);
+        endRemoveRows();
+    }
+
+    if (m_lines.size() < CONSOLE_MAX_LINES)
+        m_lines.resize(std::min((uint64_t)CONSOLE_MAX_LINES, end));
+
+    std::vector<uint64_t> added;
+    for (size_t i = skip; i < m_pending.size(); ++i)
+    {
+        const ConsoleLine &pending = m_pending[i];
+        uint64_t number = m_end + (i - skip);
+        m_lines[number % CONSOLE_MAX_LINES] = pending;
+
+        if (!pending.subsystem.isEmpty() &&
+            !m_subsystems.contains(pending.subsystem))
+        {
+            m_subsystems.insert(pending.subsystem);
+            emit subsystemAdded(pending.subsystem);
+        }
+
+        if (accepts(pending))
+            added.push_back(number);
+    }
+    m_pending.clear();
+    m_first = first;
+    m_end = end;
+
+    if (added.empty())
+        return false;
+
+    int row = (int)m_rows.size();
+    beginInsertRows(QModelIndex(), row, row + (int)added.size() - 1);
+    m_rows.insert(m_rows.end(), added.begin(), added.end());
+    endInsertRows();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void ConsoleModel::setFilter(int types, const QString &subsystem)
+{
+    beginResetModel();
+    m_types = types;
+    m_subsystem = subsystem;
+
+    m_rows.clear();
+    for (uint64_t number = m_first; number < m_end; ++number)
+    {
+        if (accepts(line(number)))
+            m_rows.push_back(number);
+    }
+    endResetModel();
+}
+
+// -----------------------------------------------------------------------------
+int ConsoleModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : (int)m_rows.size();
+}
+
+// -----------------------------------------------------------------------------
+QVariant ConsoleModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= (int)m_rows.size())
+        return QVariant();
+
+    const ConsoleLine &l = line(m_rows[index.row()]);
+    switch (role)
+    {
+    case Qt::DisplayRole:
+        return l.text;
+    case Qt::ForegroundRole:
+        if (l.type & (LOG_TYPE_FAIL | LOG_TYPE_ERR))
+            return QColor(Qt::red);
+        if (l.type & LOG_TYPE_WARN)
+            return QColor(255, 165, 0);
+        if (l.type & (LOG_TYPE_DBG | LOG_TYPE_EXTRADEBUG))
+            return QColor(34, 139, 34);
+        break;
+    case Qt::FontRole:
+        if (l.type & LOG_TYPE_FAIL)
+        {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+        break;
+    default:
+        break;
+    }
+    return QVariant();
+}
+
+// -----------------------------------------------------------------------------
+bool ConsoleModel::accepts(const ConsoleLine &line) const
+{
+    return (line.type & m_types) &&
+           (m_subsystem.isEmpty() || line.subsystem == m_subsystem);
+}
+
+// -----------------------------------------------------------------------------
+QString ConsoleModel::subsystemOf(int type, const QString &text)
+{
+    // messages read "<prefix>Subsystem: what happened", the subsystem being
+    // one word. anything else belongs to no subsystem in particular
+    int start = (int)strlen(Logger::prefix(type));
+    int colon = text.indexOf(':', start);
+    if (colon <= start || colon - start > CONSOLE_MAX_NAME)
+        return QString();
+
+    for (int i = start; i < colon; ++i)
+    {
+        if (!text.at(i).isLetterOrNumber())
+            return QString();
+    }
+    return text.mid(start, colon - start);
+}
+
+// -----------------------------------------------------------------------------
+ConsoleView::ConsoleView(QWidget *parent)
+: QWidget(parent), m_model(NULL), m_list(NULL), m_level(NULL),
+  m_subsystem(NULL), m_timer(NULL)
+{
+    m_model = new ConsoleModel(this);
+
+    // rows are all one line high, so the view never measures the text
+    m_list = new QListView(this);
+    m_list->setModel(m_model);
+    m_list->setUniformItemSizes(true);
+    m_list->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_list->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+    m_level = new QComboBox(this);
+    m_level->addItem(tr("Everything"), CONSOLE_ALL_TYPES);
+    m_level->addItem(tr("Information"), LOG_TYPE_FAIL | LOG_TYPE_ERR |
+            LOG_TYPE_WARN | LOG_TYPE_INFO | LOG_TYPE_TELEMETRY);
+    m_level->addItem(tr("Warnings"), LOG_TYPE_FAIL | LOG_TYPE_ERR | LOG_TYPE_WARN);
+    m_level->addItem(tr("Errors"), LOG_TYPE_FAIL | LOG_TYPE_ERR);
+
+    m_subsystem = new QComboBox(this);
+    m_subsystem->addItem(tr("All subsystems"), QString());
+    m_subsystem->setSizeAdjustPolicy(QComboBox::AdjustToContents);
+
+    QVBoxLayout *filters = new QVBoxLayout;
+    filters->addWidget(m_level);
+    filters->addWidget(m_subsystem);
+    filters->addStretch();
+
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_list, 1);
+    layout->addLayout(filters);
+
+    connect(m_level, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(onFilterChanged()));
+    connect(m_subsystem, SIGNAL(currentIndexChanged(int)),
+            this, SLOT(onFilterChanged()));
+    connect(m_model, SIGNAL(subsystemAdded(const QString &)),
+            this, SLOT(onSubsystemAdded(const QString &)));
+
+    m_timer = new QTimer(this);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(onRefresh()));
+    m_timer->start(CONSOLE_REFRESH_MS);
+}
+
+// -----------------------------------------------------------------------------
+ConsoleView::~ConsoleView()
+{
+    SafeDelete(m_timer);
+}
+
+// -----------------------------------------------------------------------------
+void ConsoleView::append(int type, const QString &text)
+{
+    m_model->append(type, text);
+}
+
+// -----------------------------------------------------------------------------
+void ConsoleView::onRefresh()
+{
+    // follow new lines only if the operator hasn't scrolled up to read
+    QScrollBar *bar = m_list->verticalScrollBar();
+    bool following = bar->value() == bar->maximum();
+
+    if (m_model->flush() && following)
+        m_list->scrollToBottom();
+}
+
+// -----------------------------------------------------------------------------
+void ConsoleView::onFilterChanged()
+{
+    m_model->setFilter(m_level->itemData(m_level->currentIndex()).toInt(),
+            m_subsystem->itemData(m_subsystem->currentIndex()).toString());
+    m_list->scrollToBottom();
+}
+
+// -----------------------------------------------------------------------------
+void ConsoleView::onSubsystemAdded(const QString &name)
+{
+    m_subsystem->addItem(name, name);
+}
@@ -0,0 +1,101 @@
+// -----------------------------------------------------------------------------
+// File:    ConsoleView.h
+// Created: 10-17-2026
+//
+// Command log console. Lines are kept in a ring of CONSOLE_MAX_LINES and
+// shown through a list view, which only ever draws the rows on screen.
+// Messages queue up as they arrive and are added to the model in one batch
+// per refresh. Filtering by level and subsystem happens in the model.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_CONSOLEVIEW__H_
+#define _HELIVIEW_CONSOLEVIEW__H_
+
+#include <deque>
+#include <vector>
+#include <QAbstractListModel>
+#include <QComboBox>
+#include <QListView>
+#include <QSet>
+#include <QTimer>
+#include <QWidget>
+#include "Utility.h"
+
+#define CONSOLE_MAX_LINES   10000
+#define CONSOLE_REFRESH_MS  100
+
+struct ConsoleLine
+{
+    int     type;           // LOG_TYPE_*
+    QString subsystem;      // "NetworkDevice" for "NetworkDevice: ...", or empty
+    QString text;
+};
+
+// -----------------------------------------------------------------------------
+// Lines are numbered from the first one ever added. The ring holds numbers
+// [m_first, m_end), the rows are the numbers among those that pass the filter.
+class ConsoleModel: public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    ConsoleModel(QObject *parent);
+
+    // queue a line, nothing is shown until the next flush
+    void append(int type, const QString &text);
+
+    // add the queued lines as one batch, true if any rows were added
+    bool flush();
+
+    // LOG_TYPE_* bits to show, and one subsystem (empty for all)
+    void setFilter(int types, const QString &subsystem);
+
+    virtual int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    virtual QVariant data(const QModelIndex &index, int role) const;
+
+signals:
+    void subsystemAdded(const QString &name);
+
+protected:
+    bool accepts(const ConsoleLine &line) const;
+    const ConsoleLine &line(uint64_t number) const
+    { return m_lines[number % CONSOLE_MAX_LINES]; }
+
+    static QString subsystemOf(int type, const QString &text);
+
+    std::vector<ConsoleLine> m_lines;
+    uint64_t                 m_first;
+    uint64_t                 m_end;
+    std::deque<uint64_t>     m_rows;
+    std::vector<ConsoleLine> m_pending;
+    QSet<QString>            m_subsystems;
+    int                      m_types;
+    QString                  m_subsystem;
+};
+
+// -----------------------------------------------------------------------------
+class ConsoleView: public QWidget
+{
+    Q_OBJECT
+
+public:
+    ConsoleView(QWidget *parent);
+    virtual ~ConsoleView();
+
+public slots:
+    void append(int type, const QString &text);
+
+protected slots:
+    void onRefresh();
+    void onFilterChanged();
+    void onSubsystemAdded(const QString &name);
+
+protected:
+    ConsoleModel *m_model;
+    QListView    *m_list;
+    QComboBox    *m_level;
+    QComboBox    *m_subsystem;
+    QTimer       *m_timer;
+};
+
+#endif // _HELIVIEW_CONSOLEVIEW__H_
@@ -0,0 +1,94 @@
+// -----------------------------------------------------------------------------
+// File:    ControlLatency.cpp
+// Created: 10-17-2026
+//
+// Gamepad to link latency breakdown.
+// -----------------------------------------------------------------------------
+
+#include <QObject>
+#include "ControlLatency.h"
+
+// -----------------------------------------------------------------------------
+// the time one stage took, false if either end is missing or out of order
+static bool StageMicros(const ControlTiming &timing, int stage,
+        uint64_t &micros)
+{
+    const uint64_t points[] = { timing.event, timing.read, timing.sampled,
+        timing.written };
+
+    uint64_t from = (CONTROL_STAGE_TOTAL == stage) ? points[0] : points[stage];
+    uint64_t to = (CONTROL_STAGE_TOTAL == stage) ? points[3] : points[stage + 1];
+    if (!from || !to || to < from)
+        return false;
+
+    micros = to - from;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+ControlLatency::ControlLatency()
+: m_packets(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+void ControlLatency::reset()
+{
+    for (int i = 0; i < CONTROL_STAGE_COUNT; ++i)
+        m_stages[i].reset();
+    m_packets = 0;
+}
+
+// -----------------------------------------------------------------------------
+void ControlLatency::record(const ControlTiming &timing)
+{
+    for (int i = 0; i < CONTROL_STAGE_COUNT; ++i)
+    {
+        uint64_t micros;
+        if (StageMicros(timing, i, micros))
+            m_stages[i].record(micros);
+    }
+    m_packets++;
+}
+
+// -----------------------------------------------------------------------------
+const char *ControlLatency::stageName(int stage)
+{
+    static const char *names[CONTROL_STAGE_COUNT] = {
+        "device", "sample", "write", "total"
+    };
+    return names[stage];
+}
+
+// -----------------------------------------------------------------------------
+QString ControlLatency::summary() const
+{
+    return LatencySummary(QObject::tr("Control latency over %1 packets (ms):\n")
+            .arg(m_packets), m_stages, CONTROL_STAGE_COUNT, stageName);
+}
+
+// -----------------------------------------------------------------------------
+void ControlLatency::writeCsv(QTextStream &out,
+        const QVector<ControlTiming> &timings)
+{
+    out << "event_us,read_us,sampled_us,written_us";
+    for (int i = 0; i < CONTROL_STAGE_COUNT; ++i)
+        out << "," << stageName(i) << "_us";
+    out << "\n";
+
+    // a stage that can't be measured is left empty rather than zero
+    for (int i = 0; i < timings.size(); ++i)
+    {
+        const ControlTiming &t = timings[i];
+        out << t.event << "," << t.read << "," << t.sampled << ","
+            << t.written;
+        for (int j = 0; j < CONTROL_STAGE_COUNT; ++j)
+        {
+            uint64_t micros;
+            out << ",";
+            if (StageMicros(t, j, micros))
+                out << micros;
+        }
+        out << "\n";
+    }
+}
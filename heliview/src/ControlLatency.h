@@ -0,0 +1,75 @@
+// -----------------------------------------------------------------------------
+// File:    ControlLatency.h
+// Created: 10-17-2026
+//
+// Timestamps of a stick movement on its way to the vehicle (the device's own
+// event time, read off the device, sampled by the control loop, written to the
+// link) and histograms of the time spent between each pair of them.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_CONTROLLATENCY__H_
+#define _HELIVIEW_CONTROLLATENCY__H_
+
+#include <QString>
+#include <QTextStream>
+#include <QVector>
+#include "LatencyHistogram.h"
+
+#define CONTROL_LATENCY_SAMPLES 16384   // timings kept for export
+
+// MonotonicMicros() at each point one flight control packet passed, 0 where
+// it didn't get that far. event is the read time where the pad has no clock
+// of its own (joydev, or evdev without EVIOCSCLOCKID)
+struct ControlTiming
+{
+    ControlTiming() : event(0), read(0), sampled(0), written(0) { }
+
+    uint64_t event;
+    uint64_t read;
+    uint64_t sampled;
+    uint64_t written;
+};
+
+enum ControlLatencyStage
+{
+    CONTROL_STAGE_DEVICE,   // device event to read by the gamepad thread
+    CONTROL_STAGE_SAMPLE,   // read to picked up by a control tick
+    CONTROL_STAGE_WRITE,    // tick to bytes written (link queues, syscall)
+    CONTROL_STAGE_TOTAL,    // device event to bytes written
+    CONTROL_STAGE_COUNT,
+};
+
+// told when a flight control packet has left the machine, from whichever
+// thread wrote it
+class ControlTimingSink
+{
+public:
+    virtual ~ControlTimingSink() { }
+    virtual void recordControl(const ControlTiming &timing) = 0;
+};
+
+class ControlLatency
+{
+public:
+    ControlLatency();
+
+    void record(const ControlTiming &timing);
+    void reset();
+
+    uint64_t packets() const { return m_packets; }
+    const LatencyHistogram &stage(int stage) const { return m_stages[stage]; }
+    static const char *stageName(int stage);
+
+    // one line per stage with p50/p95/p99/max in milliseconds
+    QString summary() const;
+
+    // one row per timing, absolute points then each stage in microseconds
+    static void writeCsv(QTextStream &out,
+            const QVector<ControlTiming> &timings);
+
+protected:
+    LatencyHistogram m_stages[CONTROL_STAGE_COUNT];
+    uint64_t         m_packets;
+};
+
+#endif // _HELIVIEW_CONTROLLATENCY__H_
@@ -7,6 +7,7 @@
 // -----------------------------------------------------------------------------
 
 #include "NetworkDeviceController.h"
+#include "ReplayDeviceController.h"
 #include "SerialDeviceController.h"
 #include "SimulatedDeviceController.h"
 #include "Logger.h"
@@ -107,6 +108,23 @@ bool DeviceController::requestKillswitch() const
     return true;
 }
 
+// -----------------------------------------------------------------------------
+void DeviceController::setGamepad(Gamepad *gamepad)
+{
+}
+
+// -----------------------------------------------------------------------------
+ControlLatency DeviceController::controlLatency() const
+{
+    return ControlLatency();
+}
+
+// -----------------------------------------------------------------------------
+QVector<ControlTiming> DeviceController::controlTimings() const
+{
+    return QVector<ControlTiming>();
+}
+
 // -----------------------------------------------------------------------------
 void DeviceController::onInputReady(GamepadEvent event, int index, float value)
 {
@@ -171,7 +189,32 @@ DeviceController *CreateDeviceController(
         return new SerialDeviceController(device);
     else if (name == "simulated")
         return new SimulatedDeviceController(device);
+    else if (name == "replay")
+        return new ReplayDeviceController(device);
     else
         return NULL;
 }
 
+
+// -----------------------------------------------------------------------------
+QString ParseDeviceOptions(const QString &device, DeviceOptions &options)
+{
+    // device strings take the form "target,option,option=value,..." where the
+    // target is whatever the controller itself expects (addr:port, tty, ...)
+    QStringList fields = device.split(",", QString::SkipEmptyParts);
+    if (fields.isEmpty())
+        return QString();
+
+    QString target = fields.takeFirst().trimmed();
+    for (int i = 0; i < fields.size(); ++i)
+    {
+        int eq = fields[i].indexOf('=');
+        if (eq < 0)
+            options.insert(fields[i].trimmed(), QString());
+        else
+            options.insert(fields[i].left(eq).trimmed(),
+                           fields[i].mid(eq + 1).trimmed());
+    }
+
+    return target;
+}
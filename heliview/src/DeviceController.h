@@ -9,8 +9,12 @@
 #ifndef _HELIVIEW_DEVICECONTROLLER__H_
 #define _HELIVIEW_DEVICECONTROLLER__H_
 
+#include <QMap>
+#include <QVector>
 #include <QWidget>
+#include "ControlLatency.h"
 #include "Gamepad.h"
+#include "VideoLatency.h"
 
 enum DeviceState
 {
@@ -77,6 +81,14 @@ public:
     virtual bool requestKillswitch() const;
     virtual bool requestColors() const;
 
+    // the pad a control loop may sample directly, NULL to let go of it
+    virtual void setGamepad(Gamepad *gamepad);
+
+    // stick to link latency of flight control so far, and the latest
+    // individual timings oldest first. empty for links that don't fly
+    virtual ControlLatency controlLatency() const;
+    virtual QVector<ControlTiming> controlTimings() const;
+
 public slots:
     virtual void onInputReady(GamepadEvent event, int index, float value);
     virtual void onUpdateTrackControlEnable(int track_en);
@@ -89,9 +101,10 @@ public slots:
 
 signals:
     void telemetryReady(float yaw, float pitch, float roll, float alt,
-            int rssi, int batt, int aux, int cpu);
+            int rssi, int batt, int aux, int cpu, uint64_t received);
     void connectionStatusChanged(const QString &text, bool status);
-    void videoFrameReady(const char *data, size_t length);
+    void videoFrameReady(const char *data, size_t length,
+            const FrameTiming &timing);
     void trackStatusUpdate(bool en, const QRect &bb, const QPoint &cp);
     void colorValuesUpdate(TrackSettings track);
     void deviceControlUpdated(const QString &name, const QString &type,
@@ -109,9 +122,13 @@ signals:
     void landing();
 };
 
+typedef QMap<QString, QString> DeviceOptions;
+
 DeviceController *CreateDeviceController(
         const QString &name,
         const QString &device);
 
+QString ParseDeviceOptions(const QString &device, DeviceOptions &options);
+
 #endif // _HELIVIEW_DEVICECONTROLLER__H_
 
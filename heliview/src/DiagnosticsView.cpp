@@ -0,0 +1,101 @@
+// -----------------------------------------------------------------------------
+// File:    DiagnosticsView.cpp
+// Created: 10-17-2026
+//
+// Table of latency histograms.
+// -----------------------------------------------------------------------------
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QVBoxLayout>
+#include "DiagnosticsView.h"
+#include "Utility.h"
+
+// -----------------------------------------------------------------------------
+DiagnosticsView::DiagnosticsView(QWidget *parent)
+: QWidget(parent), m_table(NULL), m_export(NULL), m_timer(NULL)
+{
+    QStringList headers;
+    headers << tr("Samples") << tr("p50 (ms)") << tr("p95 (ms)")
+            << tr("p99 (ms)") << tr("Max (ms)");
+
+    m_table = new QTableWidget(0, DIAG_COLUMNS, this);
+    m_table->setHorizontalHeaderLabels(headers);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionMode(QAbstractItemView::NoSelection);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+
+    m_export = new QPushButton(tr("Export Control Timings..."), this);
+    connect(m_export, SIGNAL(clicked()), this, SIGNAL(exportRequested()));
+
+    QHBoxLayout *buttons = new QHBoxLayout();
+    buttons->addStretch();
+    buttons->addWidget(m_export);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(m_table);
+    layout->addLayout(buttons);
+
+    // nobody needs the numbers while the tab is hidden
+    m_timer = new QTimer(this);
+    connect(m_timer, SIGNAL(timeout()), this, SIGNAL(refreshRequested()));
+}
+
+// -----------------------------------------------------------------------------
+DiagnosticsView::~DiagnosticsView()
+{
+    SafeDelete(m_timer);
+}
+
+// -----------------------------------------------------------------------------
+void DiagnosticsView::setHistogram(const QString &name,
+        const LatencyHistogram &histogram)
+{
+    QMap<QString, int>::iterator it = m_rows.find(name);
+    if (it == m_rows.end())
+    {
+        int row = m_table->rowCount();
+        m_table->insertRow(row);
+        m_table->setVerticalHeaderItem(row, new QTableWidgetItem(name));
+        it = m_rows.insert(name, row);
+    }
+
+    int row = it.value();
+    setCell(row, DIAG_COLUMN_COUNT, QString::number(histogram.count()));
+    setCell(row, DIAG_COLUMN_P50,
+            QString::number(histogram.percentile(0.50) / 1000.0, 'f', 2));
+    setCell(row, DIAG_COLUMN_P95,
+            QString::number(histogram.percentile(0.95) / 1000.0, 'f', 2));
+    setCell(row, DIAG_COLUMN_P99,
+            QString::number(histogram.percentile(0.99) / 1000.0, 'f', 2));
+    setCell(row, DIAG_COLUMN_MAX,
+            QString::number(histogram.maximum() / 1000.0, 'f', 2));
+}
+
+// -----------------------------------------------------------------------------
+void DiagnosticsView::setCell(int row, int column, const QString &text)
+{
+    QTableWidgetItem *item = m_table->item(row, column);
+    if (!item)
+    {
+        item = new QTableWidgetItem();
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        m_table->setItem(row, column, item);
+    }
+    item->setText(text);
+}
+
+// -----------------------------------------------------------------------------
+void DiagnosticsView::showEvent(QShowEvent *e)
+{
+    QWidget::showEvent(e);
+    emit refreshRequested();
+    m_timer->start(DIAGNOSTICS_REFRESH_MS);
+}
+
+// -----------------------------------------------------------------------------
+void DiagnosticsView::hideEvent(QHideEvent *e)
+{
+    QWidget::hideEvent(e);
+    m_timer->stop();
+}
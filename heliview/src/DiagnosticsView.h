@@ -0,0 +1,59 @@
+// -----------------------------------------------------------------------------
+// File:    DiagnosticsView.h
+// Created: 10-17-2026
+//
+// Table of latency histograms, one row per measured stage, showing sample
+// count and p50/p95/p99/max in milliseconds. Asks to be refreshed once a second
+// while it is on screen, and for the raw control timings to be exported.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_DIAGNOSTICSVIEW__H_
+#define _HELIVIEW_DIAGNOSTICSVIEW__H_
+
+#include <QMap>
+#include <QPushButton>
+#include <QTableWidget>
+#include <QTimer>
+#include <QWidget>
+#include "LatencyHistogram.h"
+
+#define DIAGNOSTICS_REFRESH_MS  1000
+
+enum DiagnosticsColumn
+{
+    DIAG_COLUMN_COUNT,
+    DIAG_COLUMN_P50,
+    DIAG_COLUMN_P95,
+    DIAG_COLUMN_P99,
+    DIAG_COLUMN_MAX,
+    DIAG_COLUMNS,
+};
+
+class DiagnosticsView: public QWidget
+{
+    Q_OBJECT
+
+public:
+    DiagnosticsView(QWidget *parent);
+    virtual ~DiagnosticsView();
+
+    // adds the row the first time a name is seen, rows keep their order
+    void setHistogram(const QString &name, const LatencyHistogram &histogram);
+
+signals:
+    void refreshRequested();
+    void exportRequested();
+
+protected:
+    virtual void showEvent(QShowEvent *e);
+    virtual void hideEvent(QHideEvent *e);
+
+    void setCell(int row, int column, const QString &text);
+
+    QTableWidget      *m_table;
+    QPushButton       *m_export;
+    QTimer            *m_timer;
+    QMap<QString, int> m_rows;
+};
+
+#endif // _HELIVIEW_DIAGNOSTICSVIEW__H_
@@ -0,0 +1,506 @@
+// -----------------------------------------------------------------------------
+// File:    FlightRecorder.cpp
+// Created: 10-17-2026
+//
+// Binary flight recorder writer and reader.
+// -----------------------------------------------------------------------------
+
+#include <QDateTime>
+#include <cstring>
+#include "FlightRecorder.h"
+#include "Logger.h"
+
+#ifdef PLATFORM_UNIX_GCC
+#include <fcntl.h>
+#endif
+
+#define RECORD_SIZE ((uint32_t)sizeof(FlightRecord))
+
+// -----------------------------------------------------------------------------
+FlightRecorder *FlightRecorder::instance()
+{
+    static FlightRecorder recorder;
+    return &recorder;
+}
+
+// -----------------------------------------------------------------------------
+QString FlightRecorder::defaultPath()
+{
+    QString tstamp = QDateTime::currentDateTime().toString("MMM-dd-yyyy_hh-mm-ss");
+    return QString("heliview_%1.hvr").arg(tstamp);
+}
+
+// -----------------------------------------------------------------------------
+void FlightRecorder::telemetry(float yaw, float pitch, float roll, float alt,
+        int rssi, int batt, int aux, int cpu)
+{
+    FlightRecorder *recorder = FlightRecorder::instance();
+    if (!recorder->isOpen())
+        return;
+
+    FlightRecord record = makeRecord(RECORD_TELEMETRY);
+    record.telemetry.yaw = yaw;
+    record.telemetry.pitch = pitch;
+    record.telemetry.roll = roll;
+    record.telemetry.alt = alt;
+    record.telemetry.rssi = rssi;
+    record.telemetry.batt = batt;
+    record.telemetry.aux = aux;
+    record.telemetry.cpu = cpu;
+    recorder->append(record);
+}
+
+// -----------------------------------------------------------------------------
+void FlightRecorder::videoFrame(const char *data, size_t length)
+{
+    FlightRecorder *recorder = FlightRecorder::instance();
+    if (recorder->isOpen())
+        recorder->appendFrame(data, length);
+}
+
+// -----------------------------------------------------------------------------
+void FlightRecorder::controlState(int state, int axes)
+{
+    FlightRecorder *recorder = FlightRecorder::instance();
+    if (!recorder->isOpen())
+        return;
+
+    FlightRecord record = makeRecord(RECORD_CONTROL_STATE);
+    record.state.value = state;
+    record.state.axes = axes;
+    recorder->append(record);
+}
+
+// -----------------------------------------------------------------------------
+void FlightRecorder::flightState(int state)
+{
+    FlightRecorder *recorder = FlightRecorder::instance();
+    if (!recorder->isOpen())
+        return;
+
+    FlightRecord record = makeRecord(RECORD_FLIGHT_STATE);
+    record.state.value = state;
+    recorder->append(record);
+}
+
+// -----------------------------------------------------------------------------
+void FlightRecorder::trackStatus(bool enabled, const QRect &bb, const QPoint &cp)
+{
+    FlightRecorder *recorder = FlightRecorder::instance();
+    if (!recorder->isOpen())
+        return;
+
+    FlightRecord record = makeRecord(RECORD_TRACKING);
+    record.tracking.enabled = enabled ? 1 : 0;
+    bb.getCoords(&record.tracking.x1, &record.tracking.y1,
+                 &record.tracking.x2, &record.tracking.y2);
+    record.tracking.xc = cp.x();
+    record.tracking.yc = cp.y();
+    recorder->append(record);
+}
+
+// -----------------------------------------------------------------------------
+FlightRecord FlightRecorder::makeRecord(uint32_t type)
+{
+    FlightRecord record;
+    memset(&record, 0, sizeof(record));
+    record.timestamp = MonotonicMicros();
+    record.type = type;
+    return record;
+}
+
+// -----------------------------------------------------------------------------
+FlightRecorder::FlightRecorder()
+: m_frame_offset(0), m_map(NULL), m_header(NULL), m_records(NULL),
+  m_capacity(0), m_slot(0), m_dropped(0), m_queue(RECORDER_QUEUE_DEPTH),
+  m_frames(RECORDER_FRAME_DEPTH), m_frame_seq(0), m_thread(NULL), m_open(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+FlightRecorder::~FlightRecorder()
+{
+    close();
+}
+
+// -----------------------------------------------------------------------------
+bool FlightRecorder::isOpen() const
+{
+    return 0 != const_cast<QAtomicInt &>(m_open).fetchAndAddAcquire(0);
+}
+
+// -----------------------------------------------------------------------------
+bool FlightRecorder::open(const QString &path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate))
+    {
+        Logger::err(QObject::tr("FlightRecorder: unable to open %1\n").arg(path));
+        return false;
+    }
+
+    m_slot = 0;
+    m_dropped.fetchAndStoreRelaxed(0);
+    m_capacity = 0;
+    if (!reserve(RECORDER_CHUNK_SLOTS))
+    {
+        m_file.close();
+        return false;
+    }
+
+    // a missing sidecar only costs the video, the telemetry still records
+    m_frame_offset = 0;
+    m_frame_file.setFileName(path + RECORDER_FRAME_SUFFIX);
+    if (!m_frame_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        Logger::warn(QObject::tr("FlightRecorder: unable to open %1\n")
+                .arg(m_frame_file.fileName()));
+    }
+
+    memset(m_header, 0, sizeof(FlightRecordHeader));
+    memcpy(m_header->magic, RECORDER_MAGIC, sizeof(m_header->magic));
+    m_header->version = RECORDER_VERSION;
+    m_header->record_size = RECORD_SIZE;
+    m_header->index_stride = RECORDER_INDEX_STRIDE;
+    m_header->created = (uint64_t)QDateTime::currentDateTime().toTime_t() * 1000;
+
+    m_open.fetchAndStoreRelease(1);
+    m_thread = new FlightRecorderThread(this);
+    m_thread->start();
+
+    Logger::info(QObject::tr("FlightRecorder: recording to %1\n").arg(path));
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void FlightRecorder::close()
+{
+    if (!m_open.testAndSetOrdered(1, 0))
+        return;
+
+    m_thread->stop();
+    m_thread->wait();
+    SafeDelete(m_thread);
+
+    // whatever the writer hadn't picked up yet
+    while (drain()) { }
+
+    m_file.unmap(m_map);
+    m_map = NULL;
+    m_header = NULL;
+    m_records = NULL;
+
+    // give back the unused part of the pre-allocation
+    m_file.resize(RECORDER_HEADER_SIZE + m_slot * RECORD_SIZE);
+    m_file.close();
+    m_frame_file.close();
+
+    if (dropped())
+    {
+        Logger::warn(QObject::tr("FlightRecorder: %1 samples dropped\n")
+                .arg(dropped()));
+    }
+}
+
+// -----------------------------------------------------------------------------
+int FlightRecorder::dropped() const
+{
+    return const_cast<QAtomicInt &>(m_dropped).fetchAndAddAcquire(0);
+}
+
+// -----------------------------------------------------------------------------
+void FlightRecorder::append(const FlightRecord &record)
+{
+    // never block the producer, a full queue means the disk can't keep up
+    if (!m_queue.push(record))
+        m_dropped.fetchAndAddRelaxed(1);
+}
+
+// -----------------------------------------------------------------------------
+void FlightRecorder::appendFrame(const char *data, size_t length)
+{
+    // the payload goes first so the writer always finds it behind the record.
+    // if the record itself is then dropped the writer skips the orphan
+    PendingFrame frame;
+    frame.sequence = ++m_frame_seq;
+    frame.data = QByteArray(data, (int)length);
+    if (!m_frames.push(frame))
+    {
+        m_dropped.fetchAndAddRelaxed(1);
+        return;
+    }
+
+    FlightRecord record = makeRecord(RECORD_FRAME);
+    record.sequence = frame.sequence;
+    record.frame.length = (uint32_t)length;
+    append(record);
+}
+
+// -----------------------------------------------------------------------------
+bool FlightRecorder::reserve(uint64_t needed)
+{
+    if (needed <= m_capacity)
+        return true;
+
+    uint64_t capacity = m_capacity;
+    while (capacity < needed)
+        capacity += RECORDER_CHUNK_SLOTS;
+
+    if (m_map)
+    {
+        m_file.unmap(m_map);
+        m_map = NULL;
+    }
+
+    // allocate the blocks up front so appends never fault in new extents
+    qint64 size = RECORDER_HEADER_SIZE + capacity * RECORD_SIZE;
+    bool allocated = m_file.resize(size);
+#ifdef PLATFORM_UNIX_GCC
+    if (allocated)
+        allocated = 0 == posix_fallocate(m_file.handle(), 0, size);
+#endif
+
+    if (allocated)
+        m_map = m_file.map(0, size);
+
+    if (!m_map)
+    {
+        Logger::err(QObject::tr("FlightRecorder: unable to map %1 bytes of %2\n")
+                .arg(size).arg(m_file.fileName()));
+        m_header = NULL;
+        m_records = NULL;
+        return false;
+    }
+
+    m_header = (FlightRecordHeader *)m_map;
+    m_records = (FlightRecord *)(m_map + RECORDER_HEADER_SIZE);
+    m_capacity = capacity;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool FlightRecorder::store(const FlightRecord &record)
+{
+    if (!reserve(m_slot + 2))
+        return false;
+
+    // each block opens with the time of its first sample
+    if (0 == m_slot % RECORDER_INDEX_STRIDE)
+    {
+        FlightRecord &index = m_records[m_slot];
+        memset(&index, 0, RECORD_SIZE);
+        index.timestamp = record.timestamp;
+        index.type = RECORD_INDEX;
+        index.index.block = m_slot / RECORDER_INDEX_STRIDE;
+        ++m_slot;
+    }
+
+    m_records[m_slot++] = record;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool FlightRecorder::storeFrame(FlightRecord &record)
+{
+    PendingFrame frame;
+    do
+    {
+        if (!m_frames.pop(frame))
+            return false;
+    } while (frame.sequence != record.sequence);
+
+    if (!m_frame_file.isOpen() ||
+        frame.data.size() != m_frame_file.write(frame.data))
+    {
+        m_dropped.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    record.frame.offset = m_frame_offset;
+    m_frame_offset += frame.data.size();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool FlightRecorder::drain()
+{
+    if (!m_records)
+        return false;
+
+    FlightRecord record;
+    bool stored = false;
+    while (m_queue.pop(record))
+    {
+        if (RECORD_FRAME == record.type && !storeFrame(record))
+            continue;
+
+        if (!store(record))
+        {
+            m_dropped.fetchAndAddRelaxed(1);
+            continue;
+        }
+        stored = true;
+    }
+
+    // publish the count once per batch, a crash loses at most this batch.
+    // frames are flushed first so no published record points past the data
+    if (stored && m_header)
+    {
+        m_frame_file.flush();
+        m_header->used = m_slot;
+    }
+    return stored;
+}
+
+// -----------------------------------------------------------------------------
+FlightRecorderThread::FlightRecorderThread(FlightRecorder *recorder)
+: m_recorder(recorder), m_active(1)
+{
+}
+
+// -----------------------------------------------------------------------------
+void FlightRecorderThread::run()
+{
+    while (m_active.fetchAndAddAcquire(0))
+    {
+        if (!m_recorder->drain())
+            msleep(RECORDER_POLL_MS);
+    }
+}
+
+// -----------------------------------------------------------------------------
+void FlightRecorderThread::stop()
+{
+    m_active.fetchAndStoreRelease(0);
+}
+
+// -----------------------------------------------------------------------------
+FlightRecording::FlightRecording()
+: m_map(NULL), m_frame_map(NULL), m_frame_size(0), m_header(NULL),
+  m_records(NULL), m_count(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+FlightRecording::~FlightRecording()
+{
+    close();
+}
+
+// -----------------------------------------------------------------------------
+bool FlightRecording::open(const QString &path)
+{
+    close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly))
+    {
+        Logger::err(QObject::tr("FlightRecording: unable to open %1\n")
+                .arg(path));
+        return false;
+    }
+
+    qint64 size = m_file.size();
+    if (size >= RECORDER_HEADER_SIZE)
+        m_map = m_file.map(0, size);
+
+    const FlightRecordHeader *header = (const FlightRecordHeader *)m_map;
+    if (!header || memcmp(header->magic, RECORDER_MAGIC, sizeof(header->magic)) ||
+        RECORDER_VERSION != header->version || RECORD_SIZE != header->record_size ||
+        RECORDER_INDEX_STRIDE != header->index_stride)
+    {
+        Logger::err(QObject::tr("FlightRecording: %1 is not a flight recording\n")
+                .arg(path));
+        close();
+        return false;
+    }
+
+    // a recorder that died mid-flight leaves the pre-allocated tail behind,
+    // only the slots it published are trustworthy
+    uint64_t available = (size - RECORDER_HEADER_SIZE) / RECORD_SIZE;
+    m_header = header;
+    m_records = (const FlightRecord *)(m_map + RECORDER_HEADER_SIZE);
+    m_count = qMin(header->used, available);
+
+    // recordings without video simply have no sidecar
+    m_frame_file.setFileName(path + RECORDER_FRAME_SUFFIX);
+    if (m_frame_file.open(QIODevice::ReadOnly) && m_frame_file.size() > 0)
+    {
+        m_frame_size = m_frame_file.size();
+        m_frame_map = m_frame_file.map(0, m_frame_size);
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void FlightRecording::close()
+{
+    if (m_map)
+        m_file.unmap(m_map);
+    if (m_frame_map)
+        m_frame_file.unmap(m_frame_map);
+    m_file.close();
+    m_frame_file.close();
+    m_map = NULL;
+    m_frame_map = NULL;
+    m_frame_size = 0;
+    m_header = NULL;
+    m_records = NULL;
+    m_count = 0;
+}
+
+// -----------------------------------------------------------------------------
+const char *FlightRecording::frame(const FlightRecord &record) const
+{
+    if (!m_frame_map || RECORD_FRAME != record.type ||
+        record.frame.offset + record.frame.length > m_frame_size)
+        return NULL;
+    return (const char *)m_frame_map + record.frame.offset;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t FlightRecording::startTime() const
+{
+    return m_count ? m_records[0].timestamp : 0;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t FlightRecording::endTime() const
+{
+    return m_count ? m_records[m_count - 1].timestamp : 0;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t FlightRecording::seek(uint64_t timestamp) const
+{
+    if (!m_count)
+        return 0;
+
+    // binary search the index records for the last block starting at or
+    // before the target, then again within that block. the result may land
+    // on the next block's index record, which callers skip like any other
+    uint64_t blocks = (m_count + RECORDER_INDEX_STRIDE - 1) / RECORDER_INDEX_STRIDE;
+    uint64_t lo = 0, hi = blocks;
+    while (hi - lo > 1)
+    {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (m_records[mid * RECORDER_INDEX_STRIDE].timestamp <= timestamp)
+            lo = mid;
+        else
+            hi = mid;
+    }
+
+    uint64_t first = lo * RECORDER_INDEX_STRIDE + 1;
+    uint64_t last = qMin(m_count, first - 1 + RECORDER_INDEX_STRIDE);
+    while (first < last)
+    {
+        uint64_t mid = first + (last - first) / 2;
+        if (m_records[mid].timestamp < timestamp)
+            first = mid + 1;
+        else
+            last = mid;
+    }
+    return qMin(first, m_count);
+}
@@ -0,0 +1,216 @@
+// -----------------------------------------------------------------------------
+// File:    FlightRecorder.h
+// Created: 10-17-2026
+//
+// Binary flight recorder. Samples are fixed size records appended to a
+// memory-mapped, pre-allocated file by a background writer; every
+// RECORDER_INDEX_STRIDE'th slot holds an index record so that a recording can
+// be searched by time without reading it end to end. Video frames are too big
+// for a slot, their bytes go to a sidecar file (RECORDER_FRAME_SUFFIX) that
+// frame records point into.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_FLIGHTRECORDER__H_
+#define _HELIVIEW_FLIGHTRECORDER__H_
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QFile>
+#include <QPoint>
+#include <QRect>
+#include <QThread>
+#include "SpscQueue.h"
+#include "Utility.h"
+
+#define RECORDER_MAGIC          "HVREC01"
+#define RECORDER_VERSION        1
+#define RECORDER_HEADER_SIZE    4096            // records start here
+#define RECORDER_INDEX_STRIDE   1024            // slots per index record
+#define RECORDER_CHUNK_SLOTS    (1024 * 1024)   // file growth, ~48 MB
+#define RECORDER_QUEUE_DEPTH    16384           // ~1.6 s of slack at 10 kHz
+#define RECORDER_FRAME_DEPTH    64              // frames waiting for the disk
+#define RECORDER_FRAME_SUFFIX   ".mjpg"         // concatenated jpeg frames
+#define RECORDER_POLL_MS        5               // writer sleep when idle
+
+enum FlightRecordType
+{
+    RECORD_INDEX = 0,
+    RECORD_TELEMETRY,
+    RECORD_FRAME,
+    RECORD_CONTROL_STATE,
+    RECORD_FLIGHT_STATE,
+    RECORD_TRACKING,
+};
+
+// one slot of a recording, always RECORD_SIZE bytes on disk
+struct FlightRecord
+{
+    uint64_t timestamp;     // MonotonicMicros() when the sample arrived
+    uint32_t type;          // FlightRecordType
+    uint32_t sequence;      // frame records only, pairs record and payload
+    union
+    {
+        struct
+        {
+            float   yaw, pitch, roll, alt;
+            int32_t rssi, batt, aux, cpu;
+        } telemetry;
+
+        struct
+        {
+            uint64_t offset;    // into the frame sidecar
+            uint32_t length;
+        } frame;
+
+        struct
+        {
+            int32_t value;      // DeviceState or flight state
+            int32_t axes;       // AXIS_* bits for control states
+        } state;
+
+        struct
+        {
+            int32_t enabled;
+            int32_t x1, y1, x2, y2;
+            int32_t xc, yc;
+        } tracking;
+
+        struct
+        {
+            uint64_t block;     // slot / RECORDER_INDEX_STRIDE
+        } index;
+
+        uint32_t words[8];
+    };
+};
+
+struct FlightRecordHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t index_stride;
+    uint32_t reserved;
+    uint64_t used;          // slots in use, index records included
+    uint64_t created;       // wall clock when opened, ms since the epoch
+};
+
+// a frame's bytes on their way to the writer
+struct PendingFrame
+{
+    uint32_t   sequence;
+    QByteArray data;
+};
+
+class FlightRecorderThread;
+
+// -----------------------------------------------------------------------------
+// Writer side. A singleton like the Logger: the GUI opens and closes it, the
+// active device controller feeds it. Only one thread may record at a time.
+class FlightRecorder
+{
+public:
+    static FlightRecorder *instance();
+
+    // a new file for every session, heliview_<time>.hvr like the video
+    // recordings, so opening the recorder never truncates an earlier flight
+    static QString defaultPath();
+
+    // cheap enough to call for every sample, a no-op while closed
+    static void telemetry(float yaw, float pitch, float roll, float alt,
+            int rssi, int batt, int aux, int cpu);
+    static void videoFrame(const char *data, size_t length);
+    static void controlState(int state, int axes);
+    static void flightState(int state);
+    static void trackStatus(bool enabled, const QRect &bb, const QPoint &cp);
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const;
+    QString fileName() const { return m_file.fileName(); }
+
+    void append(const FlightRecord &record);
+    void appendFrame(const char *data, size_t length);
+    uint64_t written() const { return m_slot; }
+    int dropped() const;
+
+protected:
+    FlightRecorder();
+    ~FlightRecorder();
+
+    friend class FlightRecorderThread;
+
+    static FlightRecord makeRecord(uint32_t type);
+
+    bool drain();
+    bool store(const FlightRecord &record);
+    bool storeFrame(FlightRecord &record);
+    bool reserve(uint64_t needed);
+
+    QFile                   m_file;
+    QFile                   m_frame_file;
+    uint64_t                m_frame_offset; // sidecar bytes written
+    uchar                  *m_map;
+    FlightRecordHeader     *m_header;
+    FlightRecord           *m_records;
+    uint64_t                m_capacity;     // slots currently mapped
+    uint64_t                m_slot;         // next free slot
+    QAtomicInt              m_dropped;      // samples lost to a full queue
+    SpscQueue<FlightRecord> m_queue;
+    SpscQueue<PendingFrame> m_frames;       // payloads of queued frame records
+    uint32_t                m_frame_seq;
+    FlightRecorderThread   *m_thread;
+    QAtomicInt              m_open;
+};
+
+// -----------------------------------------------------------------------------
+// Background writer, moves records from the queue into the mapping.
+class FlightRecorderThread: public QThread
+{
+public:
+    FlightRecorderThread(FlightRecorder *recorder);
+
+    virtual void run();
+    virtual void stop();
+
+protected:
+    FlightRecorder *m_recorder;
+    QAtomicInt      m_active;
+};
+
+// -----------------------------------------------------------------------------
+// Reader side, maps a finished (or crashed) recording for random access.
+class FlightRecording
+{
+public:
+    FlightRecording();
+    ~FlightRecording();
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return NULL != m_records; }
+
+    uint64_t count() const { return m_count; }
+    const FlightRecord &at(uint64_t slot) const { return m_records[slot]; }
+
+    // bytes of a RECORD_FRAME, NULL if the sidecar is missing or short
+    const char *frame(const FlightRecord &record) const;
+    const FlightRecordHeader &header() const { return *m_header; }
+
+    // first slot whose record is at or after timestamp (count() if none)
+    uint64_t seek(uint64_t timestamp) const;
+    uint64_t startTime() const;
+    uint64_t endTime() const;
+
+protected:
+    QFile                     m_file;
+    QFile                     m_frame_file;
+    uchar                    *m_map;
+    uchar                    *m_frame_map;
+    uint64_t                  m_frame_size;
+    const FlightRecordHeader *m_header;
+    const FlightRecord       *m_records;
+    uint64_t                  m_count;
+};
+
+#endif // _HELIVIEW_FLIGHTRECORDER__H_
@@ -9,6 +9,10 @@
 #define _HELIVIEW_GAMEPAD__H_
 
 #include <QObject>
+#include "Utility.h"
+
+#define GP_MAX_AXES     16
+#define GP_MAX_BUTTONS  32
 
 enum GamepadEvent
 {
@@ -16,6 +20,24 @@ enum GamepadEvent
     GP_EVENT_AXIS
 };
 
+// the whole pad as of one input frame. timestamp is when the device reported
+// the frame (the kernel's stamp where there is one), received when it was read
+// from the device, both MonotonicMicros
+struct GamepadState
+{
+    GamepadState() : timestamp(0), received(0), sequence(0), buttons(0)
+    {
+        for (int i = 0; i < GP_MAX_AXES; ++i)
+            axes[i] = 0.0f;
+    }
+
+    uint64_t timestamp;
+    uint64_t received;
+    uint32_t sequence;              // counts frames since the pad was started
+    uint32_t buttons;               // bit n set while button n is held
+    float    axes[GP_MAX_AXES];     // -1.0 to 1.0
+};
+
 class Gamepad: public QObject
 {
     Q_OBJECT
@@ -31,6 +53,9 @@ public:
     virtual int driverVersion() = 0;
     virtual const QString &driverName() = 0;
 
+    // the latest frame, safe from any thread. false before the first one
+    virtual bool snapshot(GamepadState &state) const = 0;
+
 signals:
     void inputReady(GamepadEvent event, int index, float value);
 };
@@ -38,4 +63,3 @@ signals:
 Gamepad *CreateGamepad(void);
 
 #endif // _HELIVIEW_GAMEPAD__H_
-
@@ -0,0 +1,170 @@
+// -----------------------------------------------------------------------------
+// File:    GroundTracker.cpp
+// Created: 10-17-2026
+//
+// Runs the ground side colour tracker against decoded video.
+// -----------------------------------------------------------------------------
+
+#include <QThreadPool>
+#include "GroundTracker.h"
+
+// -----------------------------------------------------------------------------
+TrackerBandTask::TrackerBandTask(ColorTracker *tracker, QSemaphore *done)
+: m_tracker(tracker), m_done(done), m_pixels(NULL), m_band(0), m_stride(0)
+{
+    // owned and reused by the tracker, frame after frame
+    setAutoDelete(false);
+}
+
+// -----------------------------------------------------------------------------
+void TrackerBandTask::setBand(int band, const uint32_t *pixels, int stride)
+{
+    m_band = band;
+    m_pixels = pixels;
+    m_stride = stride;
+}
+
+// -----------------------------------------------------------------------------
+void TrackerBandTask::run()
+{
+    m_tracker->scanBand(m_band, m_pixels, m_stride);
+    m_done->release();
+}
+
+// -----------------------------------------------------------------------------
+GroundTracker::GroundTracker()
+: m_minArea(1), m_hasFrame(false), m_hasResult(false), m_active(true),
+  m_notifyPending(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+GroundTracker::~GroundTracker()
+{
+    stop();
+    wait();
+    qDeleteAll(m_tasks);
+}
+
+// -----------------------------------------------------------------------------
+void GroundTracker::submit(const VideoFrame &frame,
+        const ColorThreshold &threshold, int min_area)
+{
+    QMutexLocker lock(&m_lock);
+    if (m_hasFrame)
+        m_stats.dropped++;
+    m_frame = frame;
+    m_threshold = threshold;
+    m_minArea = min_area;
+    m_hasFrame = true;
+    m_wake.wakeOne();
+}
+
+// -----------------------------------------------------------------------------
+bool GroundTracker::takeResult(TrackResult &result, QSize &size)
+{
+    m_notifyPending.fetchAndStoreOrdered(0);
+
+    QMutexLocker lock(&m_lock);
+    if (!m_hasResult)
+        return false;
+
+    result = m_result;
+    size = m_size;
+    m_hasResult = false;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+GroundTrackStats GroundTracker::stats() const
+{
+    QMutexLocker lock(&m_lock);
+    return m_stats;
+}
+
+// -----------------------------------------------------------------------------
+void GroundTracker::stop()
+{
+    QMutexLocker lock(&m_lock);
+    m_active = false;
+    m_wake.wakeOne();
+}
+
+// -----------------------------------------------------------------------------
+TrackResult GroundTracker::track(const QImage &image)
+{
+    const uint32_t *pixels = (const uint32_t *)image.bits();
+    int stride = image.bytesPerLine() / 4;
+    int bands = m_tracker.prepare(image.width(), image.height(),
+            QThreadPool::globalInstance()->maxThreadCount());
+
+    // every band but the first goes to the pool, this thread takes that one
+    while (m_tasks.size() < bands - 1)
+        m_tasks.append(new TrackerBandTask(&m_tracker, &m_bandsDone));
+    for (int i = 1; i < bands; ++i)
+    {
+        m_tasks[i - 1]->setBand(i, pixels, stride);
+        QThreadPool::globalInstance()->start(m_tasks[i - 1]);
+    }
+
+    m_tracker.scanBand(0, pixels, stride);
+    m_bandsDone.acquire(bands - 1);
+    return m_tracker.merge();
+}
+
+// -----------------------------------------------------------------------------
+void GroundTracker::run()
+{
+    for (;;)
+    {
+        VideoFrame frame;
+        ColorThreshold threshold;
+        int min_area;
+        {
+            QMutexLocker lock(&m_lock);
+            while (m_active && !m_hasFrame)
+                m_wake.wait(&m_lock);
+            if (!m_active)
+                return;
+
+            frame = m_frame;
+            threshold = m_threshold;
+            min_area = m_minArea;
+            m_frame = VideoFrame();
+            m_hasFrame = false;
+        }
+
+        uint64_t start = MonotonicMicros();
+
+        // the display copy is usually decoded smaller than the camera sent
+        // it, the vehicle tracks at full size and so do we
+        QImage image = frame.image;
+        if (image.size() != frame.size && !frame.data.isEmpty())
+            image = VideoDecoder::decode(frame.data, frame.angle);
+        if (image.isNull())
+            continue;
+        if (image.format() != QImage::Format_RGB32 &&
+            image.format() != QImage::Format_ARGB32)
+        {
+            image = image.convertToFormat(QImage::Format_RGB32);
+        }
+
+        m_tracker.setThreshold(threshold, min_area);
+        TrackResult result = track(image);
+        uint64_t elapsed = MonotonicMicros() - start;
+
+        {
+            QMutexLocker lock(&m_lock);
+            m_stats.tracked++;
+            if (result.found)
+                m_stats.found++;
+            m_stats.track_time.record(elapsed);
+            m_result = result;
+            m_size = image.size();
+            m_hasResult = true;
+        }
+
+        if (m_notifyPending.testAndSetOrdered(0, 1))
+            emit resultReady();
+    }
+}
@@ -0,0 +1,98 @@
+// -----------------------------------------------------------------------------
+// File:    GroundTracker.h
+// Created: 10-17-2026
+//
+// Runs the ground side colour tracker against decoded video on a worker
+// thread, at the frame's full resolution so it sees what the vehicle sees.
+// Frames big enough to be worth it are split into bands that are scanned on
+// the global thread pool. Single slot at each end, the newest frame wins.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_GROUNDTRACKER__H_
+#define _HELIVIEW_GROUNDTRACKER__H_
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QSize>
+#include <QThread>
+#include <QWaitCondition>
+#include "ColorTracker.h"
+#include "LatencyHistogram.h"
+#include "VideoDecoder.h"
+
+struct GroundTrackStats
+{
+    GroundTrackStats() : tracked(0), dropped(0), found(0) { }
+
+    uint64_t tracked;
+    uint64_t dropped;       // replaced before they were tracked
+    uint64_t found;
+    LatencyHistogram track_time;
+};
+
+// scans one band of the current frame on a pool thread
+class TrackerBandTask: public QRunnable
+{
+public:
+    TrackerBandTask(ColorTracker *tracker, QSemaphore *done);
+
+    void setBand(int band, const uint32_t *pixels, int stride);
+    virtual void run();
+
+protected:
+    ColorTracker   *m_tracker;
+    QSemaphore     *m_done;
+    const uint32_t *m_pixels;
+    int             m_band;
+    int             m_stride;
+};
+
+class GroundTracker: public QThread
+{
+    Q_OBJECT
+
+public:
+    GroundTracker();
+    virtual ~GroundTracker();
+
+    // producer side, returns straight away. blobs smaller than min_area
+    // pixels are ignored, as the vehicle's filter threshold does.
+    void submit(const VideoFrame &frame, const ColorThreshold &threshold,
+            int min_area);
+
+    // consumer side, false if nothing new. size is that of the image the
+    // result's coordinates refer to.
+    bool takeResult(TrackResult &result, QSize &size);
+
+    GroundTrackStats stats() const;
+    void stop();
+
+signals:
+    void resultReady();
+
+protected:
+    virtual void run();
+    TrackResult track(const QImage &image);
+
+    mutable QMutex  m_lock;
+    QWaitCondition  m_wake;
+    VideoFrame      m_frame;
+    ColorThreshold  m_threshold;
+    int             m_minArea;
+    TrackResult     m_result;
+    QSize           m_size;
+    bool            m_hasFrame;
+    bool            m_hasResult;
+    bool            m_active;
+    QAtomicInt      m_notifyPending;
+    GroundTrackStats m_stats;
+
+    // only touched by the worker (and its band tasks)
+    ColorTracker    m_tracker;
+    QSemaphore      m_bandsDone;
+    QList<TrackerBandTask *> m_tasks;
+};
+
+#endif // _HELIVIEW_GROUNDTRACKER__H_
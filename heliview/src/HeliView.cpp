@@ -12,6 +12,7 @@
 #include <QDebug>
 #include "ApplicationFrame.h"
 #include "DeviceController.h"
+#include "FlightRecorder.h"
 #include "CommandLine.h"
 
 using namespace std;
@@ -21,8 +22,7 @@ namespace po = boost::program_options;
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
-    string source, logfile("heliview.log"), tlogfile("telemetry.log"), device, 
-        log_verbosity;
+    string source, logfile("heliview.log"), device, log_verbosity;
 
     bool show_usage = false;
     bool disable_virtual_view = false;
@@ -76,8 +76,13 @@ int main(int argc, char *argv[])
                 cerr << "invalid logging mode '" << log_verbosity << "' specified\n";
                 cerr << "defaulted logging mode to normal\n";
             }
-            frame.openLogFile(QString::fromStdString(logfile),
-                                QString::fromStdString(tlogfile));
+
+            // a replay has nothing new to record, and must not have the
+            // recorder opened on the file it is about to play
+            QString tlogfile;
+            if (source != "replay")
+                tlogfile = FlightRecorder::defaultPath();
+            frame.openLogFile(QString::fromStdString(logfile), tlogfile);
         }
 
         // optionally connect to a device if specified
@@ -0,0 +1,123 @@
+// -----------------------------------------------------------------------------
+// File:    LatencyHistogram.cpp
+// Created: 10-17-2026
+//
+// Fixed size log-linear histogram of latencies in microseconds.
+// -----------------------------------------------------------------------------
+
+#include <cstring>
+#include <QObject>
+#include "LatencyHistogram.h"
+
+// -----------------------------------------------------------------------------
+LatencyHistogram::LatencyHistogram()
+{
+    reset();
+}
+
+// -----------------------------------------------------------------------------
+void LatencyHistogram::reset()
+{
+    memset(m_buckets, 0, sizeof(m_buckets));
+    m_count = m_sum = m_max = 0;
+    m_min = ~(uint64_t)0;
+}
+
+// -----------------------------------------------------------------------------
+int LatencyHistogram::bucketIndex(uint64_t micros)
+{
+    // values below one octave of sub buckets map one to one
+    if (micros < LATENCY_SUB_BUCKETS)
+        return (int)micros;
+
+    // otherwise the top bit picks the octave, the next few bits the bucket
+    int exponent = 0;
+    for (uint64_t v = micros; v > 1; v >>= 1)
+        ++exponent;
+
+    int shift = exponent - LATENCY_SUB_BITS;
+    int index = (shift + 1) * LATENCY_SUB_BUCKETS +
+                (int)((micros >> shift) & (LATENCY_SUB_BUCKETS - 1));
+    return (index < LATENCY_BUCKETS) ? index : LATENCY_BUCKETS - 1;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t LatencyHistogram::bucketLower(int index)
+{
+    if (index < LATENCY_SUB_BUCKETS)
+        return (uint64_t)index;
+
+    int shift = index / LATENCY_SUB_BUCKETS - 1;
+    int sub = index % LATENCY_SUB_BUCKETS;
+    return (uint64_t)(LATENCY_SUB_BUCKETS + sub) << shift;
+}
+
+// -----------------------------------------------------------------------------
+void LatencyHistogram::record(uint64_t micros)
+{
+    ++m_buckets[bucketIndex(micros)];
+    ++m_count;
+    m_sum += micros;
+    if (micros < m_min) m_min = micros;
+    if (micros > m_max) m_max = micros;
+}
+
+// -----------------------------------------------------------------------------
+void LatencyHistogram::merge(const LatencyHistogram &other)
+{
+    for (int i = 0; i < LATENCY_BUCKETS; ++i)
+        m_buckets[i] += other.m_buckets[i];
+
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    if (other.m_min < m_min) m_min = other.m_min;
+    if (other.m_max > m_max) m_max = other.m_max;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    if (0 == m_count)
+        return 0;
+
+    uint64_t target = (uint64_t)(fraction * m_count + 0.5);
+    if (target < 1) target = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < LATENCY_BUCKETS; ++i)
+    {
+        seen += m_buckets[i];
+        if (seen >= target)
+        {
+            // report the middle of the bucket, clamped to what was seen
+            uint64_t lower = bucketLower(i);
+            uint64_t upper = (i + 1 < LATENCY_BUCKETS) ? bucketLower(i + 1) : m_max;
+            uint64_t value = lower + (upper - lower) / 2;
+            if (value < m_min) value = m_min;
+            if (value > m_max) value = m_max;
+            return value;
+        }
+    }
+    return m_max;
+}
+
+// -----------------------------------------------------------------------------
+QString LatencySummary(const QString &title, const LatencyHistogram *stages,
+        int count, const char *(*stageName)(int))
+{
+    QString text = title;
+    for (int i = 0; i < count; ++i)
+    {
+        const LatencyHistogram &h = stages[i];
+        if (!h.count())
+            continue;
+
+        text += QObject::tr("    %1 p50 %2 p95 %3 p99 %4 max %5\n")
+            .arg(QString(stageName(i)), -8)
+            .arg(h.percentile(0.50) / 1000.0, 0, 'f', 2)
+            .arg(h.percentile(0.95) / 1000.0, 0, 'f', 2)
+            .arg(h.percentile(0.99) / 1000.0, 0, 'f', 2)
+            .arg(h.maximum() / 1000.0, 0, 'f', 2);
+    }
+    return text;
+}
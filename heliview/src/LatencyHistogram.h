@@ -0,0 +1,57 @@
+// -----------------------------------------------------------------------------
+// File:    LatencyHistogram.h
+// Created: 10-17-2026
+//
+// Fixed size log-linear histogram of latencies in microseconds. Eight buckets
+// per power of two keeps every percentile within ~12% of the true value from
+// one microsecond up to over a minute, in constant memory and O(1) per sample.
+// Not thread safe, owners that share one must lock around it.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_LATENCYHISTOGRAM__H_
+#define _HELIVIEW_LATENCYHISTOGRAM__H_
+
+#include <QString>
+#include "Utility.h"
+
+#define LATENCY_SUB_BITS        3
+#define LATENCY_SUB_BUCKETS     (1 << LATENCY_SUB_BITS)
+#define LATENCY_BUCKETS         (LATENCY_SUB_BUCKETS * 36)
+
+class LatencyHistogram
+{
+public:
+    LatencyHistogram();
+
+    void record(uint64_t micros);
+    void merge(const LatencyHistogram &other);
+    void reset();
+
+    uint64_t count() const { return m_count; }
+    uint64_t minimum() const { return m_count ? m_min : 0; }
+    uint64_t maximum() const { return m_max; }
+    uint64_t mean() const { return m_count ? m_sum / m_count : 0; }
+
+    // value below which the given fraction (0.0 - 1.0) of samples fall
+    uint64_t percentile(double fraction) const;
+
+    // raw access for plotting
+    int buckets() const { return LATENCY_BUCKETS; }
+    uint64_t bucketCount(int index) const { return m_buckets[index]; }
+    static uint64_t bucketLower(int index);
+    static int bucketIndex(uint64_t micros);
+
+protected:
+    uint64_t m_buckets[LATENCY_BUCKETS];
+    uint64_t m_count;
+    uint64_t m_sum;
+    uint64_t m_min;
+    uint64_t m_max;
+};
+
+// title followed by one line per stage that has samples, with p50/p95/p99/max
+// in milliseconds. shared by the video and control latency breakdowns
+QString LatencySummary(const QString &title, const LatencyHistogram *stages,
+        int count, const char *(*stageName)(int));
+
+#endif // _HELIVIEW_LATENCYHISTOGRAM__H_
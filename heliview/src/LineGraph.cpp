@@ -6,14 +6,261 @@
 // Plot object that wraps QWT class.
 // -----------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cassert>
 #include <qwt_plot_grid.h>
+#include <qwt_scale_div.h>
+#include <qwt_scale_widget.h>
 #include "LineGraph.h"
 
+// -----------------------------------------------------------------------------
+GraphHistory::GraphHistory()
+: m_min(1), m_max(1), m_channel(TELEM_NONE), m_scale(1.0f), m_offset(0.0f),
+  m_count(0), m_generation(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+void GraphHistory::setSource(int channel, float scale, float offset)
+{
+    m_channel = channel;
+    m_scale = scale;
+    m_offset = offset;
+}
+
+// -----------------------------------------------------------------------------
+bool GraphHistory::sync(const TelemetryView &view)
+{
+    // a reset store starts again from sample 0 on a new time base
+    bool changed = false;
+    if (view.generation() != m_generation)
+    {
+        clear();
+        m_generation = view.generation();
+        changed = true;
+    }
+
+    if (TELEM_NONE == m_channel || view.end() <= m_count)
+        return changed;
+
+    // fold each new sample into the bucket that covers it on every level.
+    // samples the store let go before we saw them leave a flat gap
+    size_t i = std::max(m_count, view.begin());
+    while (i < view.end())
+    {
+        size_t count;
+        const float *values = view.column(m_channel, i, count);
+        for (size_t k = 0; k < count; ++k, ++i)
+        {
+            float v = values[k] * m_scale + m_offset;
+            for (size_t level = 1; level <= m_min.size(); ++level)
+            {
+                size_t bucket = i >> (GRAPH_LOD_BITS * level);
+                std::vector<float> &lo = m_min[level - 1];
+                std::vector<float> &hi = m_max[level - 1];
+                if (bucket >= lo.size())
+                {
+                    lo.resize(bucket + 1, v);
+                    hi.resize(bucket + 1, v);
+                }
+                else
+                {
+                    lo[bucket] = std::min(lo[bucket], v);
+                    hi[bucket] = std::max(hi[bucket], v);
+                }
+            }
+
+            size_t bucket = i >> GRAPH_LOD_BITS;
+            if (bucket >= m_time.size())
+                m_time.resize(bucket + 1, view.time(i));
+        }
+
+        m_count = i;
+
+        // a new level is worth having once it would hold more than one bucket
+        while (((size_t)1 << (GRAPH_LOD_BITS * (m_min.size() + 1))) < m_count)
+            addLevel();
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void GraphHistory::clear()
+{
+    m_time.clear();
+    m_min.assign(1, std::vector<float>());
+    m_max.assign(1, std::vector<float>());
+    m_count = 0;
+}
+
+// -----------------------------------------------------------------------------
+void GraphHistory::addLevel()
+{
+    size_t fanout = (size_t)1 << GRAPH_LOD_BITS;
+
+    // built once from the level below, kept up to date by sync()
+    m_min.push_back(std::vector<float>());
+    m_max.push_back(std::vector<float>());
+    const std::vector<float> &below_lo = m_min[m_min.size() - 2];
+    const std::vector<float> &below_hi = m_max[m_max.size() - 2];
+    std::vector<float> &lo = m_min.back();
+    std::vector<float> &hi = m_max.back();
+
+    for (size_t i = 0; i < below_lo.size(); ++i)
+    {
+        if (0 == i % fanout)
+        {
+            lo.push_back(below_lo[i]);
+            hi.push_back(below_hi[i]);
+        }
+        else
+        {
+            lo.back() = std::min(lo.back(), below_lo[i]);
+            hi.back() = std::max(hi.back(), below_hi[i]);
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+float GraphHistory::bucketMin(const TelemetryView &view, size_t level,
+        size_t bucket) const
+{
+    if (level)
+        return m_min[level - 1][bucket];
+    return view.value(m_channel, bucket) * m_scale + m_offset;
+}
+
+// -----------------------------------------------------------------------------
+float GraphHistory::bucketMax(const TelemetryView &view, size_t level,
+        size_t bucket) const
+{
+    if (level)
+        return m_max[level - 1][bucket];
+    return view.value(m_channel, bucket) * m_scale + m_offset;
+}
+
+// -----------------------------------------------------------------------------
+double GraphHistory::bucketTime(const TelemetryView &view, size_t level,
+        size_t bucket) const
+{
+    if (level)
+        return m_time[bucket << (GRAPH_LOD_BITS * (level - 1))];
+    return view.time(bucket);
+}
+
+// -----------------------------------------------------------------------------
+size_t GraphHistory::lowerBound(const TelemetryView &view, double t) const
+{
+    size_t end = std::min(m_count, view.end());
+    if (view.begin() < end && t >= view.time(view.begin()))
+        return std::min(view.lowerBound(t), end);
+
+    // the store no longer has it, the first level's bucket times will do
+    size_t bucket = (size_t)(std::lower_bound(m_time.begin(), m_time.end(), t) -
+            m_time.begin());
+    return std::min(bucket << GRAPH_LOD_BITS, m_count);
+}
+
+// -----------------------------------------------------------------------------
+void GraphHistory::decimate(const TelemetryView &view, double t0, double t1,
+        int columns, std::vector<double> &x, std::vector<double> &y) const
+{
+    x.clear();
+    y.clear();
+    if (0 == m_count || columns <= 0)
+        return;
+
+    // one sample either side so lines run off the edges rather than stop
+    size_t first = lowerBound(view, t0), last = lowerBound(view, t1);
+    if (first > 0)
+        --first;
+    if (last < m_count)
+        ++last;
+    if (first >= last)
+        return;
+
+    // raw samples only while the store still holds them
+    if (last - first <= (size_t)columns && first >= view.begin())
+    {
+        for (size_t i = first; i < last; ++i)
+        {
+            x.push_back(view.time(i));
+            y.push_back(bucketMin(view, 0, i));
+        }
+        return;
+    }
+
+    // coarsest level that still has at least one bucket per column, then
+    // fewer than 8 of its buckets are merged into each column. groups are
+    // aligned to absolute bucket numbers so scrolling does not shimmer.
+    size_t level = (first < view.begin()) ? 1 : 0;
+    while (level < m_min.size() &&
+           ((last - first) >> (GRAPH_LOD_BITS * (level + 1))) >= (size_t)columns)
+    {
+        ++level;
+    }
+
+    size_t shift = GRAPH_LOD_BITS * level;
+    size_t b0 = first >> shift, b1 = (last - 1) >> shift;
+    size_t group = (b1 - b0 + columns) / columns;
+
+    // each group becomes a vertical stroke from its minimum to its maximum
+    for (size_t g = b0 / group; g <= b1 / group; ++g)
+    {
+        size_t begin = std::max(g * group, b0), end = std::min((g + 1) * group, b1 + 1);
+        float lo = bucketMin(view, level, begin);
+        float hi = bucketMax(view, level, begin);
+        for (size_t b = begin + 1; b < end; ++b)
+        {
+            lo = std::min(lo, bucketMin(view, level, b));
+            hi = std::max(hi, bucketMax(view, level, b));
+        }
+
+        double t = bucketTime(view, level, begin);
+        x.push_back(t);
+        y.push_back(lo);
+        x.push_back(t);
+        y.push_back(hi);
+    }
+}
+
+// -----------------------------------------------------------------------------
+GraphData::GraphData(const std::vector<double> *x, const std::vector<double> *y)
+: m_x(x), m_y(y)
+{
+}
+
+// -----------------------------------------------------------------------------
+QwtData *GraphData::copy() const
+{
+    return new GraphData(m_x, m_y);
+}
+
+// -----------------------------------------------------------------------------
+size_t GraphData::size() const
+{
+    return m_x->size();
+}
+
+// -----------------------------------------------------------------------------
+double GraphData::x(size_t i) const
+{
+    return (*m_x)[i];
+}
+
+// -----------------------------------------------------------------------------
+double GraphData::y(size_t i) const
+{
+    return (*m_y)[i];
+}
+
 // -----------------------------------------------------------------------------
 LineGraph::LineGraph(QWidget *parent, const QString &graphLabel, double scale_max,
         double dependentStep)
-: m_primary(false), m_secondary(false), m_tertiary(false), m_numVisible(0), m_ticker(0)
+: m_zoomer(NULL), m_panner(NULL), m_magnifier(NULL), m_viewStart(0.0),
+  m_viewEnd(0.0), m_viewLatest(0.0), m_viewColumns(0), m_primary(false),
+  m_secondary(false), m_tertiary(false), m_dirty(false), m_follow(true),
+  m_scrolling(false), m_numVisible(0)
 {
     assert(NULL != parent);
 
@@ -31,7 +278,7 @@ LineGraph::LineGraph(QWidget *parent, const QString &graphLabel, double scale_ma
     xTitle.setFont(titleFont);
 
     m_plot->setAxisTitle(QwtPlot::xBottom, xTitle);
-    m_plot->setAxisScale(QwtPlot::xBottom, 1.0f, 60.0f, 10.0f);
+    m_plot->setAxisScale(QwtPlot::xBottom, 0.0f, GRAPH_WINDOW, 10.0f);
     m_plot->setAxisFont(QwtPlot::xBottom, axisFont);
 
     // set up Y axis
@@ -51,13 +298,33 @@ LineGraph::LineGraph(QWidget *parent, const QString &graphLabel, double scale_ma
     grid->setMajPen(QPen(Qt::gray, 0, Qt::DotLine));
     grid->attach(m_plot);
 
+    // the curves read the decimated view in place, and the axes are fixed,
+    // so nothing ever walks the whole history
     m_curvePrimary = new QwtPlotCurve("Acceleration");
     m_curvePrimary->setPen(QPen(Qt::red, 2));
     m_curvePrimary->setRenderHint(QwtPlotItem::RenderAntialiased);
+    m_curvePrimary->setItemAttribute(QwtPlotItem::AutoScale, false);
+    m_curvePrimary->setData(GraphData(&m_viewX[0], &m_viewY[0]));
 
     m_curveSecondary = new QwtPlotCurve("Velocity");
     m_curveSecondary->setPen(QPen(Qt::blue, 2));
     m_curveSecondary->setRenderHint(QwtPlotItem::RenderAntialiased);
+    m_curveSecondary->setItemAttribute(QwtPlotItem::AutoScale, false);
+    m_curveSecondary->setData(GraphData(&m_viewX[1], &m_viewY[1]));
+
+    // drag a box to zoom (right click backs out, all the way returns to
+    // following live data), middle drag pans and the wheel zooms in time
+    m_zoomer = new QwtPlotZoomer(m_plot->canvas());
+    m_panner = new QwtPlotPanner(m_plot->canvas());
+    m_panner->setMouseButton(Qt::MidButton);
+    m_panner->setAxisEnabled(QwtPlot::yLeft, false);
+    m_magnifier = new QwtPlotMagnifier(m_plot->canvas());
+    m_magnifier->setAxisEnabled(QwtPlot::yLeft, false);
+
+    connect(m_zoomer, SIGNAL(zoomed(const QwtDoubleRect &)),
+            this, SLOT(onZoomed(const QwtDoubleRect &)));
+    connect(m_plot->axisWidget(QwtPlot::xBottom), SIGNAL(scaleDivChanged()),
+            this, SLOT(onScaleChanged()));
 }
 
 // -----------------------------------------------------------------------------
@@ -78,34 +345,105 @@ bool LineGraph::isVisible() const
 }
 
 // -----------------------------------------------------------------------------
-void LineGraph::addDataPoint(float t, float value, float secondValue)
+void LineGraph::setSource(int curve, int channel, float scale, float offset)
+{
+    m_history[curve].setSource(channel, scale, offset);
+}
+
+// -----------------------------------------------------------------------------
+void LineGraph::refresh(const TelemetryView &view)
 {
-    // Should I make the method take in a generic float array of data values
-    // instead of taking in just two values?
-    // It would probably make it a pain to in ApplicationFrame to load each 
-    // value in an array and then pass it to the method
+    // hidden graphs keep up too, the store may let go of samples before
+    // they are shown again
+    for (int c = 0; c < 2; ++c)
+        m_dirty |= m_history[c].sync(view);
+    m_view = view;
+    redraw();
+}
 
-    m_time = t;
+// -----------------------------------------------------------------------------
+void LineGraph::redraw()
+{
+    if (!m_dirty || !m_plot->isVisible())
+        return;
+    m_dirty = false;
 
-    // XXX this is awful, implement scrolling in a more reasonable fashion
-    if (m_time >= 60.0)
+    if (m_follow)
     {
-        m_time = 59.5;
+        // scroll so the newest sample sits at the right hand edge
+        double start = std::max(0.0, latest() - GRAPH_WINDOW);
+        updateView(start, start + GRAPH_WINDOW);
 
-        m_polyPrimary.translate(-0.5, 0.0);
-        m_polyPrimary.pop_front();
-
-        m_polySecondary.translate(-0.5, 0.0);
-        m_polySecondary.pop_front();
+        m_scrolling = true;
+        m_plot->setAxisScale(QwtPlot::xBottom, start, start + GRAPH_WINDOW, 10.0f);
+        m_plot->replot();
+        m_zoomer->setZoomBase(false);
+        m_scrolling = false;
+    }
+    else if (m_viewLatest < m_viewEnd)
+    {
+        // only redraw when the new samples can land inside the view, not
+        // while the operator is looking at older data
+        updateView(m_viewStart, m_viewEnd);
+        m_plot->replot();
     }
+}
+
+// -----------------------------------------------------------------------------
+double LineGraph::latest() const
+{
+    return m_view.empty() ? 0.0 : m_view.time(m_view.end() - 1);
+}
+
+// -----------------------------------------------------------------------------
+void LineGraph::setFollowing(bool follow)
+{
+    m_follow = follow;
+    m_dirty = true;
+    redraw();
+}
+
+// -----------------------------------------------------------------------------
+void LineGraph::updateView(double start, double end)
+{
+    int columns = std::max(m_plot->canvas()->width(), 1);
+    for (int c = 0; c < 2; ++c)
+        m_history[c].decimate(m_view, start, end, columns, m_viewX[c], m_viewY[c]);
 
-    m_polyPrimary.push_back(QPointF(m_time, value));
-    m_curvePrimary->setData(m_polyPrimary);
+    m_viewStart = start;
+    m_viewEnd = end;
+    m_viewLatest = latest();
+    m_viewColumns = columns;
+}
+
+// -----------------------------------------------------------------------------
+void LineGraph::onScaleChanged()
+{
+    const QwtScaleDiv *div = m_plot->axisScaleDiv(QwtPlot::xBottom);
+    double start = div->lowerBound(), end = div->upperBound();
 
-    m_polySecondary.push_back(QPointF(m_time, secondValue));
-    m_curveSecondary->setData(m_polySecondary);
+    // zooming, panning or the wheel moved the axis away from the live window
+    double live = std::max(0.0, latest() - GRAPH_WINDOW);
+    if (!m_scrolling && (start != live || end != live + GRAPH_WINDOW))
+        m_follow = false;
+
+    // called from inside replot() before the canvas is drawn, so the view
+    // only has to be brought up to date, not redrawn
+    if (start != m_viewStart || end != m_viewEnd ||
+        m_viewColumns != m_plot->canvas()->width())
+    {
+        updateView(start, end);
+    }
+}
+
+// -----------------------------------------------------------------------------
+void LineGraph::onZoomed(const QwtDoubleRect &rect)
+{
+    (void)rect;
 
-    m_plot->replot();
+    // backing all the way out of the zoom stack goes back to live data
+    if (0 == m_zoomer->zoomRectIndex())
+        setFollowing(true);
 }
 
 // -----------------------------------------------------------------------------
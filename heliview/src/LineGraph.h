@@ -9,9 +9,20 @@
 #ifndef _HELIVIEW_LINEGRAPH__H_
 #define _HELIVIEW_LINEGRAPH__H_
 
+#include <vector>
 #include <QWidget>
+#include <qwt_data.h>
+#include <qwt_double_rect.h>
 #include <qwt_plot.h>
 #include <qwt_plot_curve.h>
+#include <qwt_plot_magnifier.h>
+#include <qwt_plot_panner.h>
+#include <qwt_plot_zoomer.h>
+#include "TelemetryStore.h"
+
+#define GRAPH_WINDOW        60.0    // seconds on screen while following live
+#define GRAPH_REFRESH_MS    33      // replots are batched to this interval
+#define GRAPH_LOD_BITS      3       // each level sums up 8 of the one below
 
 enum GraphType
 {
@@ -27,6 +38,63 @@ enum GraphType
     AXIS_COUNT
 };
 
+// a min/max pyramid over one channel of the telemetry store, scaled and
+// offset for display. level n summarises 8^n samples per bucket, level 0 is
+// the store itself, so any time range can be drawn from whichever level has
+// about one bucket per pixel column. the store may drop old samples, the
+// coarser levels (and the first level's bucket times) are kept for good.
+struct GraphHistory
+{
+    GraphHistory();
+
+    void setSource(int channel, float scale, float offset);
+
+    // fold in whatever the view holds that hasn't been seen, true if any
+    bool sync(const TelemetryView &view);
+    size_t size() const { return m_count; }
+
+    // index of the first sample at or after t
+    size_t lowerBound(const TelemetryView &view, double t) const;
+
+    // the samples in [t0, t1] as about two points per column, replacing the
+    // contents of x and y
+    void decimate(const TelemetryView &view, double t0, double t1, int columns,
+            std::vector<double> &x, std::vector<double> &y) const;
+
+protected:
+    void clear();
+    void addLevel();
+
+    float bucketMin(const TelemetryView &view, size_t level, size_t bucket) const;
+    float bucketMax(const TelemetryView &view, size_t level, size_t bucket) const;
+    double bucketTime(const TelemetryView &view, size_t level, size_t bucket) const;
+
+    std::vector<double> m_time;                 // first sample of each level 1 bucket
+    std::vector<std::vector<float> > m_min;     // [level - 1][bucket]
+    std::vector<std::vector<float> > m_max;
+    int    m_channel;                           // TelemetryChannel
+    float  m_scale, m_offset;
+    size_t m_count;                             // samples folded in so far
+    int    m_generation;                        // of the store they came from
+};
+
+// qwt's view of a decimated channel. copies share the points, so handing one
+// to a curve costs nothing and the curve always sees the latest view.
+class GraphData : public QwtData
+{
+public:
+    GraphData(const std::vector<double> *x, const std::vector<double> *y);
+
+    virtual QwtData *copy() const;
+    virtual size_t size() const;
+    virtual double x(size_t i) const;
+    virtual double y(size_t i) const;
+
+protected:
+    const std::vector<double> *m_x;
+    const std::vector<double> *m_y;
+};
+
 class LineGraph : public QObject
 {
     Q_OBJECT
@@ -38,23 +106,47 @@ public:
 
     QwtPlot *getPlot() const;
     bool isVisible() const;
-    void addDataPoint(float t, float value, float secondValue);
+
+    // which store channel each curve (0 primary, 1 secondary) shows, as
+    // value * scale + offset
+    void setSource(int curve, int channel, float scale = 1.0f, float offset = 0.0f);
+
+    // catch up with the store, replot if anything changed and it can be seen
+    void refresh(const TelemetryView &view);
+
+    // scroll along with new data (true) or stay where the operator put it
+    void setFollowing(bool follow);
+    bool isFollowing() const { return m_follow; }
 
     void togglePrimaryData(bool flag);
     void toggleSecondaryData(bool flag);
     void toggleTertiaryData(bool flag);
 
+protected slots:
+    void onScaleChanged();
+    void onZoomed(const QwtDoubleRect &rect);
+
 protected:
     void toggleGeneric(QwtPlotCurve *curve, bool *oldflag, bool newflag);
+    void redraw();
+    void updateView(double start, double end);
+    double latest() const;
 
 protected:
     QwtPlot *m_plot;
     QwtPlotCurve *m_curvePrimary, *m_curveSecondary, *m_curveTertiary;
-    QPolygonF m_polyPrimary, m_polySecondary, m_polyTertiary;
+    QwtPlotZoomer *m_zoomer;
+    QwtPlotPanner *m_panner;
+    QwtPlotMagnifier *m_magnifier;
+    GraphHistory m_history[2];
+    TelemetryView m_view;           // as of the last refresh
+    std::vector<double> m_viewX[2], m_viewY[2];
+    double m_viewStart, m_viewEnd;  // what the view was decimated for
+    double m_viewLatest;            // newest sample it saw
+    int m_viewColumns;
     bool m_primary, m_secondary, m_tertiary;
+    bool m_dirty, m_follow, m_scrolling;
     int m_numVisible;
-    float m_time;
-    int m_ticker;
 };
 
 #endif // _HELIVIEW_LINEGRAPH__H_
@@ -6,21 +6,45 @@
 // Linux implementation of the Gamepad interface.
 // -----------------------------------------------------------------------------
 
-#include <QDebug>
 #include <QMetaType>
+#include <sys/eventfd.h>
 #include <sys/ioctl.h>
-#include <linux/joystick.h>
+#include <errno.h>
 #include <fcntl.h>
-#include <cassert>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
 #include "LinuxGamepad.h"
 #include "Logger.h"
 #include "Utility.h"
 
 using namespace std;
 
+#define BITS_PER_LONG   (8 * sizeof(unsigned long))
+#define NBITS(x)        ((((x) - 1) / BITS_PER_LONG) + 1)
+
+// -----------------------------------------------------------------------------
+static bool TestBit(const unsigned long *bits, int bit)
+{
+    return 0 != ((bits[bit / BITS_PER_LONG] >> (bit % BITS_PER_LONG)) & 1);
+}
+
+// -----------------------------------------------------------------------------
+static uint64_t EventMicros(const struct input_event &e)
+{
+    // newer headers hide the timeval behind these on 32-bit time64 builds
+#ifdef input_event_sec
+    return (uint64_t)e.input_event_sec * 1000000 + e.input_event_usec;
+#else
+    return (uint64_t)e.time.tv_sec * 1000000 + e.time.tv_usec;
+#endif
+}
+
 // -----------------------------------------------------------------------------
 LinuxGamepad::LinuxGamepad()
-: m_thread(NULL), m_device(""), m_fd(-1), m_axes(0), m_buttons(0), m_version(0)
+: m_thread(NULL), m_device(""), m_fd(-1), m_axes(0), m_buttons(0), m_version(0),
+  m_evdev(false), m_dropped(0)
 {
 }
 
@@ -33,30 +57,144 @@ LinuxGamepad::~LinuxGamepad()
 // -----------------------------------------------------------------------------
 bool LinuxGamepad::open(const QString &device)
 {
-    char driver_name[MAX_NAME_LEN];
+    close();
 
     m_device = device;
     if (0 == m_device.length())
     {
-        // set to a reasonable default
+        // the first event node that looks like a pad, else the old default
+        for (int i = 0; i < GAMEPAD_MAX_DEVICES; ++i)
+        {
+            QString path = QString("/dev/input/event%1").arg(i);
+            if (openEvdev(path, true))
+            {
+                m_device = path;
+                return true;
+            }
+        }
         m_device = QString("/dev/input/js0");
     }
 
-    const char *sdev = m_device.toStdString().c_str();
-    m_fd = ::open(sdev, O_RDONLY);
-    if (m_fd < 0)
+    if (m_device.contains("/js"))
+        return openJoydev(m_device);
+    return openEvdev(m_device, false);
+}
+
+// -----------------------------------------------------------------------------
+bool LinuxGamepad::openEvdev(const QString &device, bool quiet)
+{
+    QByteArray path = device.toLocal8Bit();
+    int fd = ::open(path.constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0)
     {
-        qDebug() << "failed to open device" << sdev;
+        if (!quiet)
+        {
+            Logger::err(tr("LinuxGamepad: failed to open %1: %2\n")
+                    .arg(device).arg(strerror(errno)));
+        }
         return false;
     }
 
+    unsigned long absbits[NBITS(ABS_CNT)];
+    unsigned long keybits[NBITS(KEY_CNT)];
+    memset(absbits, 0, sizeof(absbits));
+    memset(keybits, 0, sizeof(keybits));
+    ioctl(fd, EVIOCGBIT(EV_ABS, sizeof(absbits)), absbits);
+    ioctl(fd, EVIOCGBIT(EV_KEY, sizeof(keybits)), keybits);
+
+    // a pad has a stick and joystick or gamepad buttons, keyboards, mice and
+    // touchpads don't
+    bool pad = false;
+    for (int code = BTN_JOYSTICK; !pad && code < BTN_DIGI; ++code)
+        pad = TestBit(keybits, code);
+    if (!pad || !TestBit(absbits, ABS_X))
+    {
+        if (!quiet)
+            Logger::err(tr("LinuxGamepad: %1 is not a gamepad\n").arg(device));
+        ::close(fd);
+        return false;
+    }
+
+    // number axes and buttons the way joydev does: axes in code order, then
+    // buttons from BTN_JOYSTICK up followed by the misc buttons below it
+    m_axes = 0;
+    m_buttons = 0;
+    for (int code = 0; code < ABS_CNT; ++code)
+    {
+        m_layout.axis[code] = -1;
+        if (!TestBit(absbits, code))
+            continue;
+
+        int index = m_axes++;
+        m_layout.axis[code] = index;
+        if (index >= GP_MAX_AXES)
+            continue;
+
+        struct input_absinfo abs;
+        memset(&abs, 0, sizeof(abs));
+        ioctl(fd, EVIOCGABS(code), &abs);
+
+        float half = (abs.maximum - abs.minimum) / 2.0f - abs.flat;
+        m_layout.center[index] = (abs.maximum + abs.minimum) / 2.0f;
+        m_layout.scale[index] = (half > 0.0f) ? 1.0f / half : 0.0f;
+        m_layout.flat[index] = abs.flat;
+    }
+
+    for (int code = 0; code < KEY_CNT; ++code)
+        m_layout.button[code] = -1;
+    for (int code = BTN_JOYSTICK; code < KEY_CNT; ++code)
+    {
+        if (TestBit(keybits, code))
+            m_layout.button[code] = m_buttons++;
+    }
+    for (int code = BTN_MISC; code < BTN_JOYSTICK; ++code)
+    {
+        if (TestBit(keybits, code))
+            m_layout.button[code] = m_buttons++;
+    }
+
+    // stamp events on the clock the rest of the latency figures use
+    int clock = CLOCK_MONOTONIC;
+    m_layout.monotonic = (ioctl(fd, EVIOCSCLOCKID, &clock) >= 0);
+    if (!m_layout.monotonic)
+        Logger::warn("LinuxGamepad: no monotonic event times, using read times\n");
+
+    char driver_name[MAX_NAME_LEN];
+    memset(driver_name, 0, sizeof(driver_name));
+    ioctl(fd, EVIOCGNAME(MAX_NAME_LEN - 1), driver_name);
+    ioctl(fd, EVIOCGVERSION, &m_version);
+
+    m_name = QString(driver_name);
+    m_fd = fd;
+    m_evdev = true;
+    return true;
+}
 
-    ioctl(m_fd, JSIOCGAXES, &m_axes);
-    ioctl(m_fd, JSIOCGBUTTONS, &m_buttons);
+// -----------------------------------------------------------------------------
+bool LinuxGamepad::openJoydev(const QString &device)
+{
+    char driver_name[MAX_NAME_LEN];
+    unsigned char axes = 0, buttons = 0;
+
+    QByteArray path = device.toLocal8Bit();
+    m_fd = ::open(path.constData(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    if (m_fd < 0)
+    {
+        Logger::err(tr("LinuxGamepad: failed to open %1: %2\n")
+                .arg(device).arg(strerror(errno)));
+        return false;
+    }
+
+    memset(driver_name, 0, sizeof(driver_name));
+    ioctl(m_fd, JSIOCGAXES, &axes);
+    ioctl(m_fd, JSIOCGBUTTONS, &buttons);
     ioctl(m_fd, JSIOCGVERSION, &m_version);
-    ioctl(m_fd, JSIOCGNAME(MAX_NAME_LEN), &driver_name);
+    ioctl(m_fd, JSIOCGNAME(MAX_NAME_LEN - 1), driver_name);
 
+    m_axes = axes;
+    m_buttons = buttons;
     m_name = QString(driver_name);
+    m_evdev = false;
     return true;
 }
 
@@ -65,7 +203,7 @@ void LinuxGamepad::close()
 {
     if (m_fd >= 0)
     {
-        // terminate the polling thread and close the js* file handle
+        // terminate the polling thread and close the device file handle
         stop();
         ::close(m_fd);
         m_fd = -1;
@@ -75,12 +213,13 @@ void LinuxGamepad::close()
 // -----------------------------------------------------------------------------
 void LinuxGamepad::start()
 {
-    if (!m_thread)
+    if (!m_thread && (m_fd >= 0))
     {
         // kick off the device io thread
-        m_thread = new LinuxGamepadThread(m_fd);
-        connect(m_thread, SIGNAL(inputReady(GamepadEvent, int, float)),
-                this, SIGNAL(inputReady(GamepadEvent, int, float)));
+        m_delivered = GamepadState();
+        m_dropped = 0;
+        m_thread = new LinuxGamepadThread(m_fd, m_evdev ? &m_layout : NULL);
+        connect(m_thread, SIGNAL(framesReady()), this, SLOT(onFramesReady()));
         m_thread->start();
     }
 }
@@ -97,76 +236,305 @@ void LinuxGamepad::stop()
 }
 
 // -----------------------------------------------------------------------------
-LinuxGamepadThread::LinuxGamepadThread(int fd)
-: m_fd(fd), m_active(true)
+bool LinuxGamepad::snapshot(GamepadState &state) const
+{
+    return m_thread && m_thread->snapshot(state);
+}
+
+// -----------------------------------------------------------------------------
+void LinuxGamepad::onFramesReady()
+{
+    if (!m_thread)
+        return;
+
+    // cleared before draining, anything queued after this raises it again
+    m_thread->acknowledge();
+
+    GamepadState state;
+    bool moved[GP_MAX_AXES];
+    memset(moved, 0, sizeof(moved));
+
+    while (m_thread->pop(state))
+    {
+        // every press and release is reported, in the order they happened
+        uint32_t changed = state.buttons ^ m_delivered.buttons;
+        for (int i = 0; changed && (i < GP_MAX_BUTTONS); ++i)
+        {
+            uint32_t bit = 1u << i;
+            if (!(changed & bit))
+                continue;
+
+            changed &= ~bit;
+            m_delivered.buttons ^= bit;
+            emit inputReady(GP_EVENT_BUTTON, i,
+                    (state.buttons & bit) ? 1.0f : -1.0f);
+        }
+
+        // a stick only needs its latest position
+        for (int i = 0; i < GP_MAX_AXES; ++i)
+        {
+            if (state.axes[i] != m_delivered.axes[i])
+            {
+                m_delivered.axes[i] = state.axes[i];
+                moved[i] = true;
+            }
+        }
+
+        m_delivered.timestamp = state.timestamp;
+        m_delivered.received = state.received;
+        m_delivered.sequence = state.sequence;
+    }
+
+    for (int i = 0; i < GP_MAX_AXES; ++i)
+    {
+        if (moved[i])
+            emit inputReady(GP_EVENT_AXIS, i, m_delivered.axes[i]);
+    }
+
+    int dropped = m_thread->dropped();
+    if (dropped != m_dropped)
+    {
+        Logger::warn(tr("LinuxGamepad: %1 input frames dropped, the GUI fell "
+                    "behind\n").arg(dropped - m_dropped));
+        m_dropped = dropped;
+    }
+}
+
+// -----------------------------------------------------------------------------
+LinuxGamepadThread::LinuxGamepadThread(int fd, const EvdevLayout *layout)
+: m_fd(fd), m_stop_fd(-1), m_layout(layout), m_dropping(false),
+  m_frames(GAMEPAD_QUEUE_DEPTH), m_notifyPending(0), m_dropped(0), m_active(1)
 {
+    m_stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_stop_fd < 0)
+    {
+        Logger::warn(tr("LinuxGamepad: eventfd failed, stopping will take up "
+                    "to %1 ms: %2\n").arg(GAMEPAD_POLL_MS).arg(strerror(errno)));
+    }
 }
 
 // -----------------------------------------------------------------------------
 LinuxGamepadThread::~LinuxGamepadThread()
 {
-    m_active = false;
+    if (m_stop_fd >= 0)
+        ::close(m_stop_fd);
 }
 
 // -----------------------------------------------------------------------------
 void LinuxGamepadThread::run()
 {
-    struct js_event event;
-    struct timeval tv;
-    fd_set rdset;
+    struct input_event events[GAMEPAD_READ_EVENTS];
+    struct pollfd pfd[2];
+    pfd[0].fd = m_fd;
+    pfd[0].events = POLLIN;
+    pfd[1].fd = m_stop_fd;
+    pfd[1].events = POLLIN;
+    int timeout = (m_stop_fd >= 0) ? -1 : GAMEPAD_POLL_MS;
 
-    for (;;)
+    // evdev only reports changes, so begin from where everything is now
+    if (m_layout)
+        resync(MonotonicMicros());
+
+    while (m_active.fetchAndAddAcquire(0))
     {
-        // wait until joydev data is available
-        for (;;)
+        int rc = poll(pfd, 2, timeout);
+        if (rc < 0 && EINTR != errno)
         {
-            // kill the thread if requested
-            if (!m_active)
-                return;
-
-            FD_ZERO(&rdset);
-            FD_SET(m_fd, &rdset);
-            tv.tv_sec = 1;
-            tv.tv_usec = 0;
-
-            int rc = select(m_fd + 1, &rdset, NULL, NULL, &tv);
-            if (rc < 0)
-                Logger::err("select call failed in LinuxGamepadThread\n");
-            else if (rc > 0)
-                break;
+            Logger::err(tr("LinuxGamepad: poll failed: %1\n").arg(strerror(errno)));
+            break;
         }
-
-        // attempt to read the joydev data
-        if (read(m_fd, &event, sizeof(struct js_event)) != sizeof(event)) {
-            Logger::err("failed to read from joystick\n");
+        else if (rc <= 0)
+        {
             continue;
         }
 
-        GamepadEvent gpe;
-        float val;
+        if (pfd[1].revents & POLLIN)
+            break;
 
-        switch (event.type)
+        if (pfd[0].revents & (POLLERR | POLLHUP | POLLNVAL))
         {
-            case JS_EVENT_BUTTON:
-                gpe = GP_EVENT_BUTTON;
-                val = (event.value == 0) ? -1.0f : 1.0f;
-                break;
-            case JS_EVENT_AXIS:
-                gpe = GP_EVENT_AXIS;
-                val = (float)event.value / ANALOG_RANGE;
-                break;
-            default:
-                continue;
+            Logger::err("LinuxGamepad: lost the gamepad\n");
+            break;
         }
 
-        emit inputReady(gpe, event.number, val);
+        // take everything the driver has queued in one read
+        ssize_t length = read(m_fd, events, sizeof(events));
+        uint64_t now = MonotonicMicros();
+        if (length < 0 && EAGAIN != errno && EINTR != errno)
+        {
+            Logger::err(tr("LinuxGamepad: read failed: %1\n").arg(strerror(errno)));
+            break;
+        }
+        else if (length > 0 && m_layout)
+        {
+            decodeEvdev(events, length / sizeof(struct input_event), now);
+        }
+        else if (length > 0)
+        {
+            decodeJoydev((const struct js_event *)events,
+                    length / sizeof(struct js_event), now);
+        }
     }
 }
 
 // -----------------------------------------------------------------------------
 void LinuxGamepadThread::stop()
 {
-    m_active = false;
+    m_active.fetchAndStoreRelease(0);
+    if (m_stop_fd >= 0)
+    {
+        uint64_t one = 1;
+        if (write(m_stop_fd, &one, sizeof(one)) != sizeof(one))
+            Logger::err("LinuxGamepad: failed to wake the input thread\n");
+    }
+}
+
+// -----------------------------------------------------------------------------
+void LinuxGamepadThread::decodeEvdev(const struct input_event *events,
+        int count, uint64_t now)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const struct input_event &e = events[i];
+
+        if (EV_SYN == e.type)
+        {
+            if (SYN_DROPPED == e.code)
+            {
+                // the kernel's buffer overflowed, what follows up to the next
+                // report is incomplete and the state has to be read back
+                m_dropping = true;
+            }
+            else if (SYN_REPORT == e.code && m_dropping)
+            {
+                m_dropping = false;
+                resync(now);
+            }
+            else if (SYN_REPORT == e.code)
+            {
+                m_state.timestamp = m_layout->monotonic ? EventMicros(e) : now;
+                m_state.received = now;
+                publish();
+            }
+            continue;
+        }
+
+        if (m_dropping)
+            continue;
+
+        if (EV_ABS == e.type && e.code < ABS_CNT)
+        {
+            int index = m_layout->axis[e.code];
+            if (index >= 0 && index < GP_MAX_AXES)
+                m_state.axes[index] = normalize(index, e.value);
+        }
+        else if (EV_KEY == e.type && e.code < KEY_CNT && e.value < 2)
+        {
+            // value 2 is autorepeat, the button is still just held
+            int index = m_layout->button[e.code];
+            if (index >= 0 && index < GP_MAX_BUTTONS)
+            {
+                if (e.value)
+                    m_state.buttons |= (1u << index);
+                else
+                    m_state.buttons &= ~(1u << index);
+            }
+        }
+    }
+}
+
+// -----------------------------------------------------------------------------
+void LinuxGamepadThread::decodeJoydev(const struct js_event *events,
+        int count, uint64_t now)
+{
+    for (int i = 0; i < count; ++i)
+    {
+        const struct js_event &e = events[i];
+
+        switch (e.type & ~JS_EVENT_INIT)
+        {
+        case JS_EVENT_BUTTON:
+            if (e.number < GP_MAX_BUTTONS && e.value)
+                m_state.buttons |= (1u << e.number);
+            else if (e.number < GP_MAX_BUTTONS)
+                m_state.buttons &= ~(1u << e.number);
+            break;
+        case JS_EVENT_AXIS:
+            if (e.number < GP_MAX_AXES)
+                m_state.axes[e.number] = (float)e.value / ANALOG_RANGE;
+            break;
+        default:
+            break;
+        }
+    }
+
+    // joydev marks no frames and its times are on a clock of its own, a read
+    // is the nearest thing to either
+    m_state.timestamp = now;
+    m_state.received = now;
+    publish();
+}
+
+// -----------------------------------------------------------------------------
+void LinuxGamepadThread::resync(uint64_t now)
+{
+    for (int code = 0; code < ABS_CNT; ++code)
+    {
+        int index = m_layout->axis[code];
+        if (index < 0 || index >= GP_MAX_AXES)
+            continue;
+
+        struct input_absinfo abs;
+        if (ioctl(m_fd, EVIOCGABS(code), &abs) >= 0)
+            m_state.axes[index] = normalize(index, abs.value);
+    }
+
+    unsigned long keys[NBITS(KEY_CNT)];
+    memset(keys, 0, sizeof(keys));
+    if (ioctl(m_fd, EVIOCGKEY(sizeof(keys)), keys) >= 0)
+    {
+        m_state.buttons = 0;
+        for (int code = 0; code < KEY_CNT; ++code)
+        {
+            int index = m_layout->button[code];
+            if (index >= 0 && index < GP_MAX_BUTTONS && TestBit(keys, code))
+                m_state.buttons |= (1u << index);
+        }
+    }
+
+    m_state.timestamp = now;
+    m_state.received = now;
+    publish();
+}
+
+// -----------------------------------------------------------------------------
+void LinuxGamepadThread::publish()
+{
+    m_state.sequence++;
+    m_latest.store(m_state);
+
+    // one notification covers everything queued until the GUI gets to it
+    if (!m_frames.push(m_state))
+        m_dropped.ref();
+    else if (m_notifyPending.testAndSetOrdered(0, 1))
+        emit framesReady();
+}
+
+// -----------------------------------------------------------------------------
+float LinuxGamepadThread::normalize(int index, int value) const
+{
+    // same shape as joydev's correction: flat inside the dead zone, then
+    // scaled so the rest of the travel still reaches -1.0 and 1.0
+    float offset = value - m_layout->center[index];
+    if (offset > m_layout->flat[index])
+        offset -= m_layout->flat[index];
+    else if (offset < -m_layout->flat[index])
+        offset += m_layout->flat[index];
+    else
+        return 0.0f;
+
+    float scaled = offset * m_layout->scale[index];
+    return (scaled > 1.0f) ? 1.0f : ((scaled < -1.0f) ? -1.0f : scaled);
 }
 
 // -----------------------------------------------------------------------------
@@ -175,4 +543,3 @@ Gamepad *CreateGamepad(void)
     qRegisterMetaType<GamepadEvent>("GamepadEvent");
     return new LinuxGamepad();
 }
-
@@ -3,36 +3,84 @@
 // Authors: Garrett Smith
 // Created: 09-17-2010
 //
-// Linux implementation of the Gamepad interface.
+// Linux implementation of the Gamepad interface. Reads the evdev device
+// (/dev/input/event*) or, for a js* path, the older joydev one. The reader
+// thread folds everything up to each SYN_REPORT into one GamepadState and
+// publishes it without locking, the GUI thread turns the states it collects
+// into inputReady() calls.
 // -----------------------------------------------------------------------------
 
 #ifndef _HELIVIEW_LINUXGAMEPAD__H_
 #define _HELIVIEW_LINUXGAMEPAD__H_
 
-#include <QWidget>
+#include <linux/input.h>
+#include <linux/joystick.h>
+#include <QAtomicInt>
 #include <QThread>
+#include <QWidget>
 #include "Gamepad.h"
-
-#define ANALOG_RANGE    ((1 << 15) - 1)
-#define MAX_NAME_LEN    128
+#include "SeqLock.h"
+#include "SpscQueue.h"
+
+#define ANALOG_RANGE        ((1 << 15) - 1)
+#define MAX_NAME_LEN        128
+#define GAMEPAD_READ_EVENTS 64      // evdev events taken per read
+#define GAMEPAD_QUEUE_DEPTH 256     // frames waiting on the GUI
+#define GAMEPAD_MAX_DEVICES 32      // event nodes searched for a pad
+#define GAMEPAD_POLL_MS     100     // stop check, only if there is no eventfd
+
+// evdev codes to the indices joydev would have given them, so button and axis
+// bindings are the same whichever node the pad was opened through
+struct EvdevLayout
+{
+    int16_t axis[ABS_CNT];          // -1 if the pad doesn't report it
+    int16_t button[KEY_CNT];
+    bool    monotonic;              // event times are MonotonicMicros
+    float   center[GP_MAX_AXES];
+    float   scale[GP_MAX_AXES];     // to -1.0 .. 1.0 about center
+    int     flat[GP_MAX_AXES];      // dead zone either side of center
+};
 
 class LinuxGamepadThread: public QThread
 {
     Q_OBJECT
 
 public:
-    LinuxGamepadThread(int fd);
+    LinuxGamepadThread(int fd, const EvdevLayout *layout);
     virtual ~LinuxGamepadThread();
 
     virtual void run();
     virtual void stop();
 
+    // consumer side, GUI thread only
+    bool pop(GamepadState &state) { return m_frames.pop(state); }
+    void acknowledge() { m_notifyPending.fetchAndStoreOrdered(0); }
+
+    // any thread
+    bool snapshot(GamepadState &state) const { return m_latest.load(state); }
+    int dropped() const
+    { return const_cast<QAtomicInt &>(m_dropped).fetchAndAddAcquire(0); }
+
 signals:
-    void inputReady(GamepadEvent event, int index, float value);
+    void framesReady();
 
 protected:
-    int m_fd;
-    bool m_active;
+    void decodeEvdev(const struct input_event *events, int count, uint64_t now);
+    void decodeJoydev(const struct js_event *events, int count, uint64_t now);
+    void resync(uint64_t now);
+    void publish();
+    float normalize(int index, int value) const;
+
+    int                       m_fd;
+    int                       m_stop_fd;    // eventfd, written to stop
+    const EvdevLayout        *m_layout;     // NULL for joydev
+    bool                      m_dropping;   // SYN_DROPPED, skip to next report
+    GamepadState              m_state;      // the frame being built
+    SeqLock<GamepadState>     m_latest;
+    SpscQueue<GamepadState>   m_frames;
+    QAtomicInt                m_notifyPending;
+    QAtomicInt                m_dropped;    // frames lost to a full queue
+    QAtomicInt                m_active;
 };
 
 class LinuxGamepad: public Gamepad
@@ -54,7 +102,15 @@ public:
     virtual int driverVersion() { return m_version; }
     virtual const QString &driverName() { return m_name; }
 
+    virtual bool snapshot(GamepadState &state) const;
+
+public slots:
+    void onFramesReady();
+
 protected:
+    bool openEvdev(const QString &device, bool quiet);
+    bool openJoydev(const QString &device);
+
     LinuxGamepadThread *m_thread;
     QString m_device;
     int m_fd;
@@ -62,7 +118,10 @@ protected:
     int m_buttons;
     int m_version;
     QString m_name;
+    bool m_evdev;
+    EvdevLayout m_layout;
+    GamepadState m_delivered;   // what inputReady() has reported so far
+    int m_dropped;
 };
 
 #endif // _HELIVIEW_LINUXGAMEPAD__H_
-
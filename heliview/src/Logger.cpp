@@ -6,9 +6,30 @@
 // Singleton Logger class used to log messages during runtime.
 // -----------------------------------------------------------------------------
 
+#include <algorithm>
+#include <iostream>
+#include <QMutexLocker>
 #include "Logger.h"
 #include "Utility.h"
 
+QAtomicInt Logger::s_types(0);
+
+// -----------------------------------------------------------------------------
+QString LogArg::apply(const QString &format) const
+{
+    switch (m_kind)
+    {
+    case ARG_INT:
+        return format.arg(m_int);
+    case ARG_DOUBLE:
+        return format.arg(m_double);
+    case ARG_STRING:
+        return format.arg(m_string);
+    default:
+        return format;
+    }
+}
+
 // -----------------------------------------------------------------------------
 Logger *Logger::instance()
 {
@@ -16,50 +37,380 @@ Logger *Logger::instance()
     return &logger;
 }
 
+// -----------------------------------------------------------------------------
+Logger::Logger()
+: m_dropped(0), m_reported(0), m_thread(NULL),
+  m_fileBufsize(LOG_FILE_BUFFER)
+{
+    m_thread = new LoggerThread(this);
+    m_thread->start();
+}
+
+// -----------------------------------------------------------------------------
+Logger::~Logger()
+{
+    // anything logged from here on is left to the thread's final drain
+    LoggerThread *thread = m_thread;
+    m_thread = NULL;
+    thread->stop();
+    thread->wait();
+    SafeDelete(thread);
+    closeFile();
+
+    // rings of threads still running (this one included) are left alone,
+    // their handles may yet touch them on the way out
+    QMutexLocker locker(&m_ringLock);
+    for (size_t i = 0; i < m_rings.size(); ++i)
+    {
+        if (m_rings[i]->orphaned.fetchAndAddAcquire(0))
+            SafeDelete(m_rings[i]);
+    }
+}
+
+// -----------------------------------------------------------------------------
+void Logger::setTypes(int types)
+{
+    s_types.fetchAndStoreRelease(types);
+}
+
+// -----------------------------------------------------------------------------
+const char *Logger::prefix(int type)
+{
+    switch (type)
+    {
+    case LOG_TYPE_FAIL:
+        return "failure: ";
+    case LOG_TYPE_ERR:
+        return "error: ";
+    case LOG_TYPE_WARN:
+        return "warning: ";
+    case LOG_TYPE_DBG:
+    case LOG_TYPE_EXTRADEBUG:
+        return "debug: ";
+    default:
+        // info, telemetry, or a type made of several flags
+        return "";
+    }
+}
+
+// -----------------------------------------------------------------------------
+int Logger::dropped() const
+{
+    return const_cast<QAtomicInt &>(m_dropped).fetchAndAddAcquire(0);
+}
+
+// -----------------------------------------------------------------------------
+bool Logger::openFile(const QString &path)
+{
+    QMutexLocker locker(&m_fileLock);
+    if (m_file.isOpen())
+    {
+        writeFile();
+        m_file.close();
+    }
+
+    m_fileBuffer.clear();
+    m_file.setFileName(path);
+    return m_file.open(QIODevice::WriteOnly | QIODevice::Text);
+}
+
+// -----------------------------------------------------------------------------
+void Logger::closeFile()
+{
+    QMutexLocker locker(&m_fileLock);
+    if (m_file.isOpen())
+    {
+        writeFile();
+        m_file.close();
+    }
+}
+
+// -----------------------------------------------------------------------------
+void Logger::flushFile()
+{
+    QMutexLocker locker(&m_fileLock);
+    writeFile();
+}
+
+// -----------------------------------------------------------------------------
+QString Logger::fileName() const
+{
+    QMutexLocker locker(&m_fileLock);
+    return m_file.isOpen() ? m_file.fileName() : QString();
+}
+
+// -----------------------------------------------------------------------------
+void Logger::setFileBuffer(int bufsize)
+{
+    QMutexLocker locker(&m_fileLock);
+    m_fileBufsize = bufsize;
+}
+
+// -----------------------------------------------------------------------------
+int Logger::fileBuffer() const
+{
+    QMutexLocker locker(&m_fileLock);
+    return m_fileBufsize;
+}
+
+// -----------------------------------------------------------------------------
+// with m_fileLock held
+void Logger::writeFile()
+{
+    if (m_file.isOpen() && !m_fileBuffer.isEmpty())
+    {
+        m_file.write(m_fileBuffer);
+        m_file.flush();
+    }
+    m_fileBuffer.clear();
+}
+
 // -----------------------------------------------------------------------------
 void Logger::log(int type, const QString &msg)
 {
-    emit Logger::instance()->updateLog(type, msg);
+    if (!enabled(type))
+        return;
+
+    LogRecord record;
+    record.type = type;
+    record.format = NULL;
+    record.text = msg;
+    Logger::instance()->push(record);
+}
+
+// -----------------------------------------------------------------------------
+void Logger::log(int type, const char *format, const LogArg &a1,
+        const LogArg &a2, const LogArg &a3)
+{
+    if (!enabled(type))
+        return;
+
+    LogRecord record;
+    record.type = type;
+    record.format = format;
+    record.args[0] = a1;
+    record.args[1] = a2;
+    record.args[2] = a3;
+    Logger::instance()->push(record);
 }
 
 // -----------------------------------------------------------------------------
 void Logger::warn(const QString &msg)
 {
-    emit Logger::instance()->updateLog(LOG_TYPE_WARN, msg);
+    log(LOG_TYPE_WARN, msg);
+}
+
+// -----------------------------------------------------------------------------
+void Logger::warn(const char *format, const LogArg &a1, const LogArg &a2,
+        const LogArg &a3)
+{
+    log(LOG_TYPE_WARN, format, a1, a2, a3);
 }
 
 // -----------------------------------------------------------------------------
 void Logger::err(const QString &msg)
 {
-    emit Logger::instance()->updateLog(LOG_TYPE_ERR, msg);
+    log(LOG_TYPE_ERR, msg);
+}
+
+// -----------------------------------------------------------------------------
+void Logger::err(const char *format, const LogArg &a1, const LogArg &a2,
+        const LogArg &a3)
+{
+    log(LOG_TYPE_ERR, format, a1, a2, a3);
 }
 
 // -----------------------------------------------------------------------------
 void Logger::info(const QString &msg)
 {
-    emit Logger::instance()->updateLog(LOG_TYPE_INFO, msg);
+    log(LOG_TYPE_INFO, msg);
+}
+
+// -----------------------------------------------------------------------------
+void Logger::info(const char *format, const LogArg &a1, const LogArg &a2,
+        const LogArg &a3)
+{
+    log(LOG_TYPE_INFO, format, a1, a2, a3);
 }
 
 // -----------------------------------------------------------------------------
 void Logger::dbg(const QString &msg)
 {
-    emit Logger::instance()->updateLog(LOG_TYPE_DBG, msg);
+    log(LOG_TYPE_DBG, msg);
+}
+
+// -----------------------------------------------------------------------------
+void Logger::dbg(const char *format, const LogArg &a1, const LogArg &a2,
+        const LogArg &a3)
+{
+    log(LOG_TYPE_DBG, format, a1, a2, a3);
 }
 
 // -----------------------------------------------------------------------------
 void Logger::extraDebug(const QString &msg)
 {
-    emit Logger::instance()->updateLog(LOG_TYPE_EXTRADEBUG, msg);
+    log(LOG_TYPE_EXTRADEBUG, msg);
+}
+
+// -----------------------------------------------------------------------------
+void Logger::extraDebug(const char *format, const LogArg &a1, const LogArg &a2,
+        const LogArg &a3)
+{
+    log(LOG_TYPE_EXTRADEBUG, format, a1, a2, a3);
 }
 
 // -----------------------------------------------------------------------------
 void Logger::fail(const QString &msg)
 {
-    emit Logger::instance()->updateLog(LOG_TYPE_FAIL, msg);
+    log(LOG_TYPE_FAIL, msg);
+}
+
+// -----------------------------------------------------------------------------
+void Logger::fail(const char *format, const LogArg &a1, const LogArg &a2,
+        const LogArg &a3)
+{
+    log(LOG_TYPE_FAIL, format, a1, a2, a3);
 }
 
 // -----------------------------------------------------------------------------
 void Logger::telemetry(const QString &msg)
 {
-    emit Logger::instance()->updateLog(LOG_TYPE_TELEMETRY, msg);
+    log(LOG_TYPE_TELEMETRY, msg);
+}
+
+// -----------------------------------------------------------------------------
+void Logger::push(const LogRecord &record)
+{
+    // a thread's first message registers its ring, after that no locks
+    if (!m_local.hasLocalData())
+    {
+        LogRing *ring = new LogRing;
+        {
+            QMutexLocker locker(&m_ringLock);
+            m_rings.push_back(ring);
+        }
+        m_local.setLocalData(new LogRingHandle(ring));
+    }
+
+    // never block the caller, a full ring means the logger can't keep up
+    if (!m_local.localData()->ring->queue.push(record))
+        m_dropped.fetchAndAddRelaxed(1);
+
+    // gone once the logger itself is being destroyed
+    if (m_thread)
+        m_thread->wake();
+}
+
+// -----------------------------------------------------------------------------
+bool Logger::drain()
+{
+    // the list only changes when a thread logs for the first time or a ring
+    // is retired, so a copy of it is taken and the lock let go
+    std::vector<LogRing *> rings;
+    {
+        QMutexLocker locker(&m_ringLock);
+        rings = m_rings;
+    }
+
+    bool delivered = false;
+    for (size_t i = 0; i < rings.size(); ++i)
+    {
+        // checked first, anything pushed before the thread exited is then
+        // guaranteed to be drained below
+        bool orphaned = 0 != rings[i]->orphaned.fetchAndAddAcquire(0);
+
+        LogRecord record;
+        while (rings[i]->queue.pop(record))
+        {
+            deliver(record);
+            delivered = true;
+        }
+
+        if (orphaned)
+        {
+            QMutexLocker locker(&m_ringLock);
+            m_rings.erase(std::find(m_rings.begin(), m_rings.end(), rings[i]));
+            SafeDelete(rings[i]);
+        }
+    }
+
+    int dropped = this->dropped();
+    if (dropped != m_reported)
+    {
+        LogRecord record;
+        record.type = LOG_TYPE_WARN;
+        record.format = NULL;
+        record.text = tr("Logger: %1 messages dropped\n").arg(dropped - m_reported);
+        m_reported = dropped;
+        deliver(record);
+    }
+    return delivered;
+}
+
+// -----------------------------------------------------------------------------
+void Logger::deliver(const LogRecord &record)
+{
+    QString text = record.text;
+    if (record.format)
+    {
+        text = QString::fromLatin1(record.format);
+        for (int i = 0; i < LOG_MAX_ARGS && !record.args[i].isNull(); ++i)
+            text = record.args[i].apply(text);
+    }
+
+    QString line = QString::fromLatin1(prefix(record.type)) + text;
+
+    // debug output is only enabled in the debug modes, which echo it
+    if (record.type & (LOG_TYPE_DBG | LOG_TYPE_EXTRADEBUG))
+        std::cerr << line.toAscii().constData() << std::endl;
+
+    // telemetry goes to the console but not the file
+    if (LOG_TYPE_TELEMETRY != record.type)
+    {
+        QMutexLocker locker(&m_fileLock);
+        if (m_file.isOpen())
+        {
+            m_fileBuffer.append(line.toAscii());
+            if (m_fileBuffer.size() >= m_fileBufsize)
+                writeFile();
+        }
+    }
+
+    emit updateLog(record.type, line);
+}
+
+// -----------------------------------------------------------------------------
+LoggerThread::LoggerThread(Logger *logger)
+: m_logger(logger), m_active(1), m_wakePending(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+void LoggerThread::wake()
+{
+    if (m_wakePending.testAndSetOrdered(0, 1))
+        m_wake.release();
+}
+
+// -----------------------------------------------------------------------------
+void LoggerThread::run()
+{
+    while (m_active.fetchAndAddAcquire(0))
+    {
+        // sleep until something is logged. re-armed before draining so a
+        // message pushed during the drain posts again rather than waiting
+        m_wake.acquire();
+        m_wakePending.fetchAndStoreOrdered(0);
+        m_logger->drain();
+    }
+
+    // whatever was logged on the way out
+    m_logger->drain();
+}
+
+// -----------------------------------------------------------------------------
+void LoggerThread::stop()
+{
+    m_active.fetchAndStoreRelease(0);
+    m_wake.release();
 }
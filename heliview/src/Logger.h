@@ -3,13 +3,26 @@
 // Authors: Kevin Macksamie, Garrett Smith
 // Created: 10-25-2010
 //
-// Singleton Logger class used to log messages during runtime.
+// Singleton Logger class used to log messages during runtime. Messages whose
+// type isn't being logged are dropped before anything is built. The rest go
+// into a lock-free ring owned by the calling thread, and a background thread
+// formats them, writes them to the log file and hands them to the GUI.
 // -----------------------------------------------------------------------------
 
 #ifndef _HELIVIEW_LOGGER__H_
 #define _HELIVIEW_LOGGER__H_
 
-#include <QWidget>
+#include <vector>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QObject>
+#include <QSemaphore>
+#include <QString>
+#include <QThread>
+#include <QThreadStorage>
+#include "SpscQueue.h"
 
 // logging modes
 #define LOG_MODE_EXCESSIVE      2  // logs normal and debug plus excessive
@@ -25,17 +38,81 @@
 #define LOG_TYPE_TELEMETRY  0x0040
 #define LOG_TYPE_EXTRADEBUG 0x0020
 
+#define LOG_RING_DEPTH      1024    // messages one thread may have in flight
+#define LOG_MAX_ARGS        3
+#define LOG_FILE_BUFFER     1024    // bytes gathered before a file write
+
+// an argument of a deferred message, substituted for %n by the logger thread
+class LogArg
+{
+public:
+    LogArg() : m_kind(ARG_NONE), m_int(0), m_double(0.0) { }
+    LogArg(int value) : m_kind(ARG_INT), m_int(value), m_double(0.0) { }
+    LogArg(unsigned value) : m_kind(ARG_INT), m_int(value), m_double(0.0) { }
+    LogArg(long value) : m_kind(ARG_INT), m_int(value), m_double(0.0) { }
+    LogArg(unsigned long value) : m_kind(ARG_INT), m_int(value), m_double(0.0) { }
+    LogArg(qlonglong value) : m_kind(ARG_INT), m_int(value), m_double(0.0) { }
+    LogArg(double value) : m_kind(ARG_DOUBLE), m_int(0), m_double(value) { }
+    LogArg(const QString &value)
+    : m_kind(ARG_STRING), m_int(0), m_double(0.0), m_string(value) { }
+    LogArg(const char *value)
+    : m_kind(ARG_STRING), m_int(0), m_double(0.0), m_string(value) { }
+
+    bool isNull() const { return ARG_NONE == m_kind; }
+    QString apply(const QString &format) const;
+
+protected:
+    enum { ARG_NONE, ARG_INT, ARG_DOUBLE, ARG_STRING } m_kind;
+    qlonglong m_int;
+    double    m_double;
+    QString   m_string;
+};
+
+// one message on its way to the logger thread. either text is complete or
+// format (a string literal) still has args to be substituted
+struct LogRecord
+{
+    int         type;
+    const char *format;
+    QString     text;
+    LogArg      args[LOG_MAX_ARGS];
+};
+
+// a thread's ring. the thread's handle marks it orphaned when the thread
+// exits, the logger thread frees it once it has been drained
+struct LogRing
+{
+    LogRing() : queue(LOG_RING_DEPTH), orphaned(0) { }
+
+    SpscQueue<LogRecord> queue;
+    QAtomicInt           orphaned;
+};
+
+struct LogRingHandle
+{
+    LogRingHandle(LogRing *r) : ring(r) { }
+    ~LogRingHandle() { ring->orphaned.fetchAndStoreRelease(1); }
+
+    LogRing *ring;
+};
+
+class LoggerThread;
+
 class Logger : public QObject
 {
     Q_OBJECT
 
 private:
-    Logger() {};
-    ~Logger() {};
+    Logger();
+    ~Logger();
 
 public:
     static Logger *instance();
 
+    // which LOG_TYPE_* bits are logged, nothing until logging is enabled
+    static bool enabled(int type) { return 0 != (type & (int)s_types); }
+    static void setTypes(int types);
+
     static void log(int type, const QString &msg);
     static void warn(const QString &msg);
     static void err(const QString &msg);
@@ -45,8 +122,82 @@ public:
     static void fail(const QString &msg);
     static void telemetry(const QString &msg);
 
+    // deferred formatting, format must outlive the call (a literal). a bare
+    // literal comes here too, so the caller never builds a QString for it
+    static void log(int type, const char *format, const LogArg &a1 = LogArg(),
+            const LogArg &a2 = LogArg(), const LogArg &a3 = LogArg());
+    static void warn(const char *format, const LogArg &a1 = LogArg(),
+            const LogArg &a2 = LogArg(), const LogArg &a3 = LogArg());
+    static void err(const char *format, const LogArg &a1 = LogArg(),
+            const LogArg &a2 = LogArg(), const LogArg &a3 = LogArg());
+    static void info(const char *format, const LogArg &a1 = LogArg(),
+            const LogArg &a2 = LogArg(), const LogArg &a3 = LogArg());
+    static void dbg(const char *format, const LogArg &a1 = LogArg(),
+            const LogArg &a2 = LogArg(), const LogArg &a3 = LogArg());
+    static void extraDebug(const char *format, const LogArg &a1 = LogArg(),
+            const LogArg &a2 = LogArg(), const LogArg &a3 = LogArg());
+    static void fail(const char *format, const LogArg &a1 = LogArg(),
+            const LogArg &a2 = LogArg(), const LogArg &a3 = LogArg());
+
+    // what goes in front of a message of this type ("error: ", ...)
+    static const char *prefix(int type);
+
+    int dropped() const;
+
+    // the text log. everything but telemetry goes in, written by the logger
+    // thread once bufsize bytes have gathered. flushFile() writes out what
+    // has gathered so far and may be called from any thread
+    bool openFile(const QString &path);
+    void closeFile();
+    void flushFile();
+    QString fileName() const;
+    void setFileBuffer(int bufsize);
+    int fileBuffer() const;
+
 signals:
+    // emitted from the logger thread, formatted and prefixed
     void updateLog(int type, const QString &msg);
+
+protected:
+    friend class LoggerThread;
+
+    void push(const LogRecord &record);
+    bool drain();
+    void deliver(const LogRecord &record);
+    void writeFile();
+
+    static QAtomicInt              s_types;
+
+    QThreadStorage<LogRingHandle *> m_local;    // this thread's ring
+    QMutex                         m_ringLock;  // guards the list, not the rings
+    std::vector<LogRing *>         m_rings;
+    QAtomicInt                     m_dropped;   // lost to a full ring
+    int                            m_reported;  // drops already warned about
+    LoggerThread                  *m_thread;
+    mutable QMutex                 m_fileLock;  // the file and its buffer
+    QFile                          m_file;
+    QByteArray                     m_fileBuffer;
+    int                            m_fileBufsize;
+};
+
+// -----------------------------------------------------------------------------
+// Drains every thread's ring, formats and delivers the messages.
+class LoggerThread: public QThread
+{
+public:
+    LoggerThread(Logger *logger);
+
+    virtual void run();
+    virtual void stop();
+
+    // called after every push, only the first since the last drain posts
+    void wake();
+
+protected:
+    Logger     *m_logger;
+    QAtomicInt  m_active;
+    QAtomicInt  m_wakePending;
+    QSemaphore  m_wake;
 };
 
 #endif
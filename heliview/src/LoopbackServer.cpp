@@ -0,0 +1,350 @@
+// -----------------------------------------------------------------------------
+// File:    LoopbackServer.cpp
+// Created: 10-17-2026
+//
+// In-process stand-in for the vehicle's network server. Speaks enough of the
+// protocol (ident, telemetry, frames, subscriptions, mode changes, the video
+// socket and pings) to drive the network device without hardware.
+// -----------------------------------------------------------------------------
+
+#include <QFile>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include "Logger.h"
+#include "LoopbackServer.h"
+#include "uav_protocol_ext.h"
+
+// -----------------------------------------------------------------------------
+LoopbackServer::LoopbackServer(uint32_t caps)
+: m_server(NULL), m_video_server(NULL), m_client(NULL), m_video_client(NULL),
+  m_telem_timer(NULL), m_mjpeg_timer(NULL),
+  m_caps(caps), m_mode(VCM_TYPE_AUTO)
+{
+}
+
+// -----------------------------------------------------------------------------
+LoopbackServer::~LoopbackServer()
+{
+}
+
+// -----------------------------------------------------------------------------
+int LoopbackServer::listen(int port)
+{
+    // everything is created here so that it belongs to the server's thread
+    m_server = new QTcpServer(this);
+    connect(m_server, SIGNAL(newConnection()), this, SLOT(onNewConnection()));
+
+    m_video_server = new QTcpServer(this);
+    connect(m_video_server, SIGNAL(newConnection()), this,
+            SLOT(onNewVideoConnection()));
+
+    m_telem_timer = new QTimer(this);
+    connect(m_telem_timer, SIGNAL(timeout()), this, SLOT(onTelemetryTick()));
+
+    m_mjpeg_timer = new QTimer(this);
+    connect(m_mjpeg_timer, SIGNAL(timeout()), this, SLOT(onVideoTick()));
+
+    // every frame we serve is the test pattern
+    QFile file(":/data/test_pattern.jpg");
+    if (file.open(QIODevice::ReadOnly))
+        m_frame = file.readAll();
+
+    m_clock.start();
+
+    if (!m_server->listen(QHostAddress::LocalHost, port))
+    {
+        Logger::err(tr("Loopback: failed to listen on port %1\n").arg(port));
+        return -1;
+    }
+
+    // the video socket is optional, so failing to get one isn't fatal
+    if ((m_caps & IDENT_CAP_VIDEO_PORT) &&
+        !m_video_server->listen(QHostAddress::LocalHost, 0))
+    {
+        Logger::warn("Loopback: failed to open video port\n");
+        m_caps &= ~IDENT_CAP_VIDEO_PORT;
+    }
+
+    Logger::info(tr("Loopback: listening on port %1\n")
+            .arg(m_server->serverPort()));
+    return m_server->serverPort();
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::shutdown()
+{
+    SafeDelete(m_telem_timer);
+    SafeDelete(m_mjpeg_timer);
+    if (m_client)
+        m_client->disconnect(this);
+    SafeDelete(m_client);
+    if (m_video_client)
+        m_video_client->disconnect(this);
+    SafeDelete(m_video_client);
+    SafeDelete(m_video_server);
+    SafeDelete(m_server);
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::onNewConnection()
+{
+    QTcpSocket *sock = m_server->nextPendingConnection();
+    if (m_client)
+    {
+        // a single vehicle only ever talks to a single ground station
+        sock->close();
+        sock->deleteLater();
+        return;
+    }
+
+    m_client = sock;
+    m_buffer.clear();
+    connect(m_client, SIGNAL(readyRead()), this, SLOT(onClientReadyRead()));
+    connect(m_client, SIGNAL(disconnected()), this, SLOT(onClientDisconnected()));
+
+    // open the session the same way the vehicle does
+    uint32_t cmd_buffer[16];
+    cmd_buffer[PKT_COMMAND]     = SERVER_REQ_IDENT;
+    cmd_buffer[PKT_LENGTH]      = PKT_RCI_LENGTH;
+    cmd_buffer[PKT_RCI_MAGIC]   = IDENT_MAGIC;
+    cmd_buffer[PKT_RCI_VERSION] = IDENT_VERSION | m_caps;
+    sendPacket(m_client, cmd_buffer, PKT_RCI_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::onNewVideoConnection()
+{
+    QTcpSocket *sock = m_video_server->nextPendingConnection();
+    if (m_video_client || !m_client)
+    {
+        // video only makes sense alongside a control connection
+        sock->close();
+        sock->deleteLater();
+        return;
+    }
+
+    m_video_client = sock;
+    m_video_buffer.clear();
+    connect(m_video_client, SIGNAL(readyRead()), this, SLOT(onClientReadyRead()));
+    connect(m_video_client, SIGNAL(disconnected()), this,
+            SLOT(onVideoClientDisconnected()));
+    Logger::info("Loopback: video client attached\n");
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::onClientDisconnected()
+{
+    m_telem_timer->stop();
+    m_mjpeg_timer->stop();
+    m_client->deleteLater();
+    m_client = NULL;
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::onVideoClientDisconnected()
+{
+    // frames fall back onto the control socket
+    m_video_client->deleteLater();
+    m_video_client = NULL;
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::onClientReadyRead()
+{
+    QTcpSocket *sock = qobject_cast<QTcpSocket *>(sender());
+    if (!sock)
+        return;
+
+    QByteArray &buffer = (sock == m_video_client) ? m_video_buffer : m_buffer;
+    buffer.append(sock->readAll());
+
+    // consume every complete packet we have
+    int offset = 0;
+    while (buffer.size() - offset >= (int)PKT_BASE_LENGTH)
+    {
+        const uint32_t *packet = (const uint32_t *)(buffer.constData() + offset);
+        uint32_t length = packet[PKT_LENGTH];
+        if (length < PKT_BASE_LENGTH)
+        {
+            Logger::err("Loopback: malformed packet, dropping client\n");
+            sock->disconnectFromHost();
+            return;
+        }
+
+        if ((uint32_t)(buffer.size() - offset) < length)
+            break;
+
+        processPacket(sock, packet);
+        offset += length;
+    }
+    buffer.remove(0, offset);
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::processPacket(QTcpSocket *sock, const uint32_t *packet)
+{
+    uint32_t cmd_buffer[16];
+
+    // requests are answered on the socket they arrived on
+    switch (packet[PKT_COMMAND])
+    {
+    case CLIENT_ACK_IDENT:
+        Logger::info("Loopback: client identified\n");
+        break;
+    case CLIENT_REQ_TELEMETRY:
+        sendTelemetry(sock);
+        break;
+    case CLIENT_REQ_MJPG_FRAME:
+        sendFrame(sock);
+        break;
+    case CLIENT_REQ_VIDEO_PORT:
+        cmd_buffer[PKT_COMMAND]    = SERVER_ACK_VIDEO_PORT;
+        cmd_buffer[PKT_LENGTH]     = PKT_VPORT_LENGTH;
+        cmd_buffer[PKT_VPORT_PORT] = (m_caps & IDENT_CAP_VIDEO_PORT) ?
+            m_video_server->serverPort() : 0;
+        sendPacket(sock, cmd_buffer, PKT_VPORT_LENGTH);
+        break;
+    case CLIENT_REQ_PING:
+        // echoed back whole, so it has to be all there
+        if (packet[PKT_LENGTH] < PKT_PING_LENGTH)
+        {
+            Logger::warn("Loopback: short ping, ignored\n");
+            break;
+        }
+        memcpy(cmd_buffer, packet, PKT_PING_LENGTH);
+        cmd_buffer[PKT_COMMAND] = SERVER_ACK_PING;
+        sendPacket(sock, cmd_buffer, PKT_PING_LENGTH);
+        break;
+    case CLIENT_REQ_SUBSCRIBE:
+        if (packet[PKT_LENGTH] < PKT_SUB_LENGTH)
+        {
+            Logger::warn("Loopback: short subscribe, ignored\n");
+            break;
+        }
+        subscribe(packet[PKT_SUB_CHANNEL], packet[PKT_SUB_RATE]);
+        break;
+    case CLIENT_REQ_SET_CTL_MODE:
+        if (packet[PKT_LENGTH] < PKT_VCM_LENGTH)
+        {
+            Logger::warn("Loopback: short control mode request, ignored\n");
+            break;
+        }
+
+        // accept whatever is asked for and echo the new mode back
+        m_mode = packet[PKT_VCM_TYPE];
+        cmd_buffer[PKT_COMMAND]  = SERVER_UPDATE_CTL_MODE;
+        cmd_buffer[PKT_LENGTH]   = PKT_VCM_LENGTH;
+        cmd_buffer[PKT_VCM_TYPE] = m_mode;
+        cmd_buffer[PKT_VCM_AXES] = packet[PKT_VCM_AXES];
+        sendPacket(sock, cmd_buffer, PKT_VCM_LENGTH);
+        break;
+    case CLIENT_REQ_TCE:
+    case CLIENT_REQ_CTE:
+        if (packet[PKT_LENGTH] < PKT_TE_LENGTH)
+        {
+            Logger::warn("Loopback: short tracking request, ignored\n");
+            break;
+        }
+        cmd_buffer[PKT_COMMAND] = (packet[PKT_COMMAND] == CLIENT_REQ_TCE) ?
+            SERVER_ACK_TCE : SERVER_ACK_CTE;
+        cmd_buffer[PKT_LENGTH]    = PKT_TE_LENGTH;
+        cmd_buffer[PKT_TE_STATUS] = (packet[PKT_TE_STATUS] == 2) ?
+            0 : packet[PKT_TE_STATUS];
+        sendPacket(sock, cmd_buffer, PKT_TE_LENGTH);
+        break;
+    case CLIENT_REQ_FLIGHT_CTL:
+        // nothing to fly, silently accept
+        break;
+    default:
+        cmd_buffer[PKT_COMMAND] = SERVER_ACK_IGNORED;
+        cmd_buffer[PKT_LENGTH]  = PKT_BASE_LENGTH;
+        sendPacket(sock, cmd_buffer, PKT_BASE_LENGTH);
+        break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::subscribe(uint32_t channel, uint32_t rate)
+{
+    QTimer *timer;
+    switch (channel)
+    {
+    case SUB_CHANNEL_TELEMETRY: timer = m_telem_timer; break;
+    case SUB_CHANNEL_MJPG:      timer = m_mjpeg_timer; break;
+    default:
+        Logger::warn(tr("Loopback: unknown subscription channel %1\n")
+                .arg(channel));
+        return;
+    }
+
+    if (0 == rate)
+    {
+        timer->stop();
+        Logger::info(tr("Loopback: channel %1 unsubscribed\n").arg(channel));
+    }
+    else
+    {
+        timer->start(std::max(1, (int)(1000 / rate)));
+        Logger::info(tr("Loopback: channel %1 subscribed at %2 Hz\n")
+                .arg(channel).arg(rate));
+    }
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::sendPacket(QTcpSocket *sock, const uint32_t *buffer,
+        int length)
+{
+    if (sock && QAbstractSocket::ConnectedState == sock->state())
+        sock->write((const char *)buffer, length);
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::onTelemetryTick()
+{
+    sendTelemetry(m_client);
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::onVideoTick()
+{
+    // pushed frames prefer the video socket when the client has one open
+    sendFrame(m_video_client ? m_video_client : m_client);
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::sendTelemetry(QTcpSocket *sock)
+{
+    // same motion as the simulated device, reported the way the vehicle
+    // reports it (yaw and pitch are negated again by the client)
+    float t = m_clock.elapsed() / 1000.0f;
+    float yaw   = -fmodf(t * 12.5f, 360.0f);
+    float pitch = -7.0f * sinf(t);
+    float roll  = 5.0f * sinf(t * 2.0f);
+    float alt   = 21.0f + 21.0f * sinf(t);
+
+    uint32_t cmd_buffer[32];
+    memset(cmd_buffer, 0, sizeof(cmd_buffer));
+    cmd_buffer[PKT_COMMAND] = SERVER_ACK_TELEMETRY;
+    cmd_buffer[PKT_LENGTH]  = PKT_VTI_LENGTH;
+    memcpy(&cmd_buffer[PKT_VTI_YAW],   &yaw,   4);
+    memcpy(&cmd_buffer[PKT_VTI_PITCH], &pitch, 4);
+    memcpy(&cmd_buffer[PKT_VTI_ROLL],  &roll,  4);
+    memcpy(&cmd_buffer[PKT_VTI_ALT],   &alt,   4);
+    cmd_buffer[PKT_VTI_RSSI] = 200;
+    cmd_buffer[PKT_VTI_BATT] = 100;
+    cmd_buffer[PKT_VTI_AUX]  = 1500;
+    cmd_buffer[PKT_VTI_CPU]  = 25;
+    sendPacket(sock, cmd_buffer, PKT_VTI_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+void LoopbackServer::sendFrame(QTcpSocket *sock)
+{
+    QByteArray packet(PKT_MJPG_LENGTH + m_frame.size(), 0);
+    uint32_t *words = (uint32_t *)packet.data();
+    words[PKT_COMMAND] = SERVER_ACK_MJPG_FRAME;
+    words[PKT_LENGTH]  = packet.size();
+    memcpy(&words[PKT_MJPG_IMG], m_frame.constData(), m_frame.size());
+    sendPacket(sock, words, packet.size());
+}
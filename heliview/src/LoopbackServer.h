@@ -0,0 +1,62 @@
+// -----------------------------------------------------------------------------
+// File:    LoopbackServer.h
+// Created: 10-17-2026
+//
+// In-process stand-in for the vehicle's network server. Speaks enough of the
+// protocol (ident, telemetry, frames, subscriptions, mode changes, the video
+// socket and pings) to drive the network device without hardware.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_LOOPBACKSERVER__H_
+#define _HELIVIEW_LOOPBACKSERVER__H_
+
+#include <QByteArray>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTime>
+#include <QTimer>
+#include "Utility.h"
+
+class LoopbackServer: public QObject
+{
+    Q_OBJECT
+
+public:
+    LoopbackServer(uint32_t caps);
+    virtual ~LoopbackServer();
+
+public slots:
+    int listen(int port);
+    void shutdown();
+
+protected slots:
+    void onNewConnection();
+    void onNewVideoConnection();
+    void onClientReadyRead();
+    void onClientDisconnected();
+    void onVideoClientDisconnected();
+    void onTelemetryTick();
+    void onVideoTick();
+
+protected:
+    void processPacket(QTcpSocket *sock, const uint32_t *packet);
+    void sendPacket(QTcpSocket *sock, const uint32_t *buffer, int length);
+    void sendFrame(QTcpSocket *sock);
+    void sendTelemetry(QTcpSocket *sock);
+    void subscribe(uint32_t channel, uint32_t rate);
+
+    QTcpServer *m_server;
+    QTcpServer *m_video_server;
+    QTcpSocket *m_client;
+    QTcpSocket *m_video_client;
+    QTimer     *m_telem_timer;
+    QTimer     *m_mjpeg_timer;
+    QByteArray  m_frame;
+    QByteArray  m_buffer;
+    QByteArray  m_video_buffer;
+    QTime       m_clock;
+    uint32_t    m_caps;
+    uint32_t    m_mode;
+};
+
+#endif // _HELIVIEW_LOOPBACKSERVER__H_
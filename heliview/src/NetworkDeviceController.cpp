@@ -9,16 +9,21 @@
 #include "Logger.h"
 #include "NetworkDeviceController.h"
 #include "Utility.h"
-#include "uav_protocol.h"
+#include "uav_protocol_ext.h"
 
 const char *NetworkDeviceController::m_description = "Network description";
 const bool NetworkDeviceController::m_takesDevice = true;
 
 // -----------------------------------------------------------------------------
 NetworkDeviceController::NetworkDeviceController(const QString &device)
-: m_device(device), m_telem_timer(NULL), m_mjpeg_timer(NULL), m_blocksz(0),
-  m_state(STATE_AUTONOMOUS), m_track(QColor(159, 39, 100), 10, 20, 10, 5, 1), 
-  m_track_en(false)
+: m_device(device), m_port(0), m_link(LINK_CLOSED), m_connect_timer(NULL),
+  m_reconnect_timer(NULL), m_backoff(NETDEV_BACKOFF_MIN), m_attempts(0),
+  m_lost_at(0), m_resume_state(STATE_AUTONOMOUS), m_resume_axes(AXIS_ALL),
+  m_video_timer(NULL), m_video_gen(0),
+  m_io(NULL), m_thread(NULL), m_video_io(NULL),
+  m_video_thread(NULL), m_server(NULL), m_server_thread(NULL), m_peer_caps(0),
+  m_telem_rate(15), m_video_rate(15), m_subscribed(false),
+  m_stats_timer(NULL), m_stats_ticks(0)
 {
 }
 
@@ -35,11 +40,42 @@ bool NetworkDeviceController::open()
     QString address("192.168.1.100");
     int portnum = 8090;
 
-    // was an address specified?
-    if (m_device.length())
+    // split off any trailing options (addr:port,option,option=value,...)
+    m_options.clear();
+    QString target = ParseDeviceOptions(m_device, m_options);
+
+    // telemetry and video rates in Hz, whether polled or pushed
+    if (m_options.contains("telem"))
+        m_telem_rate = qBound(1, m_options.value("telem").toInt(), 1000);
+    if (m_options.contains("video"))
+        m_video_rate = qBound(1, m_options.value("video").toInt(), 120);
+
+    if (target == "loopback")
+    {
+        // stand up an in-process vehicle on its own thread and talk to it
+        uint32_t caps = IDENT_CAP_VIDEO_PORT | IDENT_CAP_PING;
+        if (!m_options.contains("nosub"))
+            caps |= IDENT_CAP_SUBSCRIBE;
+        m_server = new LoopbackServer(caps);
+        m_server_thread = new QThread();
+        m_server->moveToThread(m_server_thread);
+        m_server_thread->start();
+
+        portnum = -1;
+        QMetaObject::invokeMethod(m_server, "listen",
+                Qt::BlockingQueuedConnection,
+                Q_RETURN_ARG(int, portnum), Q_ARG(int, 0));
+        if (portnum < 0)
+        {
+            Logger::err("NetworkDevice: failed to start loopback server\n");
+            return false;
+        }
+        address = "127.0.0.1";
+    }
+    else if (target.length())
     {
-        // if so, split it into ip address and port number
-        QStringList ssplit = m_device.split(":", QString::SkipEmptyParts);
+        // otherwise split it into ip address and port number
+        QStringList ssplit = target.split(":", QString::SkipEmptyParts);
         if (ssplit.size() != 2)
         {
             Logger::err("NetworkDevice: invalid address format (addr:port)\n");
@@ -52,526 +88,617 @@ bool NetworkDeviceController::open()
     Logger::info(tr("NetworkDevice: creating network device %1 port %2\n")
             .arg(address).arg(portnum));
 
-    // attempt to create and connect to the network socket
-    m_sock = new QTcpSocket();
-    connect(m_sock, SIGNAL(readyRead()), this, SLOT(onSocketReadyRead()));
-    connect(m_sock, SIGNAL(disconnected()), this, SLOT(onSocketDisconnected()));
-    connect(m_sock, SIGNAL(error(QAbstractSocket::SocketError)), this,
+    // the socket worker either shares our (GUI) thread or gets its own
+    m_address = address;
+    m_port = portnum;
+    m_io = createIO(m_thread);
+    connect(m_io, SIGNAL(socketConnected()), this, SLOT(onSocketConnected()));
+    connect(m_io, SIGNAL(socketDisconnected()), this, SLOT(onSocketDisconnected()));
+    connect(m_io, SIGNAL(socketError(QAbstractSocket::SocketError)), this,
             SLOT(onSocketError(QAbstractSocket::SocketError)));
 
-    // attempt to connect to the specified address:port
-    m_sock->connectToHost(address, portnum);
-    if (!m_sock->waitForConnected(3000)) {
-        emit connectionStatusChanged(QString("Connection failed"), false);
-        Logger::warn("NetworkDevice: connection timed out\n");
-        return false;
-    }
-
-    emit connectionStatusChanged(QString("Connected to ") + m_device, true);
-    Logger::info(tr("NetworkDevice: connected to ") + m_device + "\n");
-
-    emit flightStateChanged(FCS_STATE_GROUNDED);
-
+    // nothing below blocks, the link comes up (and keeps coming back up)
+    // through the connection state machine
     startup();
+    connectLink();
     return true;
 }
 
 // -----------------------------------------------------------------------------
 void NetworkDeviceController::startup()
 {
-    m_telem_timer = new QTimer(this);
-    connect(m_telem_timer, SIGNAL(timeout()), this, SLOT(onTelemetryTick()));
+    startControl(m_options);
+
+    m_stats_timer = new QTimer(this);
+    connect(m_stats_timer, SIGNAL(timeout()), this, SLOT(onStatsTick()));
 
-    m_mjpeg_timer = new QTimer(this);
-    connect(m_mjpeg_timer, SIGNAL(timeout()), this, SLOT(onVideoTick()));
+    m_connect_timer = new QTimer(this);
+    m_connect_timer->setSingleShot(true);
+    connect(m_connect_timer, SIGNAL(timeout()), this, SLOT(onConnectTimeout()));
 
-    m_controller_timer = new QTimer(this);
-    connect(m_controller_timer, SIGNAL(timeout()), this, 
-            SLOT(onControllerTick()));
+    m_reconnect_timer = new QTimer(this);
+    m_reconnect_timer->setSingleShot(true);
+    connect(m_reconnect_timer, SIGNAL(timeout()), this, SLOT(onReconnectTick()));
 
-    m_throttle_timer = new QTimer(this);
-    connect(m_throttle_timer, SIGNAL(timeout()), this, SLOT(onThrottleTick()));
+    m_video_timer = new QTimer(this);
+    m_video_timer->setSingleShot(true);
+    connect(m_video_timer, SIGNAL(timeout()), this, SLOT(onVideoTimeout()));
 
-    m_ctl.alt = 0.0f;
-    m_ctl.pitch = 0.0f;
-    m_ctl.roll = 0.0f;
-    m_ctl.yaw = 0.0f;
+    m_backoff = NETDEV_BACKOFF_MIN;
+    m_attempts = 0;
+    m_lost_at = 0;
+    m_stats_ticks = 0;
+    for (int i = 0; i < CHANNEL_COUNT; ++i)
+    {
+        m_last_stats[i] = NetworkIOStats();
+        m_rtt[i].reset();
+    }
 }
 
 // -----------------------------------------------------------------------------
 void NetworkDeviceController::close()
 {
-    if (m_sock)
+    // anything still queued by the old link is now meaningless
+    LinkState link = m_link;
+    m_link = LINK_CLOSED;
+
+    // the control thread sends through m_io, it goes first
+    stopControl();
+
+    if (m_io)
     {
-        // disconnect the socket, wait for completion
+        // tell the vehicle to stop pushing before we hang up
+        if (LINK_ONLINE == link)
+            stopStreams();
+        logStats(true);
+
+        // disconnect the sockets, wait for completion
         Logger::info("NetworkDevice: disconnecting from host ...\n");
-        m_sock->disconnectFromHost();
-        m_sock->waitForDisconnected(3000);
+        destroyIO(m_video_io, m_video_thread);
+        destroyIO(m_io, m_thread);
         Logger::info("NetworkDevice: disconnected\n");
-        SafeDelete(m_sock);
+    }
+
+    if (m_server)
+    {
+        QMetaObject::invokeMethod(m_server, "shutdown",
+                Qt::BlockingQueuedConnection);
+        m_server_thread->quit();
+        m_server_thread->wait();
+        SafeDelete(m_server_thread);
+        SafeDelete(m_server);
     }
     shutdown();
 }
 
 // -----------------------------------------------------------------------------
-void NetworkDeviceController::shutdown()
+NetworkIO *NetworkDeviceController::createIO(QThread *&thread)
 {
-    if (m_telem_timer)
+    NetworkIO *io = new NetworkIO();
+    io->setControlSink(this);
+    if (m_options.contains("thread"))
     {
-        m_telem_timer->stop();
-        SafeDelete(m_telem_timer);
-
-        m_mjpeg_timer->stop();
-        SafeDelete(m_mjpeg_timer);
-
-        m_controller_timer->stop();
-        SafeDelete(m_controller_timer);
+        Logger::info("NetworkDevice: using dedicated network thread\n");
+        thread = new QThread();
+        io->moveToThread(thread);
+        thread->start();
+    }
+    else
+    {
+        // same thread, so packets can be handled straight out of the framer
+        io->setPacketHandler(this);
     }
 
-    emit connectionStatusChanged(m_device + " disconnected", false);
-    emit controlStateChanged(STATE_DISCONNECTED);
+    connect(io, SIGNAL(packetsReady()), this, SLOT(onPacketsReady()));
+    return io;
 }
 
 // -----------------------------------------------------------------------------
-bool NetworkDeviceController::sendPacket(uint32_t command) const
+void NetworkDeviceController::destroyIO(NetworkIO *&io, QThread *&thread)
 {
-    if (!m_sock || QAbstractSocket::ConnectedState != m_sock->state())
-        return false;
+    if (!io)
+        return;
 
-    QDataStream stream(m_sock);
-    stream.setVersion(QDataStream::Qt_4_0);
-    uint32_t cmd_buffer[] = { command, PKT_BASE_LENGTH };
-    stream.writeRawData((char *)cmd_buffer, PKT_BASE_LENGTH);
-    return m_sock->waitForBytesWritten();
+    QMetaObject::invokeMethod(io, "closeSocket",
+            thread ? Qt::BlockingQueuedConnection : Qt::DirectConnection);
+
+    if (thread)
+    {
+        // the worker is idle now, stop its event loop before deleting it
+        thread->quit();
+        thread->wait();
+        SafeDelete(thread);
+    }
+    SafeDelete(io);
 }
 
 // -----------------------------------------------------------------------------
-bool NetworkDeviceController::sendPacket(uint32_t *buffer, int length) const
+void NetworkDeviceController::connectLink()
 {
-    if (!m_sock || QAbstractSocket::ConnectedState != m_sock->state())
-        return false;
+    m_link = LINK_CONNECTING;
+    ++m_attempts;
+    emit connectionStatusChanged(tr("Connecting to %1 ...").arg(m_device), false);
 
-    QDataStream stream(m_sock);
-    stream.setVersion(QDataStream::Qt_4_0);
-    stream.writeRawData((char *)buffer, length);
-    return m_sock->waitForBytesWritten();
+    // connectToHost() can sit on a dead route for minutes, bound it ourselves
+    m_connect_timer->start(NETDEV_CONNECT_TIMEOUT);
+    QMetaObject::invokeMethod(m_io, "connectSocket", Qt::QueuedConnection,
+            Q_ARG(QString, m_address), Q_ARG(int, m_port));
 }
 
 // -----------------------------------------------------------------------------
-bool NetworkDeviceController::requestDeviceControls() const
+void NetworkDeviceController::onSocketConnected()
 {
-    return sendPacket(CLIENT_REQ_CAM_DCI);
+    if (LINK_CONNECTING != m_link)
+        return;
+
+    // the session only counts as up once the vehicle has identified itself
+    m_link = LINK_HANDSHAKE;
+    m_connect_timer->start(NETDEV_CONNECT_TIMEOUT);
+
+    emit connectionStatusChanged(QString("Connected to ") + m_device, true);
+    Logger::info(tr("NetworkDevice: connected to ") + m_device + "\n");
+    if (0 == m_lost_at)
+        emit flightStateChanged(FCS_STATE_GROUNDED);
 }
 
 // -----------------------------------------------------------------------------
-bool NetworkDeviceController::requestColors() const
-{    
-    return sendPacket(CLIENT_REQ_CAM_COLORS);
+void NetworkDeviceController::onConnectTimeout()
+{
+    if (LINK_CONNECTING == m_link)
+        Logger::warn("NetworkDevice: connection timed out\n");
+    else if (LINK_HANDSHAKE == m_link)
+        Logger::warn("NetworkDevice: vehicle never identified itself\n");
+    else
+        return;
+
+    onLinkLost();
 }
 
 // -----------------------------------------------------------------------------
-bool NetworkDeviceController::requestTrimSettings() const
+void NetworkDeviceController::onLinkLost()
 {
-    return sendPacket(CLIENT_REQ_GTS);
+    // both disconnected() and error() usually arrive for one failure
+    if (LINK_CLOSED == m_link || LINK_BACKOFF == m_link)
+        return;
+
+    if (LINK_ONLINE == m_link)
+    {
+        // remember what the operator had set up so we can put it back
+        m_lost_at = MonotonicMicros();
+        m_resume_state = m_state;
+        m_resume_axes = m_axes;
+        Logger::warn("NetworkDevice: link lost\n");
+    }
+
+    m_link = LINK_BACKOFF;
+    m_connect_timer->stop();
+    enableControl(false);
+    m_stats_timer->stop();
+    m_video_timer->stop();
+
+    // subscriptions and the video socket die with the session
+    m_subscribed = false;
+    ++m_video_gen;
+    destroyIO(m_video_io, m_video_thread);
+    QMetaObject::invokeMethod(m_io, "closeSocket", Qt::QueuedConnection);
+
+    emit controlStateChanged(STATE_DISCONNECTED);
+    emit connectionStatusChanged(tr("%1 lost, retrying in %2 ms")
+            .arg(m_device).arg(m_backoff), false);
+    Logger::info("NetworkDevice: reconnecting in %1 ms (attempt %2)\n",
+            m_backoff, m_attempts + 1);
+
+    m_reconnect_timer->start(m_backoff);
+    m_backoff = qMin(m_backoff * 2, NETDEV_BACKOFF_MAX);
 }
 
 // -----------------------------------------------------------------------------
-bool NetworkDeviceController::requestFilterSettings() const
+void NetworkDeviceController::onReconnectTick()
 {
-    return sendPacket(CLIENT_REQ_GFS);
+    if (LINK_BACKOFF == m_link)
+        connectLink();
 }
 
 // -----------------------------------------------------------------------------
-bool NetworkDeviceController::requestPIDSettings(int axis) const
-{    
-    uint32_t cmd_buffer[PKT_GPIDS_NUM];
-    cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_GPIDS;
-    cmd_buffer[PKT_LENGTH]   = PKT_GPIDS_LENGTH;
-    cmd_buffer[PKT_GPIDS_AXIS] = axis;
-    return sendPacket(cmd_buffer, PKT_GPIDS_LENGTH);
+void NetworkDeviceController::restoreSession()
+{
+    double seconds = (MonotonicMicros() - m_lost_at) / 1e6;
+    Logger::info(tr("NetworkDevice: reconnected after %1 s (%2 attempts), "
+                "restoring session\n").arg(seconds, 0, 'f', 2).arg(m_attempts));
+
+    // tracking target first, so a restored mode acts on the right colour
+    updateTrackSettings(m_track.color.red(), m_track.color.green(),
+            m_track.color.blue(), m_track.ht, m_track.st, m_track.ft,
+            m_track.fps);
+    onUpdateTrackControlEnable(m_tce >= 0 ? m_tce : 2);
+    onUpdateColorTrackEnable(m_cte >= 0 ? m_cte : 2);
+
+    // the vehicle answers with SERVER_UPDATE_CTL_MODE, which puts the control
+    // loop back in mixed mode just as it did the first time around
+    requestControlMode(m_resume_state, m_resume_axes);
+    m_lost_at = 0;
 }
 
 // -----------------------------------------------------------------------------
-bool NetworkDeviceController::requestTakeoff() const
+bool NetworkDeviceController::openVideo(int port)
 {
-    Logger::info("NetworkDevice: Request Takeoff\n");
-    return sendPacket(CLIENT_REQ_TAKEOFF);
+    if (port <= 0)
+        return false;
+
+    // frames get their own socket (and thread) so that a 60 KB frame can
+    // never hold up a mode change or telemetry sample queued behind it
+    ++m_video_gen;
+    m_video_io = createIO(m_video_thread);
+    connect(m_video_io, SIGNAL(socketConnected()), this,
+            SLOT(onVideoConnected()));
+    connect(m_video_io, SIGNAL(socketDisconnected()), this,
+            SLOT(onVideoDisconnected()));
+    connect(m_video_io, SIGNAL(socketError(QAbstractSocket::SocketError)),
+            this, SLOT(onVideoDisconnected()));
+
+    m_video_timer->start(NETDEV_CONNECT_TIMEOUT);
+    QMetaObject::invokeMethod(m_video_io, "connectSocket", Qt::QueuedConnection,
+            Q_ARG(QString, m_address), Q_ARG(int, port));
+    return true;
 }
 
 // -----------------------------------------------------------------------------
-bool NetworkDeviceController::requestLanding() const
+void NetworkDeviceController::onVideoConnected()
 {
-    Logger::info("NetworkDevice: Request Landing\n");
-    return sendPacket(CLIENT_REQ_LANDING);
+    if (sender() != m_video_io)
+        return;
+
+    m_video_timer->stop();
+    Logger::info("NetworkDevice: video connected\n");
+    startStreams();
 }
 
 // -----------------------------------------------------------------------------
-bool NetworkDeviceController::requestManualOverride() const
+void NetworkDeviceController::onVideoTimeout()
 {
-    Logger::info("NetworkDevice: Request Manual Override\n");
-    uint32_t cmd_buffer[PKT_VCM_NUM];
-    cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_SET_CTL_MODE;
-    cmd_buffer[PKT_LENGTH]   = PKT_VCM_LENGTH;
-    cmd_buffer[PKT_VCM_TYPE] = VCM_TYPE_RADIO;
-    cmd_buffer[PKT_VCM_AXES] = VCM_AXIS_ALL;
-    return sendPacket(cmd_buffer, PKT_VCM_LENGTH);
+    if (m_video_io && !m_video_io->isConnected())
+        closeVideo(m_video_gen);
 }
 
 // -----------------------------------------------------------------------------
-bool NetworkDeviceController::requestAutonomous() const
+void NetworkDeviceController::onVideoDisconnected()
 {
-    Logger::info("NetworkDevice: Request Autonomous\n");
-    uint32_t cmd_buffer[PKT_VCM_NUM];
-    cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_SET_CTL_MODE;
-    cmd_buffer[PKT_LENGTH]   = PKT_VCM_LENGTH;
-    cmd_buffer[PKT_VCM_TYPE] = VCM_TYPE_AUTO;
-    cmd_buffer[PKT_VCM_AXES] = VCM_AXIS_ALL;
-    return sendPacket(cmd_buffer, PKT_VCM_LENGTH);
+    // may be called from inside the video worker, tear it down later. the
+    // generation keeps a late call from closing a newer video socket
+    if (sender() == m_video_io)
+    {
+        QMetaObject::invokeMethod(this, "closeVideo", Qt::QueuedConnection,
+                Q_ARG(int, m_video_gen));
+    }
 }
 
 // -----------------------------------------------------------------------------
-bool NetworkDeviceController::requestKillswitch() const
+void NetworkDeviceController::closeVideo(int generation)
 {
-    Logger::info("NetworkDevice: Request Killswitch\n");
-    uint32_t cmd_buffer[PKT_VCM_NUM];
-    cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_SET_CTL_MODE;
-    cmd_buffer[PKT_LENGTH]   = PKT_VCM_LENGTH;
-    cmd_buffer[PKT_VCM_TYPE] = VCM_TYPE_KILL;
-    cmd_buffer[PKT_VCM_AXES] = VCM_AXIS_ALL;
-    return sendPacket(cmd_buffer, PKT_VCM_LENGTH);
+    if (!m_video_io || generation != m_video_gen)
+        return;
+
+    Logger::warn("NetworkDevice: no video connection, sharing the "
+            "control connection\n");
+    m_video_timer->stop();
+    stopStreams();
+    destroyIO(m_video_io, m_video_thread);
+    if (LINK_ONLINE == m_link)
+        startStreams();
 }
 
 // -----------------------------------------------------------------------------
-void NetworkDeviceController::onTelemetryTick()
+void NetworkDeviceController::startStreams()
 {
-    if (!sendPacket(CLIENT_REQ_TELEMETRY))
+    if ((m_peer_caps & IDENT_CAP_SUBSCRIBE) && !m_options.contains("poll"))
+    {
+        // one request each, the vehicle pushes samples until we unsubscribe
+        Logger::info(tr("NetworkDevice: subscribing to telemetry at %1 Hz, "
+                    "video at %2 Hz\n").arg(m_telem_rate).arg(m_video_rate));
+        m_subscribed = subscribe(SUB_CHANNEL_TELEMETRY, m_telem_rate) &&
+                       subscribe(SUB_CHANNEL_MJPG, m_video_rate);
+        if (m_subscribed)
+            return;
+
+        Logger::warn("NetworkDevice: subscription failed, polling instead\n");
+    }
+
+    // older vehicles only answer requests, so keep asking (frame requests
+    // go out on the video socket so the answers come back on it too)
+    Logger::info("NetworkDevice: peer cannot push, polling for samples\n");
+    if (m_video_io)
     {
-        Logger::err("NetworkDevice: failed to send telemetry request\n");
+        QMetaObject::invokeMethod(m_io, "startPolling",
+                Q_ARG(int, 1000 / m_telem_rate), Q_ARG(int, 0));
+        QMetaObject::invokeMethod(m_video_io, "startPolling",
+                Q_ARG(int, 0), Q_ARG(int, 1000 / m_video_rate));
+    }
+    else
+    {
+        QMetaObject::invokeMethod(m_io, "startPolling",
+                Q_ARG(int, 1000 / m_telem_rate), Q_ARG(int, 1000 / m_video_rate));
     }
 }
 
 // -----------------------------------------------------------------------------
-void NetworkDeviceController::onVideoTick()
+void NetworkDeviceController::stopStreams()
 {
-    if (!sendPacket(CLIENT_REQ_MJPG_FRAME))
+    if (m_subscribed)
     {
-        Logger::err("NetworkDevice: failed to send mjpg frame request\n");
+        subscribe(SUB_CHANNEL_TELEMETRY, 0);
+        subscribe(SUB_CHANNEL_MJPG, 0);
+        m_subscribed = false;
     }
+
+    if (m_io)
+        QMetaObject::invokeMethod(m_io, "stopPolling");
+    if (m_video_io)
+        QMetaObject::invokeMethod(m_video_io, "stopPolling");
 }
 
 // -----------------------------------------------------------------------------
-void NetworkDeviceController::onControllerTick()
+void NetworkDeviceController::shutdown()
 {
-    // Memory of previous mixed controller values
-    static float prev_pitch = 0.0f;
-    static float prev_roll = 0.0f;
-    static float prev_yaw = 0.0f;
-
-    if (STATE_MIXED_CONTROL == m_state)
+    if (m_stats_timer)
     {
-        uint32_t cmd_buffer[PKT_MCM_AXIS_NUM];
-        char send = 0;
-      
-        cmd_buffer[PKT_COMMAND] = CLIENT_REQ_FLIGHT_CTL;
-        cmd_buffer[PKT_LENGTH]  = PKT_MCM_LENGTH;
-      
-        if ((m_axes & AXIS_ALT) && (m_ctl.alt != m_prev_alt))
-        {
-            m_prev_alt = m_ctl.alt;
-            //send = 1;
-        }
+        stopControl();
 
-        if ((m_axes & AXIS_PITCH) && (m_ctl.pitch != prev_pitch))
-        {
-            prev_pitch = m_ctl.pitch;
-            send = 1;
-        }
+        m_stats_timer->stop();
+        SafeDelete(m_stats_timer);
 
-        if ((m_axes & AXIS_ROLL) && (m_ctl.roll != prev_roll))
-        {
-            prev_roll = m_ctl.roll;
-            send = 1;
-        }
+        SafeDelete(m_connect_timer);
+        SafeDelete(m_reconnect_timer);
+        SafeDelete(m_video_timer);
+    }
 
-        if ((m_axes & AXIS_YAW) && (m_ctl.yaw != prev_yaw))
-        {
-            prev_yaw = m_ctl.yaw;
-            send = 1;
-        }
+    emit connectionStatusChanged(m_device + " disconnected", false);
+    emit controlStateChanged(STATE_DISCONNECTED);
+}
 
-        memcpy(&cmd_buffer[PKT_MCM_AXIS_YAW],   &m_ctl.yaw,   4);
-        memcpy(&cmd_buffer[PKT_MCM_AXIS_PITCH], &m_ctl.pitch, 4);
-        memcpy(&cmd_buffer[PKT_MCM_AXIS_ROLL],  &m_ctl.roll,  4);
-        memcpy(&cmd_buffer[PKT_MCM_AXIS_ALT],   &m_ctl.alt,   4);
+// -----------------------------------------------------------------------------
+bool NetworkDeviceController::sendPacket(uint32_t *buffer, int length) const
+{
+    return sendPacket(m_io, buffer, length);
+}
 
-        if (send && !sendPacket(cmd_buffer, PKT_MCM_LENGTH))
-        {
-            Logger::err("NetworkDevice: failed to send \
-                        flight control request\n");
-        }
-        else if (send)
-        {
-            fprintf(stderr, "Sent ALT:   %f\n", m_ctl.alt);
-            fprintf(stderr, "Sent PITCH: %f\n", m_ctl.pitch);
-            fprintf(stderr, "Sent ROLL:  %f\n", m_ctl.roll);
-            fprintf(stderr, "Sent YAW:   %f\n\n", m_ctl.yaw);
-        }
-    }
+// -----------------------------------------------------------------------------
+bool NetworkDeviceController::sendControl(uint32_t *buffer, int length,
+        ControlTiming &timing)
+{
+    // the socket worker stamps and records the timing once it is written
+    return sendPacket(m_io, buffer, length, &timing);
+}
+
+// -----------------------------------------------------------------------------
+bool NetworkDeviceController::sendPacket(NetworkIO *io, uint32_t *buffer,
+        int length, const ControlTiming *timing) const
+{
+    // hand the packet to the socket worker, never block the caller on i/o
+    if (!io)
+        return false;
+
+    // a newer flight control packet makes any unsent one pointless
+    bool replace = (CLIENT_REQ_FLIGHT_CTL == buffer[PKT_COMMAND]);
+    return io->enqueue(QByteArray((const char *)buffer, length), replace,
+            timing);
 }
 
 // -----------------------------------------------------------------------------
-void NetworkDeviceController::onThrottleTick()
+bool NetworkDeviceController::sendPing(NetworkChannel channel) const
 {
-    float value = m_ctl.alt;
+    NetworkIO *io = (CHANNEL_VIDEO == channel) ? m_video_io : m_io;
+    uint64_t now = MonotonicMicros();
 
-    if ((value < m_prev_alt) && (m_prev_alt > 0.0f) && (value > 0.0f))
+    uint32_t cmd_buffer[PKT_PING_NUM];
+    cmd_buffer[PKT_COMMAND]      = CLIENT_REQ_PING;
+    cmd_buffer[PKT_LENGTH]       = PKT_PING_LENGTH;
+    cmd_buffer[PKT_PING_CHANNEL] = channel;
+    cmd_buffer[PKT_PING_TIME_LO] = (uint32_t)now;
+    cmd_buffer[PKT_PING_TIME_HI] = (uint32_t)(now >> 32);
+    return sendPacket(io, cmd_buffer, PKT_PING_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+void NetworkDeviceController::onStatsTick()
+{
+    // a ping on each socket measures how long a small packet waits there
+    if (m_peer_caps & IDENT_CAP_PING)
     {
-        // joystick is going from postive to zero
-        // do nothing
+        sendPing(CHANNEL_CONTROL);
+        if (m_video_io)
+            sendPing(CHANNEL_VIDEO);
     }
-    else if ((value > m_prev_alt) && (m_prev_alt < 0.0f) && (value < 0.0f))
+
+    if (++m_stats_ticks >= NETDEV_STATS_LOG_TICKS)
     {
-        // joystick is going from negative to zero
-        // do nothing
+        m_stats_ticks = 0;
+        logStats(false);
     }
-    else if ((value >= 0.1f) || (value <= -0.1f))
+}
+
+// -----------------------------------------------------------------------------
+void NetworkDeviceController::logStats(bool summary)
+{
+    static const char *names[CHANNEL_COUNT] = { "control", "video" };
+    NetworkIO *ios[CHANNEL_COUNT] = { m_io, m_video_io };
+    double seconds = NETDEV_STATS_INTERVAL * NETDEV_STATS_LOG_TICKS / 1000.0;
+
+    // the periodic report is debug output, don't build it for nothing
+    if (!summary && !Logger::enabled(LOG_TYPE_DBG))
     {
-        // m_prev_alt == value
-        // the user hasn't moved the joystick since the last poll, so tell
-        // the server to keep incrementing the throttle pwm
-        uint32_t cmd_buffer[32];
-
-        cmd_buffer[PKT_COMMAND] = CLIENT_REQ_FLIGHT_CTL;
-        cmd_buffer[PKT_LENGTH]  = PKT_MCM_LENGTH;
-        cmd_buffer[PKT_MCM_AXIS_ALT]   = *(uint32_t *)&m_ctl.alt;
-        cmd_buffer[PKT_MCM_AXIS_PITCH] = *(uint32_t *)&m_ctl.pitch;
-        cmd_buffer[PKT_MCM_AXIS_ROLL]  = *(uint32_t *)&m_ctl.roll;
-        cmd_buffer[PKT_MCM_AXIS_YAW]   = *(uint32_t *)&m_ctl.yaw;
-
-        fprintf(stderr, "acting on throttle event signal %f\n", m_ctl.alt);
-        if (!sendPacket(cmd_buffer, PKT_MCM_LENGTH))
+        for (int i = 0; i < CHANNEL_COUNT; ++i)
         {
-            // report the error and continue on
-            Logger::err("NetworkDevice: failed to send throttle event\n");
+            if (ios[i])
+                m_last_stats[i] = ios[i]->stats();
         }
+        return;
     }
-}
 
-// -----------------------------------------------------------------------------
-void NetworkDeviceController::onSocketReadyRead()
-{
-    QDataStream stream(m_sock);
-    stream.setVersion(QDataStream::Qt_4_0);
-    int32_t rssi, battery, aux, framesz,cpu;
-    float x, y, z, h;
-    float kp, ki, kd, sp;
-    QString log_msg, type;
-    QRect bbox;
-    QPoint point;
-    bool enabled;
-
-    if (0 == m_blocksz)
+    for (int i = 0; i < CHANNEL_COUNT; ++i)
     {
-        if ((size_t)m_sock->bytesAvailable() < PKT_BASE_LENGTH)
-            return;
+        if (!ios[i])
+            continue;
+
+        // rates over the last interval, latency over the whole session
+        NetworkIOStats stats = ios[i]->stats();
+        const LatencyHistogram &rtt = m_rtt[i];
+        QString msg = summary ?
+            tr("NetworkDevice: %1 totals: in %2 KB (%3 packets), "
+               "out %4 KB (%5 packets)")
+                .arg(names[i])
+                .arg(stats.bytes_in / 1024.0, 0, 'f', 1).arg(stats.packets_in)
+                .arg(stats.bytes_out / 1024.0, 0, 'f', 1).arg(stats.packets_out) :
+            tr("NetworkDevice: %1 in %2 KB/s (%3 pkt/s), out %4 KB/s")
+                .arg(names[i])
+                .arg((stats.bytes_in - m_last_stats[i].bytes_in) / 1024.0 /
+                        seconds, 0, 'f', 1)
+                .arg((stats.packets_in - m_last_stats[i].packets_in) /
+                        seconds, 0, 'f', 1)
+                .arg((stats.bytes_out - m_last_stats[i].bytes_out) / 1024.0 /
+                        seconds, 0, 'f', 1);
+        m_last_stats[i] = stats;
+
+        if (rtt.count())
+        {
+            msg += tr(", rtt p50 %1 ms p99 %2 ms max %3 ms")
+                .arg(rtt.percentile(0.50) / 1000.0, 0, 'f', 2)
+                .arg(rtt.percentile(0.99) / 1000.0, 0, 'f', 2)
+                .arg(rtt.maximum() / 1000.0, 0, 'f', 2);
+        }
 
-        uint32_t header[PKT_BASE];
-        stream.readRawData((char *)&header[0], PKT_BASE_LENGTH);
-        m_blocksz = header[PKT_LENGTH] - PKT_BASE_LENGTH;
-        // fprintf(stderr, "packet cmd %d size %d\n", header[0], header[1]);
+        // how the outbound queue is coping
+        const LatencyHistogram &wl = stats.write_latency;
+        if (wl.count())
+        {
+            msg += tr(", queue %1 (peak %2), write p50 %3 ms p99 %4 ms, "
+                      "%5 packets in %6 writes, %7 superseded")
+                .arg(stats.queue_depth).arg(stats.queue_peak)
+                .arg(wl.percentile(0.50) / 1000.0, 0, 'f', 2)
+                .arg(wl.percentile(0.99) / 1000.0, 0, 'f', 2)
+                .arg(stats.packets_out).arg(stats.writes)
+                .arg(stats.superseded);
+        }
 
-        // reserve enough room for the entire message, copy the header over
-        m_buffer.reserve(header[PKT_LENGTH]);
-        memcpy(&m_buffer[0], &header[0], PKT_BASE_LENGTH);
+        msg += "\n";
+        if (summary)
+            Logger::info(msg);
+        else
+            Logger::dbg(msg);
     }
+}
 
-    if (m_sock->bytesAvailable() < m_blocksz)
-        return;
+// -----------------------------------------------------------------------------
+void NetworkDeviceController::onPacketsReady()
+{
+    InboundPacket packet;
+    NetworkIO *io = qobject_cast<NetworkIO *>(sender());
 
-    // interpret the packet
-    uint32_t *packet = (uint32_t *)&m_buffer[0];
-    stream.readRawData((char *)&packet[PKT_BASE], m_blocksz);
-    m_blocksz = 0;
+    // drain everything the socket worker has parsed so far (processing a
+    // packet may tear the worker down, so check it is still ours each time)
+    do
+    {
+        while ((io == m_io || io == m_video_io) && io && io->dequeue(packet))
+            processPacket((const uint32_t *)packet.data.constData(),
+                          packet.timing);
+    }
+    while ((io == m_io || io == m_video_io) && io && !io->drained());
+}
+
+// -----------------------------------------------------------------------------
+void NetworkDeviceController::processPacket(const uint32_t *packet,
+        const PacketTiming &timing)
+{
+    uint32_t cmd_buffer[16];
 
     switch (packet[0])
     {
     case SERVER_REQ_IDENT:
-        Logger::info("NetworkDevice: SERVER_REQ_IDENT: sending response...\n");
-        packet[PKT_COMMAND]     = CLIENT_ACK_IDENT;
-        packet[PKT_LENGTH]      = PKT_RCI_LENGTH;
-        packet[PKT_RCI_MAGIC]   = IDENT_MAGIC;
-        packet[PKT_RCI_VERSION] = IDENT_VERSION;
-        stream.writeRawData((char *)&packet[0], PKT_RCI_LENGTH);
-        m_telem_timer->start(67); // begin requesting telemetry
-        m_mjpeg_timer->start(67); // begin requesting frames
-        m_controller_timer->start(50); // begin requesting flight control
-        onUpdateColorTrackEnable(2);   // Request Color Track Enable Status
-        onUpdateTrackControlEnable(2); // Request Track Control Enable Status
-        break;
-    case SERVER_ACK_IGNORED:
-        Logger::info("NetworkDevice: SERVER_ACK_IGNORED\n");
-        break;
-    case SERVER_ACK_TAKEOFF:
-        Logger::info("NetworkDevice: SERVER_ACK_TAKEOFF\n");
-        break;
-    case SERVER_ACK_LANDING:
-        Logger::info("NetworkDevice: SERVER_ACK_LANDING\n");
-        break;
-    case SERVER_ACK_TELEMETRY:
-        z = *(float *)&packet[PKT_VTI_YAW];
-        y = *(float *)&packet[PKT_VTI_PITCH];
-        x = *(float *)&packet[PKT_VTI_ROLL];
-        h = *(float *)&packet[PKT_VTI_ALT];
-       
-        rssi    = packet[PKT_VTI_RSSI];
-        battery = packet[PKT_VTI_BATT];
-        aux     = packet[PKT_VTI_AUX];
-        cpu     = packet[PKT_VTI_CPU];
-
-        emit telemetryReady(-z, -y, x, h, rssi, battery, aux, cpu);
-        Logger::telemetry(tr("%1 %2 %3 %4 %5 %6 %7 %8\n").arg(-z).arg(-y).arg(x)
-                            .arg(h).arg(rssi).arg(battery).arg(aux).arg(cpu));
-        break;
-    case SERVER_ACK_MJPG_FRAME:
-        framesz = packet[PKT_LENGTH] - PKT_MJPG_LENGTH;
-        emit videoFrameReady((const char *)&packet[PKT_MJPG_IMG], 
-                            (size_t)framesz);
-        break;
-    case SERVER_UPDATE_CTL_MODE:
-        // if current control mode was mixed, stop the throttle timer
-        if (m_state == STATE_MIXED_CONTROL)
-            m_throttle_timer->stop();
-
-        switch (packet[PKT_VCM_TYPE])
+        // only the handshake brings the link up, a repeat once online (or
+        // one racing a teardown) must not restart streams or timers
+        if (LINK_CONNECTING != m_link && LINK_HANDSHAKE != m_link)
         {
-        case VCM_TYPE_RADIO:
-            Logger::info("NetworkDevice: got UPDATE_CTL_MODE to radio\n");
-            m_state = STATE_RADIO_CONTROL;
-            break;
-        case VCM_TYPE_AUTO:
-            Logger::info("NetworkDevice: got UPDATE_CTL_MODE to auto\n");
-            m_state = STATE_AUTONOMOUS;
-            break;
-        case VCM_TYPE_MIXED:
-            Logger::info("NetworkDevice: got UPDATE_CTL_MODE to mixed\n");
-            m_state = STATE_MIXED_CONTROL;
-            m_prev_alt = 0.0f;
-            m_throttle_timer->start(50);
-            break;
-        case VCM_TYPE_KILL: 
-            Logger::info("NetworkDevice: got UPDATE_CTL_MODE to killed\n");
-            m_state = STATE_KILLED;
-            break;
-        case VCM_TYPE_LOCKOUT:
-            Logger::info("NetworkDevice: got UPDATE_CTL_MODE to lockout\n");
-            m_state = STATE_LOCKOUT;
-            break;
-        default:
-            Logger::info("NetworkDevice: got UPDATE_CTL_MODE !! invalid !!\n");
-            m_state = STATE_KILLED;
+            Logger::warn("NetworkDevice: SERVER_REQ_IDENT in link state %1, "
+                    "ignored\n", (int)m_link);
             break;
         }
 
-        m_axes = 0;
-        if (packet[PKT_VCM_AXES] & VCM_AXIS_ALT)   m_axes |= AXIS_ALT;
-        if (packet[PKT_VCM_AXES] & VCM_AXIS_YAW)   m_axes |= AXIS_YAW;
-        if (packet[PKT_VCM_AXES] & VCM_AXIS_PITCH) m_axes |= AXIS_PITCH;
-        if (packet[PKT_VCM_AXES] & VCM_AXIS_ROLL)  m_axes |= AXIS_ROLL;
-
-        if (m_state == STATE_MIXED_CONTROL)
+        Logger::info("NetworkDevice: SERVER_REQ_IDENT: sending response...\n");
+        m_link = LINK_ONLINE;
+        m_connect_timer->stop();
+        m_backoff = NETDEV_BACKOFF_MIN;
+        cmd_buffer[PKT_COMMAND]     = CLIENT_ACK_IDENT;
+        cmd_buffer[PKT_LENGTH]      = PKT_RCI_LENGTH;
+        cmd_buffer[PKT_RCI_MAGIC]   = IDENT_MAGIC;
+        cmd_buffer[PKT_RCI_VERSION] = IDENT_VERSION;
+        sendPacket(cmd_buffer, PKT_RCI_LENGTH);
+
+        // newer vehicles advertise their capabilities in the version word,
+        // older ones send a bare header or a plain version number
+        m_peer_caps = 0;
+        if (packet[PKT_LENGTH] >= PKT_RCI_LENGTH)
+            m_peer_caps = packet[PKT_RCI_VERSION] & IDENT_CAP_MASK;
+
+        // begin receiving telemetry and frames, pushed or polled, once we
+        // know whether the frames get a socket of their own
+        if ((m_peer_caps & IDENT_CAP_VIDEO_PORT) && !m_options.contains("shared"))
+            sendPacket(CLIENT_REQ_VIDEO_PORT);
+        else
+            startStreams();
+        m_stats_timer->start(NETDEV_STATS_INTERVAL);
+        enableControl(true); // begin flight control
+
+        if (m_lost_at)
         {
-            if ((m_axes & AXIS_ALT) && !m_throttle_timer->isActive())
-                m_throttle_timer->start(50);
-            else if (!(m_axes & AXIS_ALT) && m_throttle_timer->isActive())
-                m_throttle_timer->stop();
+            // same vehicle, new session - put back what the operator had
+            restoreSession();
         }
-        
-        emit controlStateChanged((int)m_state);
-        break;
-    case SERVER_UPDATE_STATE:
-        emit flightStateChanged((int)packet[PKT_FCS_STATE]);
-        break;
-    case SERVER_UPDATE_TRACKING:
-        bbox.setCoords(packet[PKT_CTS_X1], packet[PKT_CTS_Y1], 
-                       packet[PKT_CTS_X2], packet[PKT_CTS_Y2]);
-        point = QPoint(packet[PKT_CTS_XC], packet[PKT_CTS_YC]);
-        enabled = packet[PKT_CTS_STATE] == CTS_STATE_DETECTED;
-        emit trackStatusUpdate(enabled, bbox, point);
-        break;
-    case SERVER_UPDATE_COLOR:
-        //Logger::info("NETWORK: RECEIVED Update color\n");
-        //R G B, ht, st, ft, fps
-        emit colorValuesUpdate(TrackSettings(
-            QColor((int)packet[PKT_CAM_TC_CH0], 
-                    (int)packet[PKT_CAM_TC_CH1], 
-                    (int)packet[PKT_CAM_TC_CH2]),
-             (int)packet[PKT_CAM_TC_TH0], 
-             (int)packet[PKT_CAM_TC_TH1], 
-             (int)packet[PKT_CAM_TC_FILTER], 
-             (int)packet[PKT_CAM_TC_FPS],
-             (int)packet[PKT_CAM_TC_ENABLE]));
-        break;
-    case SERVER_UPDATE_CAM_DCI:
-        // convert the type to a string for genericness
-        switch (packet[PKT_CAM_DCI_TYPE])
+        else
         {
-        case CAM_DCI_TYPE_BOOL: type = "bool"; break;
-        case CAM_DCI_TYPE_INT:  type = "int"; break;
-        case CAM_DCI_TYPE_MENU: type = "menu"; break;
-        default:
-            // bad pie
-            return;
+            onUpdateColorTrackEnable(2);   // Request Color Track Enable Status
+            onUpdateTrackControlEnable(2); // Request Track Control Enable Status
         }
-        emit deviceControlUpdated(QString((char *)&packet[PKT_CAM_DCI_NAME]),
-                type, packet[PKT_CAM_DCI_ID],
-                packet[PKT_CAM_DCI_MIN], packet[PKT_CAM_DCI_MAX],
-                packet[PKT_CAM_DCI_STEP], packet[PKT_CAM_DCI_DEFAULT], 
-                packet[PKT_CAM_DCI_CURRENT]);
-        break;
-    case SERVER_UPDATE_CAM_DCM:
-        emit deviceMenuUpdated(QString((char *)&packet[PKT_CAM_DCM_NAME]),
-                packet[PKT_CAM_DCM_ID], packet[PKT_CAM_DCM_INDEX]);
-        break;
-    case SERVER_ACK_TCE:
-        Logger::info(tr("NETWORK: RECEIVED \
-                New Track Control Enable: %1\n").arg(packet[PKT_TE_STATUS]));
-        emit updateTrackControlEnable(packet[PKT_TE_STATUS]);
-        break;
-    case SERVER_ACK_CTE:
-        Logger::info(tr("NETWORK: RECEIVED \
-                New Color Track Enable: %1\n").arg(packet[PKT_TE_STATUS]));
-        emit updateColorTrackEnable(packet[PKT_TE_STATUS]);
-        break;
-    case SERVER_ACK_GTS:
-        emit trimSettingsUpdated(packet[PKT_GTS_YAW], packet[PKT_GTS_PITCH],
-                packet[PKT_GTS_ROLL], packet[PKT_GTS_ALT]);
+        m_attempts = 0;
         break;
-    case SERVER_ACK_GFS:
-        emit filterSettingsUpdated(packet[PKT_GFS_IMU], packet[PKT_GFS_ALT],
-                packet[PKT_GFS_AUX], packet[PKT_GFS_BATT]);
+    case SERVER_ACK_VIDEO_PORT:
+        // streams start once the video socket is up, or right away if not.
+        // the framer only promises a header, a short ack carries no port
+        if (packet[PKT_LENGTH] < PKT_VPORT_LENGTH)
+        {
+            Logger::warn("NetworkDevice: short SERVER_ACK_VIDEO_PORT (%1 bytes)\n",
+                    packet[PKT_LENGTH]);
+            if (!m_video_io)
+                startStreams();
+        }
+        else if (m_video_io || !openVideo(packet[PKT_VPORT_PORT]))
+        {
+            startStreams();
+        }
         break;
-    case SERVER_ACK_GPIDS:
-        memcpy(&kp, &packet[PKT_GPIDS_KP], 4);
-        memcpy(&ki, &packet[PKT_GPIDS_KI], 4);
-        memcpy(&kd, &packet[PKT_GPIDS_KD], 4);
-        memcpy(&sp, &packet[PKT_GPIDS_SP], 4);
-
-        Logger::info(tr("NetworkDevice: Recieved GPID axis:%1 Kp:%2 Ki:%3 Kd:%4 SP:%5\n")
-                .arg(packet[PKT_GPIDS_AXIS]).arg(kp).arg(ki).arg(kd).arg(sp));
-        
-        emit pidSettingsUpdated(packet[PKT_GPIDS_AXIS], kp, ki, kd, sp);
+    case SERVER_ACK_PING:
+        if (packet[PKT_LENGTH] < PKT_PING_LENGTH)
+        {
+            Logger::warn("NetworkDevice: short SERVER_ACK_PING (%1 bytes)\n",
+                    packet[PKT_LENGTH]);
+        }
+        else if (packet[PKT_PING_CHANNEL] < (uint32_t)CHANNEL_COUNT)
+        {
+            uint64_t sent = ((uint64_t)packet[PKT_PING_TIME_HI] << 32) |
+                            packet[PKT_PING_TIME_LO];
+            m_rtt[packet[PKT_PING_CHANNEL]].record(MonotonicMicros() - sent);
+        }
         break;
     default:
-        Logger::err(tr("NetworkDevice: bad server cmd: %1\n").arg(packet[0]));
+        // everything else means the same on any link
+        VehicleController::processPacket(packet, timing);
         break;
     }
-
 }
 
 // -----------------------------------------------------------------------------
 void NetworkDeviceController::onSocketDisconnected()
 {
-    shutdown();
+    // queued, the worker may be in the middle of the emitting socket's code
+    QMetaObject::invokeMethod(this, "onLinkLost", Qt::QueuedConnection);
 }
 
 // -----------------------------------------------------------------------------
@@ -591,306 +718,6 @@ void NetworkDeviceController::onSocketError(QAbstractSocket::SocketError error)
         Logger::err("NetworkDevice: connection error (generic/unknown)\n");
         break;
     }
-    shutdown();
-}
-
-// -----------------------------------------------------------------------------
-void NetworkDeviceController::onInputReady(
-        GamepadEvent event, int index, float value)
-{
-    //Button 4 - A
-    //Button 5 - B
-    //Button 6 - X
-    //Button 7 - Y
-    //Button 8 - LB
-    //Button 9 - RB
-    //Button 10 - Back
-    //Button 11 - Start
-    uint32_t cmd_buffer[32];
-
-    if (GP_EVENT_BUTTON == event)
-    {
-        
-        if ((12 == index) && (value > 0.0))
-        {
-            int vcm_type;
-            if (STATE_MIXED_CONTROL == m_state)
-            {
-                Logger::info("NetworkDevice:requesting switch to autonomous\n");
-                vcm_type = VCM_TYPE_AUTO;
-            }
-            else
-            {
-                Logger::info("NetworkDevice:requesting switch to mixed mode\n");
-                vcm_type = VCM_TYPE_MIXED;
-            }
-
-            // request server to set new control mode
-            cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_SET_CTL_MODE;
-            cmd_buffer[PKT_LENGTH]   = PKT_VCM_LENGTH;
-            cmd_buffer[PKT_VCM_TYPE] = vcm_type;
-            cmd_buffer[PKT_VCM_AXES] = VCM_AXIS_ALL;
-            sendPacket(cmd_buffer, PKT_VCM_LENGTH);
-        }
-        else if ((STATE_MIXED_CONTROL == m_state) && (value > 0.0) && 
-                (index >= 4) && (index <= 7))
-        {
-            // update the mixed mode controlled axes
-            int vcm_axes = 0;
-            if (m_axes & AXIS_ALT)   vcm_axes |= VCM_AXIS_ALT;
-            if (m_axes & AXIS_YAW)   vcm_axes |= VCM_AXIS_YAW;
-            if (m_axes & AXIS_PITCH) vcm_axes |= VCM_AXIS_PITCH;
-            if (m_axes & AXIS_ROLL)  vcm_axes |= VCM_AXIS_ROLL;
-
-            switch (index)
-            {
-            case 4: // A
-                vcm_axes = BIT_INV(vcm_axes, VCM_AXIS_ALT);
-                m_prev_alt = 0.0f;
-                if (vcm_axes & VCM_AXIS_ALT)
-                    m_throttle_timer->start(50);
-                else
-                    m_throttle_timer->stop();
-                break;
-            case 5: // B
-                vcm_axes = BIT_INV(vcm_axes, VCM_AXIS_ROLL);
-                break;
-            case 6: // X
-                vcm_axes = BIT_INV(vcm_axes, VCM_AXIS_YAW);
-                break;
-            case 7: // Y
-                vcm_axes = BIT_INV(vcm_axes, VCM_AXIS_PITCH);
-                break;
-            default:
-                Logger::warn("NetworkDevice: \
-                        unknown controller button - Axis\n");
-                break;
-            }
-
-            // tell server which axes are manually controlled by mixed mode
-            cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_SET_CTL_MODE;
-            cmd_buffer[PKT_LENGTH]   = PKT_VCM_LENGTH;
-            cmd_buffer[PKT_VCM_TYPE] = VCM_TYPE_MIXED;
-            cmd_buffer[PKT_VCM_AXES] = vcm_axes;
-            sendPacket(cmd_buffer, PKT_VCM_LENGTH);
-        }
-        else if ((value > 0.0) && (index >= 8) && (index <= 11))
-        {
-           
-
-            switch (index)
-            {
-            case 8: // LB - Take off
-                requestTakeoff();
-                break;
-            case 9: // RB - Land
-                requestLanding();
-                break;
-            case 10: // Back - Kill
-                requestKillswitch();
-                break;
-            case 11: // Start - Enable color tracking
-                Logger::info("Xbox - Enable Color Tracking\n");
-                break;
-            default:
-                Logger::warn("NetworkDevice: unknown controller \
-                            button - Commands\n");
-                break;
-            }
-        }
-    }
-    else if (GP_EVENT_AXIS == event)
-    {
-        if (index >= 0 && index <= 3)
-        {
-            switch (index)
-            {
-            case 0:
-                m_ctl.yaw = value;
-                break;
-            case 1:
-                m_ctl.alt = -value;
-                break;
-            case 2:
-                m_ctl.roll = value;
-                break;
-            case 3:
-                m_ctl.pitch = value;
-                break;
-            default:
-                fprintf(stderr, "NetworkDeviceController: unknown axis");
-                break;
-            }
-        }
-    }
-}
-
-// -----------------------------------------------------------------------------
-void NetworkDeviceController::onUpdateTrackControlEnable(int track_en)
-{
-    uint32_t cmd_buffer[16];
-    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_TCE;
-    cmd_buffer[PKT_LENGTH]  = PKT_TE_LENGTH ;
-    
-    switch (track_en) {
-    case 0:
-        Logger::info("NetworkController: requesting track control disable\n");
-        break;
-    case 1:
-        Logger::info("NetworkController: requesting track control enable\n");
-        break;
-    case 2:
-        Logger::info("NetworkController: requesting track control value\n");
-        break;              
-    }
-    
-    cmd_buffer[PKT_TE_STATUS] = track_en;
-    sendPacket(cmd_buffer, PKT_TE_LENGTH);
-}
-
-// -----------------------------------------------------------------------------
-void NetworkDeviceController::onUpdateColorTrackEnable(int track_en)
-{
-    uint32_t cmd_buffer[16];
-    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_CTE;
-    cmd_buffer[PKT_LENGTH]  = PKT_TE_LENGTH ;
-    
-    switch (track_en)
-    {
-    case 0:
-        Logger::info("NetworkController: requesting color track disable\n");
-        break;
-    case 1:
-        Logger::info("NetworkController: requesting color track enable\n");
-        break;
-    case 2:
-        Logger::info("NetworkController: requesting color track value\n");
-        break;              
-    }
-    
-    cmd_buffer[PKT_TE_STATUS] = track_en;
-    sendPacket(cmd_buffer, PKT_TE_LENGTH);
-}
-
-// -----------------------------------------------------------------------------
-void NetworkDeviceController::updateTrackSettings(
-        int r, int g, int b, int ht, int st, int ft, int fps)
-{
-    uint32_t cmd_buffer[16];
-
-    m_track.color = QColor(r, g, b);
-    if (ht  >= 0) m_track.ht = ht;
-    if (st  >= 0) m_track.st = st;
-    if (ft  >= 0) m_track.ft = ft;
-    if (fps >= 0) m_track.fps = fps;
-
-    cmd_buffer[PKT_COMMAND]       = CLIENT_REQ_CAM_TC;
-    cmd_buffer[PKT_LENGTH]        = PKT_CAM_TC_LENGTH;
-    cmd_buffer[PKT_CAM_TC_ENABLE] = (uint32_t)m_track_en;
-    cmd_buffer[PKT_CAM_TC_FMT]    = CAM_TC_FMT_RGB;
-    cmd_buffer[PKT_CAM_TC_CH0]    = m_track.color.red();
-    cmd_buffer[PKT_CAM_TC_CH1]    = m_track.color.green();
-    cmd_buffer[PKT_CAM_TC_CH2]    = m_track.color.blue();
-    cmd_buffer[PKT_CAM_TC_TH0]    = m_track.ht;
-    cmd_buffer[PKT_CAM_TC_TH1]    = m_track.st;
-    cmd_buffer[PKT_CAM_TC_TH2]    = 0;
-    cmd_buffer[PKT_CAM_TC_FILTER] = m_track.ft;
-    cmd_buffer[PKT_CAM_TC_FPS]    = m_track.fps;
-
-    Logger::info(tr("req track color [%1 %2 %3], thresh [%4 %5], fps %6\n")
-            .arg(r).arg(g).arg(b).arg(m_track.ht)
-            .arg(m_track.st).arg(m_track.fps));
-
-    sendPacket(cmd_buffer, PKT_CAM_TC_LENGTH);
-}
-
-// -----------------------------------------------------------------------------
-void NetworkDeviceController::updateDeviceControl(int id, int value)
-{
-    uint32_t cmd_buffer[PKT_CAM_DCC_NUM];
-    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_CAM_DCC;
-    cmd_buffer[PKT_LENGTH]  = PKT_CAM_DCC_LENGTH;
-    cmd_buffer[PKT_CAM_DCC_ID] = id;
-    cmd_buffer[PKT_CAM_DCC_VALUE] = value;
-    sendPacket(cmd_buffer, PKT_CAM_DCC_LENGTH);
-}
-
-// -----------------------------------------------------------------------------
-void NetworkDeviceController::updateTrimSettings(int axes, int value)
-{
-    uint32_t cmd_buffer[PKT_STS_NUM];
-    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_STS;
-    cmd_buffer[PKT_LENGTH]  = PKT_STS_LENGTH;
-
-    int vcm_axes = 0;
-    if (axes & AXIS_ALT)   vcm_axes |= VCM_AXIS_ALT;
-    if (axes & AXIS_YAW)   vcm_axes |= VCM_AXIS_YAW;
-    if (axes & AXIS_PITCH) vcm_axes |= VCM_AXIS_PITCH;
-    if (axes & AXIS_ROLL)  vcm_axes |= VCM_AXIS_ROLL;
-
-    cmd_buffer[PKT_STS_AXES] = vcm_axes;
-    cmd_buffer[PKT_STS_VALUE] = value;
-    sendPacket(cmd_buffer, PKT_STS_LENGTH);
-}
-
-// -----------------------------------------------------------------------------
-void NetworkDeviceController::updateFilterSettings(int signal, int samples)
-{
-    uint32_t cmd_buffer[PKT_SFS_NUM];
-    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_SFS;
-    cmd_buffer[PKT_LENGTH]  = PKT_SFS_LENGTH;
-
-    uint32_t sfs_sig;
-    switch (signal)
-    {
-    case SIGNAL_ORIENTATION:
-        sfs_sig = SFS_IMU;
-        break;
-    case SIGNAL_ALTITUDE:
-        sfs_sig = SFS_ALT;
-        break;
-    case SIGNAL_AUXILIARY:
-        sfs_sig = SFS_AUX;
-        break;
-    case SIGNAL_BATTERY:
-        sfs_sig = SFS_BATT;
-        break;
-    }
-
-    cmd_buffer[PKT_SFS_SIGNAL] = sfs_sig;
-    cmd_buffer[PKT_SFS_SAMPLES] = samples;
-    sendPacket(cmd_buffer, PKT_SFS_LENGTH);
-}
-
-// -----------------------------------------------------------------------------
-void NetworkDeviceController::updatePIDSettings(int axis, int signal, 
-                                                float value)
-{
-    uint32_t cmd_buffer[PKT_SPIDS_NUM];
-
-    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_SPIDS;
-    cmd_buffer[PKT_LENGTH]  = PKT_SPIDS_LENGTH;
-
-    uint32_t spids_sig;
-    switch (signal)
-    {
-        case SIGNAL_KP:
-            spids_sig = SPIDS_KP;
-            break;
-        case SIGNAL_KI:
-            spids_sig = SPIDS_KI;
-            break;
-        case SIGNAL_KD:
-            spids_sig = SPIDS_KD;
-            break;
-        case SIGNAL_SP:
-            spids_sig = SPIDS_SP;
-            break;
-    }
-
-    cmd_buffer[PKT_SPIDS_PARAM] = spids_sig;
-    memcpy(&cmd_buffer[PKT_SPIDS_VALUE], &value, 4);
-    cmd_buffer[PKT_SPIDS_AXIS] = axis;
-    sendPacket(cmd_buffer, PKT_SPIDS_LENGTH);
+    QMetaObject::invokeMethod(this, "onLinkLost", Qt::QueuedConnection);
 }
 
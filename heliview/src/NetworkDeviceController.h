@@ -9,18 +9,39 @@
 #ifndef _HELIVIEW_NETWORKDEVICECONTROLLER__H_
 #define _HELIVIEW_NETWORKDEVICECONTROLLER__H_
 
-#include <QTcpSocket>
+#include <QThread>
 #include <QTimer>
-#include <vector>
-#include "DeviceController.h"
+#include "LatencyHistogram.h"
+#include "LoopbackServer.h"
+#include "NetworkIO.h"
 #include "Utility.h"
+#include "VehicleController.h"
 
-typedef struct ctl_sigs
+#define NETDEV_STATS_INTERVAL   1000    // ms between pings
+#define NETDEV_STATS_LOG_TICKS  10      // pings between statistics reports
+#define NETDEV_CONNECT_TIMEOUT  3000    // ms to connect, and again to ident
+#define NETDEV_BACKOFF_MIN      250     // ms before the first retry
+#define NETDEV_BACKOFF_MAX      8000    // ms between retries at worst
+
+// traffic is split over up to two sockets, control/telemetry and video
+enum NetworkChannel
+{
+    CHANNEL_CONTROL = 0,
+    CHANNEL_VIDEO,
+    CHANNEL_COUNT
+};
+
+// connection life cycle, CLOSED only between close() and the next open()
+enum LinkState
 {
-    float alt, pitch, roll, yaw;
-} ctl_sigs_t;
+    LINK_CLOSED,
+    LINK_CONNECTING,    // waiting on the tcp connect
+    LINK_HANDSHAKE,     // connected, waiting on SERVER_REQ_IDENT
+    LINK_ONLINE,
+    LINK_BACKOFF,       // lost or failed, waiting to try again
+};
 
-class NetworkDeviceController: public DeviceController
+class NetworkDeviceController: public VehicleController
 {
     Q_OBJECT
 
@@ -33,64 +54,74 @@ public:
 
     virtual QString device() const { return m_device; }
     virtual QString controllerType() const { return QString("NetworkDevice"); }
-    virtual DeviceState currentState() const { return m_state; }
-    virtual int currentAxes() const { return m_axes; }
-    virtual TrackSettings currentTrackSettings() const { return m_track; }
-    virtual bool getTrackEnabled() const { return m_track_en; }
-
-    virtual bool requestDeviceControls() const;
-    virtual bool requestFilterSettings() const;
-    virtual bool requestTrimSettings() const;
-    virtual bool requestPIDSettings(int axis) const;
-
-    virtual bool requestTakeoff() const;
-    virtual bool requestLanding() const;
-    virtual bool requestManualOverride() const;
-    virtual bool requestAutonomous() const;
-    virtual bool requestKillswitch() const;
-    virtual bool requestColors() const;
+
+    virtual void processPacket(const uint32_t *packet,
+            const PacketTiming &timing);
 
     static const char *m_description;
     static const bool m_takesDevice;
 
 public slots:
-    void onTelemetryTick();
-    void onVideoTick();
-    void onControllerTick();
-    void onThrottleTick();
-    void onSocketReadyRead();
+    void onPacketsReady();
+    void onStatsTick();
+    void onSocketConnected();
     void onSocketDisconnected();
     void onSocketError(QAbstractSocket::SocketError error);
-    void onInputReady(GamepadEvent event, int index, float value);
-    
-    void updateTrackSettings(int r, int g, int b, int ht, int st, int ft, int fps);
-    void onUpdateTrackControlEnable(int track_en);
-    void onUpdateColorTrackEnable(int track_en);
-    void updateDeviceControl(int id, int value);
-    void updateTrimSettings(int axes, int value);
-    void updateFilterSettings(int signal, int samples);
-    void updatePIDSettings(int axis, int signal, float value);
+    void onConnectTimeout();
+    void onReconnectTick();
+    void onLinkLost();
+    void onVideoConnected();
+    void onVideoDisconnected();
+    void onVideoTimeout();
+    void closeVideo(int generation);
 
 protected:
     void startup();
     void shutdown();
-    bool sendPacket(uint32_t command) const;
-    bool sendPacket(uint32_t *buffer, int length) const;
+    NetworkIO *createIO(QThread *&thread);
+    void destroyIO(NetworkIO *&io, QThread *&thread);
+    void connectLink();
+    void restoreSession();
+    bool openVideo(int port);
+    void startStreams();
+    void stopStreams();
+    bool sendPing(NetworkChannel channel) const;
+    using VehicleController::sendPacket;
+    virtual bool sendPacket(uint32_t *buffer, int length) const;
+    virtual bool sendControl(uint32_t *buffer, int length,
+            ControlTiming &timing);
+    bool sendPacket(NetworkIO *io, uint32_t *buffer, int length,
+            const ControlTiming *timing = NULL) const;
+    void logStats(bool summary);
 
     QString           m_device;
-    QTcpSocket       *m_sock;
-    QTimer           *m_telem_timer;
-    QTimer           *m_mjpeg_timer;
-    QTimer           *m_controller_timer;
-    QTimer           *m_throttle_timer;
-    uint32_t          m_blocksz;
-    std::vector<char> m_buffer;
-    ctl_sigs_t        m_ctl;
-    DeviceState       m_state;
-    int               m_axes;
-    float             m_prev_alt;
-    TrackSettings     m_track;
-    bool              m_track_en;
+    QString           m_address;
+    int               m_port;
+    LinkState         m_link;
+    QTimer           *m_connect_timer;
+    QTimer           *m_reconnect_timer;
+    int               m_backoff;
+    int               m_attempts;
+    uint64_t          m_lost_at;
+    DeviceState       m_resume_state;
+    int               m_resume_axes;
+    QTimer           *m_video_timer;
+    int               m_video_gen;
+    DeviceOptions     m_options;
+    NetworkIO        *m_io;
+    QThread          *m_thread;
+    NetworkIO        *m_video_io;
+    QThread          *m_video_thread;
+    LoopbackServer   *m_server;
+    QThread          *m_server_thread;
+    uint32_t          m_peer_caps;
+    int               m_telem_rate;
+    int               m_video_rate;
+    bool              m_subscribed;
+    QTimer           *m_stats_timer;
+    int               m_stats_ticks;
+    LatencyHistogram  m_rtt[CHANNEL_COUNT];
+    NetworkIOStats    m_last_stats[CHANNEL_COUNT];
 };
 
 #endif // _HELIVIEW_NETWORKDEVICECONTROLLER__H_
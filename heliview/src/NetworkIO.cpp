@@ -0,0 +1,465 @@
+// -----------------------------------------------------------------------------
+// File:    NetworkIO.cpp
+// Created: 10-17-2026
+//
+// Socket I/O worker for the network device. May live on the GUI thread or be
+// moved onto a dedicated network thread by its controller.
+// -----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cassert>
+#include <QMetaType>
+#include <QVarLengthArray>
+#include "Logger.h"
+#include "NetworkIO.h"
+#include "uav_protocol.h"
+
+// -----------------------------------------------------------------------------
+NetworkIO::NetworkIO()
+: m_sock(NULL), m_telem_timer(NULL), m_mjpeg_timer(NULL),
+  m_inbound(NETIO_INBOUND_DEPTH), m_outbound(NETIO_OUTBOUND_DEPTH),
+  m_producer(QThread::currentThread()), m_handler(NULL), m_control_sink(NULL),
+  m_connected(0), m_notifyPending(0), m_flushPending(0), m_resumePending(0),
+  m_isStalled(0), m_sequence(0)
+{
+    qRegisterMetaType<QAbstractSocket::SocketError>(
+            "QAbstractSocket::SocketError");
+}
+
+// -----------------------------------------------------------------------------
+NetworkIO::~NetworkIO()
+{
+    SafeDelete(m_sock);
+}
+
+// -----------------------------------------------------------------------------
+bool NetworkIO::isConnected() const
+{
+    return 0 != const_cast<QAtomicInt &>(m_connected).fetchAndAddAcquire(0);
+}
+
+// -----------------------------------------------------------------------------
+NetworkIOStats NetworkIO::stats() const
+{
+    QMutexLocker lock(&m_stats_lock);
+    return m_stats;
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::countIn(uint64_t bytes, uint64_t packets)
+{
+    QMutexLocker lock(&m_stats_lock);
+    m_stats.bytes_in += bytes;
+    m_stats.packets_in += packets;
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::countOut(uint64_t bytes, uint64_t packets)
+{
+    QMutexLocker lock(&m_stats_lock);
+    m_stats.bytes_out += bytes;
+    m_stats.packets_out += packets;
+}
+
+// -----------------------------------------------------------------------------
+// sequence numbers wrap, so compare them by distance
+static bool SentBefore(const OutboundPacket &a, const OutboundPacket &b)
+{
+    return (int32_t)(a.sequence - b.sequence) < 0;
+}
+
+// -----------------------------------------------------------------------------
+bool NetworkIO::enqueue(const QByteArray &packet, bool replace,
+        const ControlTiming *control)
+{
+    assert(replace || QThread::currentThread() == m_producer);
+    if (!isConnected())
+        return false;
+
+    OutboundPacket entry;
+    entry.data = packet;
+    entry.queued = MonotonicMicros();
+    entry.sequence = (uint32_t)m_sequence.fetchAndAddRelaxed(1);
+    if (control)
+        entry.control = *control;
+
+    bool superseded = false;
+    if (replace)
+    {
+        // only the newest of these matters, so keep one per command
+        uint32_t command = ((const uint32_t *)packet.constData())[PKT_COMMAND];
+        QMutexLocker lock(&m_latest_lock);
+        superseded = m_latest.contains(command);
+        m_latest.insert(command, entry);
+    }
+    else if (!m_outbound.push(entry))
+    {
+        return false;
+    }
+
+    {
+        QMutexLocker lock(&m_stats_lock);
+        m_stats.superseded += superseded ? 1 : 0;
+        m_stats.queue_peak = qMax(m_stats.queue_peak, m_outbound.size());
+    }
+
+    // only one flush needs to be in flight no matter how many packets are
+    // queued ahead of it. always queued, even on our own thread, so that
+    // everything sent during one event loop turn goes out in one write
+    if (m_flushPending.testAndSetOrdered(0, 1))
+        QMetaObject::invokeMethod(this, "flushOutbound", Qt::QueuedConnection);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool NetworkIO::dequeue(InboundPacket &packet)
+{
+    return m_inbound.pop(packet);
+}
+
+// -----------------------------------------------------------------------------
+bool NetworkIO::drained()
+{
+    // re-arm the notification before the final emptiness check so a packet
+    // published in between is guaranteed to raise packetsReady() again
+    m_notifyPending.fetchAndStoreOrdered(0);
+
+    // if the reader backed off because the inbound queue was full, kick it.
+    // m_stalled itself belongs to the network thread, only the flag is ours
+    if (m_isStalled.fetchAndAddAcquire(0) &&
+        m_resumePending.testAndSetOrdered(0, 1))
+    {
+        QMetaObject::invokeMethod(this, "onSocketReadyRead",
+                Qt::QueuedConnection);
+    }
+
+    return m_inbound.empty();
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::connectSocket(const QString &address, int port)
+{
+    // start from a clean slate whatever state the last attempt left behind
+    closeSocket();
+
+    m_sock = new QTcpSocket(this);
+    connect(m_sock, SIGNAL(connected()), this, SLOT(onSocketConnected()));
+    connect(m_sock, SIGNAL(readyRead()), this, SLOT(onSocketReadyRead()));
+    connect(m_sock, SIGNAL(disconnected()), this, SLOT(onSocketDisconnected()));
+    connect(m_sock, SIGNAL(error(QAbstractSocket::SocketError)), this,
+            SLOT(onSocketError(QAbstractSocket::SocketError)));
+
+    m_telem_timer = new QTimer(this);
+    connect(m_telem_timer, SIGNAL(timeout()), this, SLOT(onTelemetryTick()));
+
+    m_mjpeg_timer = new QTimer(this);
+    connect(m_mjpeg_timer, SIGNAL(timeout()), this, SLOT(onVideoTick()));
+
+    // returns immediately, the outcome arrives as connected() or error()
+    m_sock->connectToHost(address, port);
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::closeSocket()
+{
+    m_connected.fetchAndStoreRelease(0);
+    stopPolling();
+
+    // anything queued this turn (unsubscribes, etc.) still goes out
+    flushOutbound();
+
+    if (m_sock)
+    {
+        // the controller is tearing us down, so don't echo the disconnect.
+        // never wait on the peer, whatever the kernel already has is still
+        // delivered and anything qt couldn't hand over is dropped
+        m_sock->disconnect(this);
+        m_sock->disconnectFromHost();
+        if (QAbstractSocket::UnconnectedState != m_sock->state())
+            m_sock->abort();
+        SafeDelete(m_sock);
+    }
+
+    SafeDelete(m_telem_timer);
+    SafeDelete(m_mjpeg_timer);
+    m_framer.reset();
+    m_stalled = InboundPacket();
+    m_isStalled.fetchAndStoreRelease(0);
+    m_requests.clear();
+    m_arrivals.clear();
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::startPolling(int telem_ms, int video_ms)
+{
+    // an interval of zero leaves that channel to someone else
+    if (m_telem_timer && telem_ms > 0) m_telem_timer->start(telem_ms);
+    if (m_mjpeg_timer && video_ms > 0) m_mjpeg_timer->start(video_ms);
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::stopPolling()
+{
+    if (m_telem_timer) m_telem_timer->stop();
+    if (m_mjpeg_timer) m_mjpeg_timer->stop();
+}
+
+// -----------------------------------------------------------------------------
+bool NetworkIO::writePacket(uint32_t command)
+{
+    if (!m_sock || QAbstractSocket::ConnectedState != m_sock->state())
+        return false;
+
+    uint32_t cmd_buffer[] = { command, PKT_BASE_LENGTH };
+    if (PKT_BASE_LENGTH != m_sock->write((char *)cmd_buffer, PKT_BASE_LENGTH))
+        return false;
+
+    countOut(PKT_BASE_LENGTH, 1);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::flushOutbound()
+{
+    m_flushPending.fetchAndStoreOrdered(0);
+
+    // take the plain packets before the superseding ones. a replace sent
+    // ahead of a plain packet we've popped is then always in m_latest, one
+    // sent after it at worst waits for the next flush
+    OutboundPacket packet;
+    QVarLengthArray<OutboundPacket, 64> plain;
+    while (m_outbound.pop(packet))
+        plain.append(packet);
+
+    QVarLengthArray<OutboundPacket, 8> latest;
+    {
+        QMutexLocker lock(&m_latest_lock);
+        QMap<uint32_t, OutboundPacket>::const_iterator it;
+        for (it = m_latest.constBegin(); it != m_latest.constEnd(); ++it)
+            latest.append(it.value());
+        m_latest.clear();
+    }
+    std::sort(latest.data(), latest.data() + latest.size(), SentBefore);
+
+    // merge the two back into call order for a single write
+    QByteArray batch;
+    QVarLengthArray<uint64_t, 64> queued;
+    QVarLengthArray<ControlTiming, 4> controls;
+    for (int i = 0, j = 0; i < plain.size() || j < latest.size(); )
+    {
+        const OutboundPacket &next = (j == latest.size() ||
+            (i < plain.size() && SentBefore(plain[i], latest[j]))) ?
+            plain[i++] : latest[j++];
+
+        batch.append(next.data);
+        queued.append(next.queued);
+        if (next.control.event)
+            controls.append(next.control);
+    }
+
+    // with no connection the batch is simply dropped
+    if (batch.isEmpty() || !m_sock ||
+        QAbstractSocket::ConnectedState != m_sock->state())
+        return;
+
+    if (m_sock->write(batch) != batch.size())
+    {
+        Logger::err("NetworkDevice: failed to write %1 packets (%2 bytes)\n",
+                queued.size(), batch.size());
+        return;
+    }
+    m_sock->flush();
+
+    uint64_t now = MonotonicMicros();
+    if (m_control_sink)
+    {
+        for (int i = 0; i < controls.size(); ++i)
+        {
+            controls[i].written = now;
+            m_control_sink->recordControl(controls[i]);
+        }
+    }
+
+    QMutexLocker lock(&m_stats_lock);
+    m_stats.bytes_out += batch.size();
+    m_stats.packets_out += queued.size();
+    m_stats.writes++;
+    m_stats.queue_depth = m_outbound.size();
+    for (int i = 0; i < queued.size(); ++i)
+        m_stats.write_latency.record(now - queued[i]);
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::onTelemetryTick()
+{
+    if (!writePacket(CLIENT_REQ_TELEMETRY))
+    {
+        Logger::err("NetworkDevice: failed to send telemetry request\n");
+    }
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::onVideoTick()
+{
+    if (!writePacket(CLIENT_REQ_MJPG_FRAME))
+    {
+        Logger::err("NetworkDevice: failed to send mjpg frame request\n");
+        return;
+    }
+
+    // frames answer polls in order, anything older than this is never coming
+    m_requests.enqueue(MonotonicMicros());
+    while (m_requests.size() > NETIO_REQUEST_DEPTH)
+        m_requests.dequeue();
+}
+
+// -----------------------------------------------------------------------------
+bool NetworkIO::publish(const InboundPacket &packet)
+{
+    if (!m_inbound.push(packet))
+        return false;
+
+    // wake the consumer once per batch rather than once per packet
+    if (m_notifyPending.testAndSetOrdered(0, 1))
+        emit packetsReady();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+PacketTiming NetworkIO::timePacket(const PacketView &view, uint64_t start)
+{
+    // reads wholly before this packet are of no further interest
+    while (!m_arrivals.isEmpty() && m_arrivals.head().first <= start)
+        m_arrivals.dequeue();
+
+    PacketTiming timing;
+    uint64_t end = start + view.length;
+    for (int i = 0; i < m_arrivals.size(); ++i)
+    {
+        if (!timing.first_byte)
+            timing.first_byte = m_arrivals[i].second;
+        if (m_arrivals[i].first >= end)
+        {
+            timing.last_byte = m_arrivals[i].second;
+            break;
+        }
+    }
+
+    if (SERVER_ACK_MJPG_FRAME == view.command() && !m_requests.isEmpty())
+        timing.requested = m_requests.dequeue();
+    return timing;
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::onSocketReadyRead()
+{
+    m_resumePending.fetchAndStoreOrdered(0);
+    if (!m_sock)
+        return;
+
+    // a packet left over from a full queue must go out before anything else
+    if (!m_stalled.data.isEmpty())
+    {
+        if (!publish(m_stalled))
+            return;
+        m_stalled = InboundPacket();
+        m_isStalled.fetchAndStoreRelease(0);
+    }
+
+    PacketView view;
+    uint64_t bytes = 0, packets = 0;
+    for (;;)
+    {
+        // hand out every complete packet already sitting in the framer
+        bool stalled = false;
+        uint64_t start = m_framer.readPosition();
+        while (m_framer.next(view))
+        {
+            ++packets;
+            PacketTiming timing = timePacket(view, start);
+            start = m_framer.readPosition();
+            if (m_handler)
+            {
+                // same thread as the consumer, no copy and no queue
+                m_handler->processPacket(view.words, timing);
+                if (!m_sock)
+                    return;
+                continue;
+            }
+
+            InboundPacket packet;
+            packet.data = QByteArray(view.bytes(), view.length);
+            packet.timing = timing;
+            if (!publish(packet))
+            {
+                // raise the flag before one last try: a consumer draining
+                // after this sees it and resumes us, one that drained before
+                // it has left room for the retry
+                m_isStalled.fetchAndStoreRelease(1);
+                if (publish(packet))
+                {
+                    m_isStalled.fetchAndStoreRelease(0);
+                    continue;
+                }
+
+                // consumer has fallen behind - leave the rest in the socket
+                // buffer until drained() asks us to resume
+                m_stalled = packet;
+                stalled = true;
+                break;
+            }
+        }
+
+        if (stalled)
+            break;
+
+        if (m_framer.error())
+        {
+            // a bad length means we've lost framing, nothing after it is
+            // trustworthy so drop the connection rather than guess
+            Logger::err("NetworkDevice: malformed packet, dropping connection\n");
+            m_framer.reset();
+            m_arrivals.clear();
+            m_sock->abort();
+            break;
+        }
+
+        // read straight into the framer's ring until the socket is empty
+        size_t avail;
+        char *dst = m_framer.prepare(avail);
+        qint64 count = m_sock->read(dst, avail);
+        if (count <= 0)
+            break;
+        m_framer.commit((size_t)count);
+        m_arrivals.enqueue(qMakePair(m_framer.writePosition(), MonotonicMicros()));
+        bytes += count;
+    }
+
+    // one update per batch keeps the lock off the per-packet path
+    countIn(bytes, packets);
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::onSocketConnected()
+{
+    // commands are tiny and latency sensitive, don't let nagle sit on them
+    m_sock->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    m_connected.fetchAndStoreRelease(1);
+    emit socketConnected();
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::onSocketDisconnected()
+{
+    m_connected.fetchAndStoreRelease(0);
+    stopPolling();
+    emit socketDisconnected();
+}
+
+// -----------------------------------------------------------------------------
+void NetworkIO::onSocketError(QAbstractSocket::SocketError error)
+{
+    m_connected.fetchAndStoreRelease(0);
+    stopPolling();
+    emit socketError(error);
+}
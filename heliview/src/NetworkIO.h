@@ -0,0 +1,147 @@
+// -----------------------------------------------------------------------------
+// File:    NetworkIO.h
+// Created: 10-17-2026
+//
+// Socket I/O worker for the network device. May live on the GUI thread or be
+// moved onto a dedicated network thread by its controller.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_NETWORKIO__H_
+#define _HELIVIEW_NETWORKIO__H_
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QMap>
+#include <QMutex>
+#include <QQueue>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+#include "ControlLatency.h"
+#include "LatencyHistogram.h"
+#include "PacketFramer.h"
+#include "SpscQueue.h"
+#include "Utility.h"
+
+#define NETIO_INBOUND_DEPTH     1024
+#define NETIO_OUTBOUND_DEPTH    256
+#define NETIO_REQUEST_DEPTH     16      // unanswered frame requests remembered
+
+// an outgoing packet and when it was handed to us
+struct OutboundPacket
+{
+    QByteArray    data;
+    uint64_t      queued;
+    uint32_t      sequence;     // order it was sent in, wraps
+    ControlTiming control;      // flight control only, event 0 otherwise
+};
+
+// an incoming packet on its way to a consumer on another thread
+struct InboundPacket
+{
+    QByteArray   data;
+    PacketTiming timing;
+};
+
+typedef SpscQueue<InboundPacket> PacketQueue;
+typedef SpscQueue<OutboundPacket> OutboundQueue;
+
+// running totals for one socket, read from any thread through stats()
+struct NetworkIOStats
+{
+    NetworkIOStats()
+    : bytes_in(0), bytes_out(0), packets_in(0), packets_out(0), writes(0),
+      superseded(0), queue_depth(0), queue_peak(0) { }
+
+    uint64_t bytes_in;
+    uint64_t bytes_out;
+    uint64_t packets_in;
+    uint64_t packets_out;
+    uint64_t writes;            // socket writes, each carrying a batch
+    uint64_t superseded;        // replaced by a newer packet before sending
+    int      queue_depth;       // outbound packets waiting after last flush
+    int      queue_peak;
+    LatencyHistogram write_latency; // enqueue to socket write, usec
+};
+
+class NetworkIO: public QObject
+{
+    Q_OBJECT
+
+public:
+    NetworkIO();
+    virtual ~NetworkIO();
+
+    // a packet sent with replace set supersedes any not yet written packet
+    // with the same command and goes out after everything sent before it,
+    // so commands from one thread are written in call order. replace goes
+    // through the locked m_latest and may come from any thread (the flight
+    // control loop uses it); anything else goes on the single producer
+    // m_outbound and must come from the thread that created this object,
+    // the controller's. a packet with a control timing has it completed
+    // and handed to the sink once it is written, superseded ones are never
+    // reported
+    bool enqueue(const QByteArray &packet, bool replace = false,
+            const ControlTiming *control = NULL);
+    bool dequeue(InboundPacket &packet);
+    bool drained();
+
+    bool isConnected() const;
+    NetworkIOStats stats() const;
+
+    // set before opening the socket; bypasses the inbound queue entirely
+    void setPacketHandler(PacketHandler *handler) { m_handler = handler; }
+    void setControlSink(ControlTimingSink *sink) { m_control_sink = sink; }
+
+public slots:
+    void connectSocket(const QString &address, int port);
+    void closeSocket();
+    void startPolling(int telem_ms, int video_ms);
+    void stopPolling();
+    void flushOutbound();
+
+    void onTelemetryTick();
+    void onVideoTick();
+    void onSocketConnected();
+    void onSocketReadyRead();
+    void onSocketDisconnected();
+    void onSocketError(QAbstractSocket::SocketError error);
+
+signals:
+    void packetsReady();
+    void socketConnected();
+    void socketDisconnected();
+    void socketError(QAbstractSocket::SocketError error);
+
+protected:
+    bool publish(const InboundPacket &packet);
+    PacketTiming timePacket(const PacketView &view, uint64_t start);
+    bool writePacket(uint32_t command);
+    void countIn(uint64_t bytes, uint64_t packets);
+    void countOut(uint64_t bytes, uint64_t packets);
+
+    QTcpSocket       *m_sock;
+    QTimer           *m_telem_timer;
+    QTimer           *m_mjpeg_timer;
+    PacketQueue       m_inbound;
+    OutboundQueue     m_outbound;
+    QMap<uint32_t, OutboundPacket> m_latest;
+    QMutex            m_latest_lock;
+    InboundPacket     m_stalled;
+    PacketFramer      m_framer;
+    QQueue<uint64_t>  m_requests;       // outstanding frame polls
+    QQueue<QPair<uint64_t, uint64_t> > m_arrivals; // (stream end, time) per read
+    QThread          *m_producer;       // the only thread on m_outbound
+    PacketHandler    *m_handler;
+    ControlTimingSink *m_control_sink;
+    NetworkIOStats    m_stats;
+    mutable QMutex    m_stats_lock;
+    QAtomicInt        m_connected;
+    QAtomicInt        m_notifyPending;
+    QAtomicInt        m_flushPending;
+    QAtomicInt        m_resumePending;
+    QAtomicInt        m_isStalled;      // m_stalled holds a packet
+    QAtomicInt        m_sequence;       // next OutboundPacket::sequence
+};
+
+#endif // _HELIVIEW_NETWORKIO__H_
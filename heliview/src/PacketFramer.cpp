@@ -0,0 +1,127 @@
+// -----------------------------------------------------------------------------
+// File:    PacketFramer.cpp
+// Created: 10-17-2026
+//
+// Streaming packet framer over a growable ring buffer. Socket data is read
+// straight into the ring and complete packets are handed out as views into it.
+// -----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstring>
+#include "PacketFramer.h"
+#include "uav_protocol.h"
+
+// -----------------------------------------------------------------------------
+uint32_t PacketView::command() const
+{
+    return words[PKT_COMMAND];
+}
+
+// -----------------------------------------------------------------------------
+PacketFramer::PacketFramer(uint32_t max_packet)
+: m_capacity(FRAMER_INITIAL_SIZE), m_read(0), m_write(0), m_need(0),
+  m_max_packet(max_packet), m_error(false)
+{
+    // the second half mirrors the start of the ring for wrapped packets
+    m_data.resize(2 * m_capacity);
+}
+
+// -----------------------------------------------------------------------------
+void PacketFramer::reset()
+{
+    m_read = m_write = 0;
+    m_need = 0;
+    m_error = false;
+}
+
+// -----------------------------------------------------------------------------
+uint32_t PacketFramer::peekWord(uint64_t position) const
+{
+    // header words can straddle the end of the ring
+    uint32_t word;
+    char *dst = (char *)&word;
+    for (int i = 0; i < 4; ++i)
+        dst[i] = m_data[(size_t)((position + i) & (m_capacity - 1))];
+    return word;
+}
+
+// -----------------------------------------------------------------------------
+char *PacketFramer::prepare(size_t &avail)
+{
+    // grow when full, or when the packet being waited on can't fit at all
+    size_t used = buffered();
+    if ((used == m_capacity) || (m_need > m_capacity))
+        grow(std::max(m_need, (size_t)m_capacity * 2));
+
+    size_t offset = (size_t)(m_write & (m_capacity - 1));
+    avail = std::min(m_capacity - buffered(), m_capacity - offset);
+    return &m_data[offset];
+}
+
+// -----------------------------------------------------------------------------
+void PacketFramer::commit(size_t count)
+{
+    m_write += count;
+}
+
+// -----------------------------------------------------------------------------
+bool PacketFramer::next(PacketView &view)
+{
+    size_t used = buffered();
+    if (m_error || (used < PKT_BASE_LENGTH))
+        return false;
+
+    uint32_t length = peekWord(m_read + PKT_LENGTH * sizeof(uint32_t));
+    if ((length < PKT_BASE_LENGTH) || (length > m_max_packet))
+    {
+        // the stream can't be trusted past this point
+        m_error = true;
+        return false;
+    }
+
+    if (used < length)
+    {
+        // remember how much room we need, prepare() grows if necessary
+        m_need = length;
+        return false;
+    }
+
+    size_t offset = (size_t)(m_read & (m_capacity - 1));
+    if (offset + length > m_capacity)
+    {
+        // the packet wraps, copy the wrapped part into the mirror area so
+        // the view is contiguous (only the tail of one packet per lap)
+        memcpy(&m_data[m_capacity], &m_data[0], offset + length - m_capacity);
+    }
+
+    view.words  = (const uint32_t *)&m_data[offset];
+    view.length = length;
+    m_read += length;
+    m_need = 0;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void PacketFramer::grow(size_t minimum)
+{
+    size_t capacity = m_capacity;
+    while (capacity < minimum)
+        capacity <<= 1;
+
+    // keep every byte at its absolute position, which in the bigger ring
+    // may wrap somewhere else. readPosition() and writePosition() carry on
+    // from where they were, so offsets taken before the grow stay good
+    std::vector<char> data(2 * capacity);
+    for (uint64_t position = m_read; position < m_write; )
+    {
+        size_t from = (size_t)(position & (m_capacity - 1));
+        size_t to = (size_t)(position & (capacity - 1));
+        size_t chunk = std::min((size_t)(m_write - position),
+                std::min(m_capacity - from, capacity - to));
+        memcpy(&data[to], &m_data[from], chunk);
+        position += chunk;
+    }
+
+    m_data.swap(data);
+    m_capacity = capacity;
+}
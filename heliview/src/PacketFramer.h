@@ -0,0 +1,84 @@
+// -----------------------------------------------------------------------------
+// File:    PacketFramer.h
+// Created: 10-17-2026
+//
+// Streaming packet framer over a growable ring buffer. Socket data is read
+// straight into the ring and complete packets are handed out as views into it.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_PACKETFRAMER__H_
+#define _HELIVIEW_PACKETFRAMER__H_
+
+#include <cstddef>
+#include <vector>
+#include "Utility.h"
+
+#define FRAMER_INITIAL_SIZE     (64 * 1024)
+#define FRAMER_MAX_PACKET       (1024 * 1024)
+
+// when an incoming packet arrived, MonotonicMicros(), 0 where not known
+struct PacketTiming
+{
+    PacketTiming() : requested(0), first_byte(0), last_byte(0) { }
+
+    uint64_t requested;     // the poll this answers (frames only)
+    uint64_t first_byte;    // read that brought the packet's first byte
+    uint64_t last_byte;     // read that completed it
+};
+
+// receives complete packets, which are only valid for the duration of the call
+class PacketHandler
+{
+public:
+    virtual ~PacketHandler() { }
+    virtual void processPacket(const uint32_t *packet,
+            const PacketTiming &timing) = 0;
+};
+
+// a complete packet (header included) that lives inside the framer's buffer.
+// views stay valid until the next call to prepare() on the owning framer.
+struct PacketView
+{
+    const uint32_t *words;
+    uint32_t        length;
+
+    uint32_t command() const;
+    const char *bytes() const { return (const char *)words; }
+};
+
+class PacketFramer
+{
+public:
+    PacketFramer(uint32_t max_packet = FRAMER_MAX_PACKET);
+
+    // writer side: get contiguous free space, fill it, then commit it
+    char *prepare(size_t &avail);
+    void commit(size_t count);
+
+    // reader side: pop the next complete packet, false if none (or error)
+    bool next(PacketView &view);
+
+    bool error() const { return m_error; }
+    size_t buffered() const { return (size_t)(m_write - m_read); }
+
+    // absolute stream offsets of the next packet and of the end of the data,
+    // they only go back to zero on reset(), never when the ring grows
+    uint64_t readPosition() const { return m_read; }
+    uint64_t writePosition() const { return m_write; }
+    size_t capacity() const { return m_capacity; }
+    void reset();
+
+protected:
+    void grow(size_t minimum);
+    uint32_t peekWord(uint64_t position) const;
+
+    std::vector<char> m_data;       // ring plus a mirror area of equal size
+    size_t            m_capacity;   // ring size, always a power of two
+    uint64_t          m_read;       // absolute stream positions
+    uint64_t          m_write;
+    size_t            m_need;       // length of an incomplete packet
+    uint32_t          m_max_packet;
+    bool              m_error;
+};
+
+#endif // _HELIVIEW_PACKETFRAMER__H_
@@ -0,0 +1,317 @@
+// -----------------------------------------------------------------------------
+// File:    ReplayDeviceController.cpp
+// Created: 10-17-2026
+//
+// Flight recording playback device implementation.
+// -----------------------------------------------------------------------------
+
+#include <QFileInfo>
+#include "Logger.h"
+#include "ReplayDeviceController.h"
+#include "TelemetryStore.h"
+#include "Utility.h"
+
+// -----------------------------------------------------------------------------
+ReplayDeviceController::ReplayDeviceController(const QString &device)
+: m_device(device), m_timer(NULL), m_slot(0), m_rec_anchor(0),
+  m_wall_anchor(0), m_last_report(0), m_played(0), m_speed(1.0),
+  m_paused(false), m_loop(false), m_state(STATE_DISCONNECTED),
+  m_axes(AXIS_ALL)
+{
+}
+
+// -----------------------------------------------------------------------------
+ReplayDeviceController::~ReplayDeviceController()
+{
+}
+
+// -----------------------------------------------------------------------------
+bool ReplayDeviceController::open()
+{
+    SafeDelete(m_timer);
+
+    DeviceOptions options;
+    m_path = ParseDeviceOptions(m_device, options);
+    if (m_path.isEmpty())
+    {
+        Logger::err("Replay: no recording given\n");
+        return false;
+    }
+
+    // the live recorder truncates its file when it opens, so the session in
+    // progress can't be played back from under it
+    FlightRecorder *recorder = FlightRecorder::instance();
+    if (recorder->isOpen() && QFileInfo(recorder->fileName()).canonicalFilePath()
+            == QFileInfo(m_path).canonicalFilePath())
+    {
+        Logger::err(tr("Replay: %1 is still being recorded, play a copy\n")
+                .arg(m_path));
+        return false;
+    }
+
+    if (!m_recording.open(m_path))
+        return false;
+
+    m_speed = 1.0;
+    if (options.contains("speed"))
+    {
+        bool ok = true;
+        QString speed = options.value("speed");
+        m_speed = (speed == "max") ? 0.0 : speed.toDouble(&ok);
+        if (!ok || m_speed < 0.0)
+        {
+            Logger::warn(tr("Replay: bad speed '%1', playing at 1x\n").arg(speed));
+            m_speed = 1.0;
+        }
+    }
+
+    m_loop = options.contains("loop");
+    m_paused = options.contains("paused");
+    m_state = STATE_AUTONOMOUS;
+    m_axes = AXIS_ALL;
+    m_slot = 0;
+
+    // graphs run on recording time, counted from the start of the flight
+    TelemetryStore::instance()->reset(m_recording.startTime());
+
+    m_timer = new QTimer(this);
+    connect(m_timer, SIGNAL(timeout()), this, SLOT(onReplayTick()));
+
+    Logger::info(tr("Replay: %1 records, %2 s of flight from %3\n")
+            .arg(m_recording.count()).arg(duration() / 1000.0).arg(m_path));
+
+    emit controlStateChanged(m_state);
+    emit connectionStatusChanged(QString("Replaying ") + m_path, true);
+
+    if (options.contains("start"))
+        seek((int)(options.value("start").toDouble() * 1000.0));
+
+    anchor();
+    if (!m_paused)
+        m_timer->start(m_speed > 0.0 ? REPLAY_TICK_MS : 0);
+    reportPosition(true);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void ReplayDeviceController::close()
+{
+    SafeDelete(m_timer);
+    m_recording.close();
+    m_state = STATE_DISCONNECTED;
+
+    emit controlStateChanged(m_state);
+    emit connectionStatusChanged(QString("Replay closed"), false);
+}
+
+// -----------------------------------------------------------------------------
+int ReplayDeviceController::duration() const
+{
+    return (int)((m_recording.endTime() - m_recording.startTime()) / 1000);
+}
+
+// -----------------------------------------------------------------------------
+int ReplayDeviceController::position() const
+{
+    if (m_slot >= m_recording.count())
+        return duration();
+    return (int)((m_recording.at(m_slot).timestamp -
+                  m_recording.startTime()) / 1000);
+}
+
+// -----------------------------------------------------------------------------
+void ReplayDeviceController::setPaused(bool paused)
+{
+    if (!m_timer || paused == m_paused)
+        return;
+
+    m_paused = paused;
+    if (m_paused)
+    {
+        m_timer->stop();
+        return;
+    }
+
+    // resuming at the end starts over
+    if (m_slot >= m_recording.count())
+        seek(0);
+
+    anchor();
+    m_timer->start(m_speed > 0.0 ? REPLAY_TICK_MS : 0);
+}
+
+// -----------------------------------------------------------------------------
+void ReplayDeviceController::setSpeed(double speed)
+{
+    m_speed = qMax(speed, 0.0);
+    anchor();
+    if (m_timer && m_timer->isActive())
+        m_timer->start(m_speed > 0.0 ? REPLAY_TICK_MS : 0);
+}
+
+// -----------------------------------------------------------------------------
+void ReplayDeviceController::seek(int msec)
+{
+    uint64_t offset = (uint64_t)qMax(msec, 0) * 1000;
+    m_slot = m_recording.seek(m_recording.startTime() + offset);
+
+    // the graphs pick up again from the new position, at its place on the
+    // flight's time axis rather than straight after what was shown before
+    TelemetryStore::instance()->reset(m_recording.startTime());
+    restoreState();
+    anchor();
+    reportPosition(true);
+}
+
+// -----------------------------------------------------------------------------
+void ReplayDeviceController::restoreState()
+{
+    // states are only recorded when they change, so after a jump the latest
+    // of each before the new position is played again. the scan back stops
+    // once all three are found, at worst it reads the mapped file once
+    const FlightRecord *control = NULL;
+    const FlightRecord *flight = NULL;
+    const FlightRecord *tracking = NULL;
+    for (uint64_t slot = m_slot; slot > 0 && !(control && flight && tracking);)
+    {
+        const FlightRecord &record = m_recording.at(--slot);
+        if (RECORD_CONTROL_STATE == record.type && !control)
+            control = &record;
+        else if (RECORD_FLIGHT_STATE == record.type && !flight)
+            flight = &record;
+        else if (RECORD_TRACKING == record.type && !tracking)
+            tracking = &record;
+    }
+
+    // before the first of them the replay is as it was when opened
+    if (control)
+    {
+        play(*control);
+    }
+    else
+    {
+        m_state = STATE_AUTONOMOUS;
+        m_axes = AXIS_ALL;
+        emit controlStateChanged(m_state);
+    }
+
+    if (flight)
+        play(*flight);
+
+    if (tracking)
+        play(*tracking);
+    else
+        emit trackStatusUpdate(false, QRect(), QPoint());
+}
+
+// -----------------------------------------------------------------------------
+void ReplayDeviceController::anchor()
+{
+    // playback time is measured from here, so pauses, seeks and speed
+    // changes never make it jump to catch up
+    m_wall_anchor = MonotonicMicros();
+    m_rec_anchor = (m_slot < m_recording.count()) ?
+            m_recording.at(m_slot).timestamp : m_recording.endTime();
+    m_played = 0;
+}
+
+// -----------------------------------------------------------------------------
+void ReplayDeviceController::onReplayTick()
+{
+    uint64_t count = m_recording.count();
+    uint64_t now = MonotonicMicros();
+
+    // as fast as possible plays fixed size batches, which keeps the sequence
+    // of signals per event loop turn identical from run to run
+    uint64_t target = (uint64_t)-1;
+    if (m_speed > 0.0)
+        target = m_rec_anchor + (uint64_t)((now - m_wall_anchor) * m_speed);
+
+    int batch = 0;
+    while (m_slot < count && batch < REPLAY_BATCH)
+    {
+        const FlightRecord &record = m_recording.at(m_slot);
+        if (record.timestamp > target)
+            break;
+
+        play(record);
+        ++m_slot;
+        ++batch;
+    }
+    m_played += batch;
+
+    if (m_slot < count)
+    {
+        reportPosition(false);
+        return;
+    }
+
+    uint64_t elapsed = qMax(now - m_wall_anchor, (uint64_t)1);
+    Logger::info(tr("Replay: played %1 records in %2 ms (%3 records/s)\n")
+            .arg(m_played).arg(elapsed / 1000.0)
+            .arg(m_played * 1000000.0 / elapsed, 0, 'f', 0));
+
+    if (m_loop)
+    {
+        seek(0);
+        return;
+    }
+
+    m_paused = true;
+    m_timer->stop();
+    reportPosition(true);
+    emit finished();
+}
+
+// -----------------------------------------------------------------------------
+void ReplayDeviceController::play(const FlightRecord &record)
+{
+    const char *frame;
+    QRect bbox;
+
+    switch (record.type)
+    {
+    case RECORD_TELEMETRY:
+        // stamped when it was received in flight, not when it is replayed,
+        // so the graphs show the flight's own timing at any speed
+        emit telemetryReady(record.telemetry.yaw, record.telemetry.pitch,
+                record.telemetry.roll, record.telemetry.alt,
+                record.telemetry.rssi, record.telemetry.batt,
+                record.telemetry.aux, record.telemetry.cpu, record.timestamp);
+        break;
+    case RECORD_FRAME:
+        frame = m_recording.frame(record);
+        if (frame)
+            emit videoFrameReady(frame, (size_t)record.frame.length,
+                                 FrameTiming());
+        break;
+    case RECORD_CONTROL_STATE:
+        m_state = (DeviceState)record.state.value;
+        m_axes = record.state.axes;
+        emit controlStateChanged(record.state.value);
+        break;
+    case RECORD_FLIGHT_STATE:
+        emit flightStateChanged(record.state.value);
+        break;
+    case RECORD_TRACKING:
+        bbox.setCoords(record.tracking.x1, record.tracking.y1,
+                       record.tracking.x2, record.tracking.y2);
+        emit trackStatusUpdate(0 != record.tracking.enabled, bbox,
+                QPoint(record.tracking.xc, record.tracking.yc));
+        break;
+    default:
+        // index records only exist for seeking
+        break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void ReplayDeviceController::reportPosition(bool force)
+{
+    uint64_t now = MonotonicMicros();
+    if (!force && now - m_last_report < REPLAY_POSITION_MS * 1000)
+        return;
+
+    m_last_report = now;
+    emit positionChanged(position(), duration());
+}
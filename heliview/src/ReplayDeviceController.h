@@ -0,0 +1,75 @@
+// -----------------------------------------------------------------------------
+// File:    ReplayDeviceController.h
+// Created: 10-17-2026
+//
+// Plays a flight recording back through the usual device controller signals,
+// in real time, sped up, or as fast as the GUI will take it.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_REPLAYDEVICECONTROLLER__H_
+#define _HELIVIEW_REPLAYDEVICECONTROLLER__H_
+
+#include <QTimer>
+#include "DeviceController.h"
+#include "FlightRecorder.h"
+
+#define REPLAY_TICK_MS          5       // pacing timer for timed playback
+#define REPLAY_BATCH            512     // records per tick before yielding
+#define REPLAY_POSITION_MS      100     // positionChanged() rate limit
+
+class ReplayDeviceController: public DeviceController
+{
+    Q_OBJECT
+
+public:
+    ReplayDeviceController(const QString &device);
+    virtual ~ReplayDeviceController();
+
+    virtual bool open();
+    virtual void close();
+
+    virtual QString device() const { return m_device; }
+    virtual QString controllerType() const { return QString("replay"); }
+    virtual DeviceState currentState() const { return m_state; }
+    virtual int currentAxes() const { return m_axes; }
+
+    bool isPaused() const { return m_paused; }
+    double speed() const { return m_speed; }
+    int duration() const;
+    int position() const;
+
+public slots:
+    void setPaused(bool paused);
+    void setSpeed(double speed);
+    void seek(int msec);
+
+signals:
+    void positionChanged(int msec, int duration);
+    void finished();
+
+protected slots:
+    void onReplayTick();
+
+protected:
+    void anchor();
+    void restoreState();
+    void play(const FlightRecord &record);
+    void reportPosition(bool force);
+
+    QString         m_device;
+    QString         m_path;
+    FlightRecording m_recording;
+    QTimer         *m_timer;
+    uint64_t        m_slot;         // next record to play
+    uint64_t        m_rec_anchor;   // recording time at m_wall_anchor
+    uint64_t        m_wall_anchor;  // MonotonicMicros() when last re-timed
+    uint64_t        m_last_report;
+    uint64_t        m_played;       // records played since the last anchor
+    double          m_speed;        // 0 = as fast as possible
+    bool            m_paused;
+    bool            m_loop;
+    DeviceState     m_state;
+    int             m_axes;
+};
+
+#endif // _HELIVIEW_REPLAYDEVICECONTROLLER__H_
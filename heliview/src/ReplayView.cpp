@@ -0,0 +1,130 @@
+// -----------------------------------------------------------------------------
+// File:    ReplayView.cpp
+// Created: 10-17-2026
+//
+// Transport controls (pause, speed, position) for a replay device.
+// -----------------------------------------------------------------------------
+
+#include <QHBoxLayout>
+#include "ReplayView.h"
+
+// -----------------------------------------------------------------------------
+ReplayView::ReplayView(QWidget *parent)
+: QWidget(parent)
+{
+    m_pause = new QToolButton(this);
+    m_pause->setCheckable(true);
+    m_pause->setText("Pause");
+
+    // speeds are multiples of real time, zero plays as fast as possible
+    m_speed = new QComboBox(this);
+    m_speed->addItem("1x", 1.0);
+    m_speed->addItem("10x", 10.0);
+    m_speed->addItem("Max", 0.0);
+
+    m_position = new QSlider(Qt::Horizontal, this);
+    m_position->setMinimumWidth(200);
+    m_position->setRange(0, 0);
+
+    m_time = new QLabel(this);
+
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_pause);
+    layout->addWidget(m_speed);
+    layout->addWidget(m_position, 1);
+    layout->addWidget(m_time);
+
+    connect(m_pause, SIGNAL(toggled(bool)), this, SLOT(onPauseToggled(bool)));
+    connect(m_speed, SIGNAL(currentIndexChanged(int)), this,
+            SLOT(onSpeedChanged(int)));
+    connect(m_position, SIGNAL(sliderReleased()), this,
+            SLOT(onSliderReleased()));
+    connect(m_position, SIGNAL(actionTriggered(int)), this,
+            SLOT(onSliderAction(int)));
+
+    setPosition(0, 0);
+}
+
+// -----------------------------------------------------------------------------
+ReplayView::~ReplayView()
+{
+}
+
+// -----------------------------------------------------------------------------
+void ReplayView::setPaused(bool paused)
+{
+    m_pause->blockSignals(true);
+    m_pause->setChecked(paused);
+    m_pause->setText(paused ? "Play" : "Pause");
+    m_pause->blockSignals(false);
+}
+
+// -----------------------------------------------------------------------------
+void ReplayView::setSpeed(double speed)
+{
+    int index = m_speed->findData(speed);
+    if (index < 0)
+    {
+        m_speed->addItem(QString("%1x").arg(speed), speed);
+        index = m_speed->count() - 1;
+    }
+
+    m_speed->blockSignals(true);
+    m_speed->setCurrentIndex(index);
+    m_speed->blockSignals(false);
+}
+
+// -----------------------------------------------------------------------------
+void ReplayView::setPosition(int msec, int duration)
+{
+    // don't yank the handle out from under the user
+    if (!m_position->isSliderDown())
+    {
+        m_position->setRange(0, duration);
+        m_position->setValue(msec);
+    }
+    m_time->setText(formatTime(msec) + " / " + formatTime(duration));
+}
+
+// -----------------------------------------------------------------------------
+void ReplayView::onFinished()
+{
+    setPaused(true);
+}
+
+// -----------------------------------------------------------------------------
+void ReplayView::onPauseToggled(bool paused)
+{
+    m_pause->setText(paused ? "Play" : "Pause");
+    emit pausedChanged(paused);
+}
+
+// -----------------------------------------------------------------------------
+void ReplayView::onSpeedChanged(int index)
+{
+    emit speedChanged(m_speed->itemData(index).toDouble());
+}
+
+// -----------------------------------------------------------------------------
+void ReplayView::onSliderReleased()
+{
+    emit seekRequested(m_position->value());
+}
+
+// -----------------------------------------------------------------------------
+void ReplayView::onSliderAction(int action)
+{
+    // drags seek once on release, clicks and keys seek straight away
+    if (QAbstractSlider::SliderMove != action)
+        emit seekRequested(m_position->sliderPosition());
+}
+
+// -----------------------------------------------------------------------------
+QString ReplayView::formatTime(int msec)
+{
+    int seconds = msec / 1000;
+    return QString("%1:%2:%3").arg(seconds / 3600)
+            .arg((seconds / 60) % 60, 2, 10, QChar('0'))
+            .arg(seconds % 60, 2, 10, QChar('0'));
+}
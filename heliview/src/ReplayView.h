@@ -0,0 +1,51 @@
+// -----------------------------------------------------------------------------
+// File:    ReplayView.h
+// Created: 10-17-2026
+//
+// Transport controls (pause, speed, position) for a replay device.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_REPLAYVIEW__H_
+#define _HELIVIEW_REPLAYVIEW__H_
+
+#include <QComboBox>
+#include <QLabel>
+#include <QSlider>
+#include <QToolButton>
+#include <QWidget>
+
+class ReplayView: public QWidget
+{
+    Q_OBJECT
+
+public:
+    ReplayView(QWidget *parent);
+    virtual ~ReplayView();
+
+public slots:
+    void setPaused(bool paused);
+    void setSpeed(double speed);
+    void setPosition(int msec, int duration);
+    void onFinished();
+
+signals:
+    void pausedChanged(bool paused);
+    void speedChanged(double speed);
+    void seekRequested(int msec);
+
+protected slots:
+    void onPauseToggled(bool paused);
+    void onSpeedChanged(int index);
+    void onSliderReleased();
+    void onSliderAction(int action);
+
+protected:
+    static QString formatTime(int msec);
+
+    QToolButton *m_pause;
+    QComboBox   *m_speed;
+    QSlider     *m_position;
+    QLabel      *m_time;
+};
+
+#endif // _HELIVIEW_REPLAYVIEW__H_
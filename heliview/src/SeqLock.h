@@ -0,0 +1,72 @@
+// -----------------------------------------------------------------------------
+// File:    SeqLock.h
+// Created: 10-17-2026
+//
+// Lock-free latest value, one writer and any number of readers.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_SEQLOCK__H_
+#define _HELIVIEW_SEQLOCK__H_
+
+#include <QAtomicInt>
+
+// -----------------------------------------------------------------------------
+// Holds the most recent T (plain data only). The writer bumps the sequence to
+// odd, copies the value in and bumps it back to even; a reader copies the value
+// out and retries if the sequence was odd or moved underneath it. Neither side
+// ever waits on the other, a reader only repeats a copy that raced a store.
+template <typename T>
+class SeqLock
+{
+public:
+    SeqLock() : m_sequence(0), m_value() { }
+
+    // writer thread only
+    void store(const T &value);
+
+    // false until the first store
+    bool load(T &value) const;
+
+    // changes with every store, a cheap "anything new?" for pollers
+    int sequence() const { return loadOrdered(m_sequence) >> 1; }
+
+protected:
+    static int loadOrdered(const QAtomicInt &value)
+    { return const_cast<QAtomicInt &>(value).fetchAndAddOrdered(0); }
+
+    mutable QAtomicInt m_sequence;
+    T                  m_value;
+
+private:
+    SeqLock(const SeqLock &);
+    SeqLock &operator=(const SeqLock &);
+};
+
+// -----------------------------------------------------------------------------
+template <typename T>
+void SeqLock<T>::store(const T &value)
+{
+    m_sequence.fetchAndAddOrdered(1);
+    m_value = value;
+    m_sequence.fetchAndAddOrdered(1);
+}
+
+// -----------------------------------------------------------------------------
+template <typename T>
+bool SeqLock<T>::load(T &value) const
+{
+    for (;;)
+    {
+        int before = loadOrdered(m_sequence);
+        if (0 == before)
+            return false;
+        if (before & 1)
+            continue;
+
+        value = m_value;
+        if (loadOrdered(m_sequence) == before)
+            return true;
+    }
+}
+
+#endif // _HELIVIEW_SEQLOCK__H_
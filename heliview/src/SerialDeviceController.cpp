@@ -6,55 +6,442 @@
 // Serial device interface implementation.
 // -----------------------------------------------------------------------------
 
-#include <iostream>
-#include <QDebug>
+#include <QMutexLocker>
+#include "FlightRecorder.h"
 #include "Logger.h"
 #include "SerialDeviceController.h"
 #include "Utility.h"
+#include "uav_protocol_ext.h"
+
+#ifdef PLATFORM_UNIX_GCC
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
 
 using namespace std;
 
 const char * SerialDeviceController::m_description = "Serial description";
 const bool SerialDeviceController::m_takesDevice = true;
 
+static const char SERIAL_PREFIX[] = "ANG:";
+
+static const double POW10[SERIAL_MAX_DIGITS + 1] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9
+};
+
+#ifdef PLATFORM_UNIX_GCC
+struct BaudRate
+{
+    int     baud;
+    speed_t speed;
+};
+
+// the rates above 115200 aren't POSIX, only offer what the system defines
+static const BaudRate BAUD_RATES[] =
+{
+    { 9600,    B9600 },
+    { 19200,   B19200 },
+    { 38400,   B38400 },
+    { 57600,   B57600 },
+    { 115200,  B115200 },
+#ifdef B230400
+    { 230400,  B230400 },
+#endif
+#ifdef B460800
+    { 460800,  B460800 },
+#endif
+#ifdef B500000
+    { 500000,  B500000 },
+#endif
+#ifdef B576000
+    { 576000,  B576000 },
+#endif
+#ifdef B921600
+    { 921600,  B921600 },
+#endif
+#ifdef B1000000
+    { 1000000, B1000000 },
+#endif
+#ifdef B1500000
+    { 1500000, B1500000 },
+#endif
+#ifdef B2000000
+    { 2000000, B2000000 },
+#endif
+};
+#else
+struct BaudRate
+{
+    int          baud;
+    BaudRateType speed;
+};
+
+static const BaudRate BAUD_RATES[] =
+{
+    { 9600,    BAUD9600 },
+    { 19200,   BAUD19200 },
+    { 38400,   BAUD38400 },
+    { 57600,   BAUD57600 },
+    { 115200,  BAUD115200 },
+#ifdef Q_OS_WIN
+    { 128000,  BAUD128000 },
+    { 256000,  BAUD256000 },
+#endif
+};
+#endif
+
 // -----------------------------------------------------------------------------
-SerialDeviceController::SerialDeviceController(const QString &device)
-: m_device(device), m_serial(NULL), m_buffer(1024, 0), m_offset(0)
+static const BaudRate *FindBaudRate(int baud)
 {
+    for (size_t i = 0; i < sizeof(BAUD_RATES) / sizeof(BAUD_RATES[0]); ++i)
+    {
+        if (BAUD_RATES[i].baud == baud)
+            return &BAUD_RATES[i];
+    }
+    return NULL;
 }
 
 // -----------------------------------------------------------------------------
-SerialDeviceController::~SerialDeviceController()
+SerialParser::SerialParser()
+: m_errors(0)
 {
-    close();
+    reset();
 }
 
 // -----------------------------------------------------------------------------
-bool SerialDeviceController::open()
+void SerialParser::reset()
+{
+    m_state = PARSE_IDLE;
+    m_length = 0;
+    m_prefix = 0;
+    m_field = 0;
+    beginNumber();
+}
+
+// -----------------------------------------------------------------------------
+bool SerialParser::feed(char c, SerialSample &sample)
+{
+    // '!' always starts a new line, whatever was in progress is lost
+    if ('!' == c)
+    {
+        if (PARSE_IDLE != m_state)
+            ++m_errors;
+        reset();
+        m_state = PARSE_PREFIX;
+        return false;
+    }
+
+    if (PARSE_IDLE == m_state)
+        return false;
+
+    if (++m_length > SERIAL_MAX_LINE)
+        return fail();
+
+    switch (m_state)
+    {
+    case PARSE_PREFIX:
+        if (c != SERIAL_PREFIX[m_prefix])
+            return fail();
+        if (++m_prefix == (int)sizeof(SERIAL_PREFIX) - 1)
+            m_state = PARSE_NUMBER;
+        return false;
+
+    case PARSE_NUMBER:
+        if (c >= '0' && c <= '9')
+        {
+            m_seen = true;
+            if (0 == m_mantissa && '0' == c && !m_fraction)
+                return false;   // leading zeros carry nothing
+
+            if (m_digits < SERIAL_MAX_DIGITS)
+            {
+                m_mantissa = m_mantissa * 10 + (c - '0');
+                ++m_digits;
+                if (m_fraction)
+                    ++m_scale;
+            }
+            else if (!m_fraction)
+            {
+                ++m_overflow;
+            }
+            return false;
+        }
+
+        switch (c)
+        {
+        case '-':
+        case '+':
+            if (m_signed || m_seen || m_fraction)
+                return fail();
+            m_signed = true;
+            m_negative = ('-' == c);
+            return false;
+        case '.':
+            if (m_fraction)
+                return fail();
+            m_fraction = true;
+            return false;
+        case ',':
+            if (m_field >= 2 || !endNumber())
+                return fail();
+            ++m_field;
+            beginNumber();
+            return false;
+        case '\r':
+        case '\n':
+            if (m_field != 2 || !endNumber())
+                return fail();
+            if ('\r' == c)
+            {
+                m_state = PARSE_END;
+                return false;
+            }
+            break;
+        default:
+            return fail();
+        }
+        break;
+
+    case PARSE_END:
+        if ('\n' != c)
+            return fail();
+        break;
+
+    default:
+        return fail();
+    }
+
+    // a complete line, the razor firmware prints roll, pitch, yaw
+    sample.x = m_values[0];
+    sample.y = m_values[1];
+    sample.z = m_values[2];
+    reset();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool SerialParser::fail()
+{
+    ++m_errors;
+    reset();
+    return false;
+}
+
+// -----------------------------------------------------------------------------
+void SerialParser::beginNumber()
+{
+    m_signed = false;
+    m_negative = false;
+    m_seen = false;
+    m_fraction = false;
+    m_mantissa = 0;
+    m_digits = 0;
+    m_scale = 0;
+    m_overflow = 0;
+}
+
+// -----------------------------------------------------------------------------
+bool SerialParser::endNumber()
+{
+    if (!m_seen)
+        return false;
+
+    double value = m_mantissa / POW10[m_scale];
+    for (int i = 0; i < m_overflow; ++i)
+        value *= 10.0;
+
+    m_values[m_field] = (float)(m_negative ? -value : value);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+SerialReaderThread::SerialReaderThread(const QString &port, int baud,
+        bool binary)
+: m_port(port), m_baud(baud), m_binary(binary),
+#ifdef PLATFORM_UNIX_GCC
+  m_fd(-1),
+#else
+  m_serial(NULL),
+#endif
+  m_framer(SERIAL_MAX_PACKET), m_samples(SERIAL_QUEUE_DEPTH),
+  m_packets(SERIAL_PACKET_DEPTH), m_notifyPending(0), m_errors(0),
+  m_crc_errors(0), m_dropped(0), m_write_errors(0), m_active(1),
+  m_failed(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+SerialReaderThread::~SerialReaderThread()
 {
-    // make sure to close if there's a device currently open
     close();
-    qDebug() << "creating serial device" << m_device;
-    Logger::info(QString("SDC: creating serial device\n"));
+}
+
+#ifdef PLATFORM_UNIX_GCC
+// -----------------------------------------------------------------------------
+bool SerialReaderThread::open()
+{
+    const BaudRate *rate = FindBaudRate(m_baud);
+    if (!rate)
+    {
+        Logger::err(tr("SerialDevice: unsupported baud rate %1\n").arg(m_baud));
+        return false;
+    }
 
-    m_serial = new QextSerialPort(m_device, QextSerialPort::EventDriven);
-    m_serial->setBaudRate(BAUD57600);
+    QByteArray path = m_port.toLocal8Bit();
+    int mode = m_binary ? O_RDWR : O_RDONLY;
+    m_fd = ::open(path.constData(), mode | O_NOCTTY | O_NONBLOCK);
+    if (m_fd < 0)
+    {
+        Logger::err(tr("SerialDevice: failed to open %1: %2\n")
+                .arg(m_port).arg(strerror(errno)));
+        return false;
+    }
+
+    // raw 8N1, no flow control. reads never wait, poll() does the blocking
+    struct termios tio;
+    if (tcgetattr(m_fd, &tio) < 0)
+    {
+        Logger::err(tr("SerialDevice: %1 is not a tty\n").arg(m_port));
+        close();
+        return false;
+    }
+
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~CSTOPB;
+#ifdef CRTSCTS
+    tio.c_cflag &= ~CRTSCTS;
+#endif
+    tio.c_cc[VMIN] = 0;
+    tio.c_cc[VTIME] = 0;
+    cfsetispeed(&tio, rate->speed);
+    cfsetospeed(&tio, rate->speed);
+
+    if (tcsetattr(m_fd, TCSANOW, &tio) < 0)
+    {
+        Logger::err(tr("SerialDevice: failed to configure %1 at %2 baud\n")
+                .arg(m_port).arg(m_baud));
+        close();
+        return false;
+    }
+
+    // whatever sat in the driver from before is stale
+    tcflush(m_fd, TCIFLUSH);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void SerialReaderThread::close()
+{
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void SerialReaderThread::run()
+{
+    char buffer[SERIAL_READ_SIZE];
+    struct pollfd pfd;
+    pfd.fd = m_fd;
+    pfd.events = POLLIN;
+
+    while (m_active.fetchAndAddAcquire(0))
+    {
+        int rc = poll(&pfd, 1, SERIAL_POLL_MS);
+        if (rc < 0 && EINTR != errno)
+        {
+            Logger::err(tr("SerialDevice: poll failed: %1\n").arg(strerror(errno)));
+            break;
+        }
+        else if (rc <= 0)
+        {
+            continue;
+        }
+
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL))
+        {
+            Logger::err(tr("SerialDevice: lost %1\n").arg(m_port));
+            break;
+        }
+
+        // everything in this read arrived by now, it's the best stamp we have
+        ssize_t length = read(m_fd, buffer, sizeof(buffer));
+        uint64_t now = MonotonicMicros();
+        if (length < 0 && EAGAIN != errno && EINTR != errno)
+        {
+            Logger::err(tr("SerialDevice: read failed: %1\n").arg(strerror(errno)));
+            break;
+        }
+        else if (length > 0 && m_binary)
+        {
+            decode(buffer, (int)length, now);
+        }
+        else if (length > 0)
+        {
+            parse(buffer, (int)length, now);
+        }
+    }
+    notifyFailed();
+}
+
+// -----------------------------------------------------------------------------
+bool SerialReaderThread::write(const char *data, int length)
+{
+    // a frame cut short is dropped by the far end at our next delimiter, so
+    // never wait on a full line, just count what didn't fit
+    while (length > 0)
+    {
+        ssize_t written = ::write(m_fd, data, length);
+        if (written < 0 && EINTR == errno)
+            continue;
+        if (written <= 0)
+        {
+            m_write_errors.ref();
+            return false;
+        }
+        data += written;
+        length -= (int)written;
+    }
+    return true;
+}
+#else
+// -----------------------------------------------------------------------------
+bool SerialReaderThread::open()
+{
+    const BaudRate *rate = FindBaudRate(m_baud);
+    if (!rate)
+    {
+        Logger::err(tr("SerialDevice: unsupported baud rate %1\n").arg(m_baud));
+        return false;
+    }
+
+    // polled from the reader thread, no events to be delivered anywhere
+    m_serial = new QextSerialPort(m_port, QextSerialPort::Polling);
+    m_serial->setBaudRate(rate->speed);
     m_serial->setDataBits(DATA_8);
     m_serial->setParity(PAR_NONE);
     m_serial->setStopBits(STOP_1);
     m_serial->setFlowControl(FLOW_OFF);
 
-    connect(m_serial, SIGNAL(readyRead()), this, SLOT(onSerialDataReady()));
-
-    if (!m_serial->open(QIODevice::ReadOnly))
+    if (!m_serial->open(m_binary ? QIODevice::ReadWrite : QIODevice::ReadOnly))
+    {
+        Logger::err(tr("SerialDevice: failed to open %1\n").arg(m_port));
+        close();
         return false;
-
-    onSerialDataReady();
+    }
     return true;
 }
 
 // -----------------------------------------------------------------------------
-void SerialDeviceController::close()
+void SerialReaderThread::close()
 {
     if (m_serial)
     {
@@ -64,65 +451,363 @@ void SerialDeviceController::close()
 }
 
 // -----------------------------------------------------------------------------
-void SerialDeviceController::onSerialDataReady()
+void SerialReaderThread::run()
 {
-    int bytes_avail = m_serial->bytesAvailable();
-    if (!bytes_avail)
-        return;
-    
-    QByteArray data;
-    data.resize(bytes_avail);
-    m_serial->read(data.data(), data.size());
+    char buffer[SERIAL_READ_SIZE];
 
-    for (int i = 0; i < bytes_avail; i++)
+    while (m_active.fetchAndAddAcquire(0))
     {
-        switch (data[i])
+        qint64 length;
         {
-        case '!':
-            m_offset = 0;
-            m_validLine = true;
-            break;
-        case '\n':
-            m_buffer[m_offset - 1] = '\0';
-            if (m_validLine)
-            {
-                // only process complete lines
-                processSingleLine(&m_buffer[0]);
-                m_validLine = false;
-            }
-            m_offset = 0;
-            break;
-        default:
-            m_buffer[m_offset] = data[i];
-            m_offset++;
+            QMutexLocker locker(&m_serial_lock);
+            length = m_serial->read(buffer, sizeof(buffer));
+        }
+
+        uint64_t now = MonotonicMicros();
+        if (length < 0)
+        {
+            Logger::err(tr("SerialDevice: read failed on %1\n").arg(m_port));
             break;
         }
+        else if (0 == length)
+        {
+            msleep(SERIAL_IDLE_MS);
+        }
+        else if (m_binary)
+        {
+            decode(buffer, (int)length, now);
+        }
+        else
+        {
+            parse(buffer, (int)length, now);
+        }
     }
+    notifyFailed();
 }
 
 // -----------------------------------------------------------------------------
-void SerialDeviceController::processSingleLine(const string &line)
+bool SerialReaderThread::write(const char *data, int length)
 {
-    if (line[0] != 'A' || line[1] != 'N' || line[2] != 'G' || line[3] != ':')
+    QMutexLocker locker(&m_serial_lock);
+    if (m_serial->write(data, length) != length)
     {
-        cerr << "encountered invalid line (no prefix)\n";
+        m_write_errors.ref();
+        return false;
+    }
+    return true;
+}
+#endif
+
+// -----------------------------------------------------------------------------
+void SerialReaderThread::stop()
+{
+    m_active.fetchAndStoreRelease(0);
+}
+
+// -----------------------------------------------------------------------------
+void SerialReaderThread::notifyFailed()
+{
+    // the loop only ends while still active when the port failed, after a
+    // stop() the controller is already closing us
+    if (!m_active.fetchAndAddAcquire(0))
         return;
+
+    m_failed.fetchAndStoreRelease(1);
+    emit readFailed();
+}
+
+// -----------------------------------------------------------------------------
+void SerialReaderThread::parse(const char *data, int length, uint64_t timestamp)
+{
+    SerialSample sample;
+    bool queued = false;
+
+    for (int i = 0; i < length; ++i)
+    {
+        if (!m_parser.feed(data[i], sample))
+            continue;
+
+        sample.timestamp = timestamp;
+        if (m_samples.push(sample))
+            queued = true;
+        else
+            m_dropped.ref();
+    }
+    m_errors.fetchAndStoreRelease(m_parser.errors());
+
+    // one notification covers everything queued until the GUI gets to it
+    if (queued && m_notifyPending.testAndSetOrdered(0, 1))
+        emit samplesReady();
+}
+
+// -----------------------------------------------------------------------------
+void SerialReaderThread::decode(const char *data, int length, uint64_t timestamp)
+{
+    const char *end = data + length;
+    PacketView view;
+    bool queued = false;
+
+    while (m_framer.decode(data, end, view))
+    {
+        SerialPacket packet;
+        packet.data = QByteArray(view.bytes(), view.length);
+        packet.timing.last_byte = timestamp;
+        if (m_packets.push(packet))
+            queued = true;
+        else
+            m_dropped.ref();
     }
+    m_errors.fetchAndStoreRelease((int)m_framer.framingErrors());
+    m_crc_errors.fetchAndStoreRelease((int)m_framer.crcErrors());
 
-    QString str = QString::fromStdString(line.substr(4));
-    QStringList ssplit = str.split(",", QString::KeepEmptyParts);
-    if (ssplit.size() != 3)
+    if (queued && m_notifyPending.testAndSetOrdered(0, 1))
+        emit samplesReady();
+}
+
+// -----------------------------------------------------------------------------
+SerialDeviceController::SerialDeviceController(const QString &device)
+: m_device(device), m_reader(NULL), m_binary(false), m_telem_rate(15),
+  m_subscribed(false), m_telem_timer(NULL), m_errors(0), m_crc_errors(0),
+  m_dropped(0), m_write_errors(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+SerialDeviceController::~SerialDeviceController()
+{
+    close();
+}
+
+// -----------------------------------------------------------------------------
+bool SerialDeviceController::open()
+{
+    // make sure to close if there's a device currently open
+    close();
+
+    // "/dev/ttyUSB0,baud=921600,binary", the baud rate defaults to the razor's
+    m_options.clear();
+    QString port = ParseDeviceOptions(m_device, m_options);
+    int baud = SERIAL_DEFAULT_BAUD;
+    if (m_options.contains("baud"))
+        baud = m_options.value("baud").toInt();
+    if (m_options.contains("telem"))
+        m_telem_rate = qBound(1, m_options.value("telem").toInt(), 1000);
+    m_binary = m_options.contains("binary");
+
+    Logger::info(tr("SerialDevice: opening %1 at %2 baud, %3\n").arg(port)
+            .arg(baud).arg(m_binary ? "binary packets" : "razor text"));
+
+    m_reader = new SerialReaderThread(port, baud, m_binary);
+    if (!m_reader->open())
     {
-        cerr << "encountered invalid line (!= 3 numbers)\n";
+        SafeDelete(m_reader);
+        return false;
+    }
+
+    m_errors = 0;
+    m_crc_errors = 0;
+    m_dropped = 0;
+    m_write_errors = 0;
+    connect(m_reader, SIGNAL(samplesReady()), this, SLOT(onSamplesReady()));
+    connect(m_reader, SIGNAL(readFailed()), this, SLOT(onReadFailed()),
+            Qt::QueuedConnection);
+    m_reader->start();
+
+    if (m_binary)
+    {
+        // there's no connection to wait on. ask for telemetry until the
+        // vehicle identifies itself and says whether it can push instead
+        startControl(m_options);
+        m_subscribed = false;
+        m_telem_timer = new QTimer(this);
+        connect(m_telem_timer, SIGNAL(timeout()), this, SLOT(onTelemetryTick()));
+        m_telem_timer->start(1000 / m_telem_rate);
+
+        emit connectionStatusChanged(QString("Connected to ") + port, true);
+        emit flightStateChanged(FCS_STATE_GROUNDED);
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void SerialDeviceController::close()
+{
+    if (!m_reader)
         return;
+
+    if (m_binary)
+    {
+        // tell the vehicle to stop pushing before we let go of the port
+        if (m_subscribed)
+            subscribe(SUB_CHANNEL_TELEMETRY, 0);
+        m_subscribed = false;
+
+        m_telem_timer->stop();
+        SafeDelete(m_telem_timer);
+        stopControl();
     }
 
-    float x = ssplit[0].toFloat();
-    float y = ssplit[1].toFloat();
-    float z = ssplit[2].toFloat();
+    m_reader->stop();
+    m_reader->wait();
+    reportErrors(true);
+    SafeDelete(m_reader);
 
-    emit telemetryReady(z, y, x, 0, 200, 100, 1500, 0);
-    Logger::telemetry(tr("%1 %2 %3 %4 %5 %6 %7 %8\n").arg(z).arg(y).arg(x)
-                     .arg(0).arg(200).arg(100).arg(1500).arg(0));
+    if (m_binary)
+    {
+        emit connectionStatusChanged(m_device + " disconnected", false);
+        emit controlStateChanged(STATE_DISCONNECTED);
+    }
+}
+
+// -----------------------------------------------------------------------------
+bool SerialDeviceController::sendPacket(uint32_t *buffer, int length) const
+{
+    if (!m_reader || !m_binary)
+        return false;
+
+    // held across the write as well, so two frames never interleave
+    QMutexLocker locker(&m_frame_lock);
+    m_frame.clear();
+    SerialFramer::encode((const char *)buffer, length, m_frame);
+    return m_reader->write(&m_frame[0], (int)m_frame.size());
+}
+
+// -----------------------------------------------------------------------------
+void SerialDeviceController::onTelemetryTick()
+{
+    if (!sendPacket(CLIENT_REQ_TELEMETRY))
+        Logger::err("SerialDevice: failed to send telemetry request\n");
 }
 
+// -----------------------------------------------------------------------------
+void SerialDeviceController::processPacket(const uint32_t *packet,
+        const PacketTiming &timing)
+{
+    uint32_t cmd_buffer[16];
+    uint32_t caps = 0;
+
+    switch (packet[0])
+    {
+    case SERVER_REQ_IDENT:
+        Logger::info("SerialDevice: SERVER_REQ_IDENT: sending response...\n");
+        cmd_buffer[PKT_COMMAND]     = CLIENT_ACK_IDENT;
+        cmd_buffer[PKT_LENGTH]      = PKT_RCI_LENGTH;
+        cmd_buffer[PKT_RCI_MAGIC]   = IDENT_MAGIC;
+        cmd_buffer[PKT_RCI_VERSION] = IDENT_VERSION;
+        sendPacket(cmd_buffer, PKT_RCI_LENGTH);
+
+        if (packet[PKT_LENGTH] >= PKT_RCI_LENGTH)
+            caps = packet[PKT_RCI_VERSION] & IDENT_CAP_MASK;
+
+        // a pushed stream saves the requests, half the line in each direction
+        if ((caps & IDENT_CAP_SUBSCRIBE) && !m_options.contains("poll"))
+        {
+            Logger::info(tr("SerialDevice: subscribing to telemetry at %1 Hz\n")
+                    .arg(m_telem_rate));
+            m_subscribed = subscribe(SUB_CHANNEL_TELEMETRY, m_telem_rate);
+            if (m_subscribed)
+                m_telem_timer->stop();
+        }
+        enableControl(true);
+
+        onUpdateColorTrackEnable(2);   // Request Color Track Enable Status
+        onUpdateTrackControlEnable(2); // Request Track Control Enable Status
+        break;
+    default:
+        VehicleController::processPacket(packet, timing);
+        break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void SerialDeviceController::onReadFailed()
+{
+    // queued, so the reader may already have been closed (or replaced)
+    if (!m_reader || !m_reader->failed())
+        return;
+
+    // what arrived before the failure is still worth having
+    onSamplesReady();
+
+    Logger::err(tr("SerialDevice: %1 stopped responding, closing\n")
+            .arg(m_device));
+    close();
+    emit connectionStatusChanged(m_device + " lost", false);
+}
+
+// -----------------------------------------------------------------------------
+void SerialDeviceController::onSamplesReady()
+{
+    if (!m_reader)
+        return;
+
+    // cleared before draining, anything queued after this raises it again
+    m_reader->acknowledge();
+
+    if (m_binary)
+        drainPackets();
+    else
+        drainSamples();
+    reportErrors(false);
+}
+
+// -----------------------------------------------------------------------------
+void SerialDeviceController::drainSamples()
+{
+    SerialSample s;
+    while (m_reader->pop(s))
+    {
+        emit telemetryReady(s.z, s.y, s.x, 0, 200, 100, 1500, 0, s.timestamp);
+        FlightRecorder::telemetry(s.z, s.y, s.x, 0, 200, 100, 1500, 0);
+    }
+}
+
+// -----------------------------------------------------------------------------
+void SerialDeviceController::drainPackets()
+{
+    SerialPacket packet;
+    while (m_reader && m_reader->pop(packet))
+        processPacket((const uint32_t *)packet.data.constData(), packet.timing);
+}
+
+// -----------------------------------------------------------------------------
+void SerialDeviceController::reportErrors(bool summary)
+{
+    if (!m_reader)
+        return;
+
+    int errors = m_reader->errors();
+    int crc_errors = m_reader->crcErrors();
+    int dropped = m_reader->dropped();
+    int write_errors = m_reader->writeErrors();
+
+    if (summary && (errors || crc_errors || dropped || write_errors))
+    {
+        Logger::info(tr("SerialDevice: %1 malformed, %2 failed crc, "
+                    "%3 dropped, %4 not sent\n").arg(errors).arg(crc_errors)
+                .arg(dropped).arg(write_errors));
+        return;
+    }
+
+    // a noisy line shows up in the debug output, losing data is worth a warning
+    if (errors != m_errors || crc_errors != m_crc_errors)
+    {
+        Logger::dbg("SerialDevice: discarded %1 malformed, %2 corrupt\n",
+                errors - m_errors, crc_errors - m_crc_errors);
+    }
+    if (dropped != m_dropped)
+    {
+        Logger::warn(tr("SerialDevice: %1 dropped, the GUI fell behind\n")
+                .arg(dropped - m_dropped));
+    }
+    if (write_errors != m_write_errors)
+    {
+        Logger::warn(tr("SerialDevice: %1 packets not sent, the line is full\n")
+                .arg(write_errors - m_write_errors));
+    }
+
+    m_errors = errors;
+    m_crc_errors = crc_errors;
+    m_dropped = dropped;
+    m_write_errors = write_errors;
+}
@@ -3,18 +3,160 @@
 // Authors: Garrett Smith
 // Created: 08-24-2010
 //
-// Serial device interface declaration.
+// Serial device interface declaration. A reader thread blocks on the port and
+// decodes what arrives, which the controller hands on in batches from the GUI
+// thread. The port carries either the razor IMU's "!ANG:x,y,z" lines or, in
+// binary mode, the vehicle's packet set framed by SerialFramer.
 // -----------------------------------------------------------------------------
 
 #ifndef _HELIVIEW_SERIALDEVICECONTROLLER__H_
 #define _HELIVIEW_SERIALDEVICECONTROLLER__H_
 
-#include <string>
 #include <vector>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QMutex>
+#include <QThread>
+#include <QTimer>
+#include "SerialFramer.h"
+#include "SpscQueue.h"
+#include "Utility.h"
+#include "VehicleController.h"
+
+#ifndef PLATFORM_UNIX_GCC
 #include <qextserialport.h>
-#include "DeviceController.h"
+#endif
+
+#define SERIAL_DEFAULT_BAUD 57600
+#define SERIAL_READ_SIZE    4096    // bytes taken from the port per read
+#define SERIAL_MAX_LINE     64      // longest line the parser will accept
+#define SERIAL_MAX_DIGITS   9       // significant digits kept per number
+#define SERIAL_QUEUE_DEPTH  4096    // parsed samples waiting on the GUI
+#define SERIAL_PACKET_DEPTH 1024    // decoded packets waiting on the GUI
+#define SERIAL_MAX_PACKET   (64 * 1024)
+#define SERIAL_POLL_MS      100     // longest wait before checking for stop
+#define SERIAL_IDLE_MS      1       // sleep between polls of a qext port
+
+// one parsed line, stamped with the time the read that completed it returned
+struct SerialSample
+{
+    uint64_t timestamp;
+    float    x, y, z;
+};
 
-class SerialDeviceController: public DeviceController
+// a decoded packet, last_byte being when the read that completed it returned
+struct SerialPacket
+{
+    QByteArray   data;
+    PacketTiming timing;
+};
+
+// -----------------------------------------------------------------------------
+// Bounded state machine over the raw byte stream. A line is '!', "ANG:", three
+// comma separated decimals and a newline. Numbers are built as they are read,
+// nothing is copied or allocated. Anything unexpected throws the line away and
+// waits for the next '!', so a noisy line costs at most SERIAL_MAX_LINE bytes.
+class SerialParser
+{
+public:
+    SerialParser();
+
+    void reset();
+
+    // true and the sample filled in (all but its timestamp) when c ends a line
+    bool feed(char c, SerialSample &sample);
+
+    int errors() const { return m_errors; }
+
+protected:
+    enum State { PARSE_IDLE, PARSE_PREFIX, PARSE_NUMBER, PARSE_END };
+
+    bool fail();
+    void beginNumber();
+    bool endNumber();
+
+    State    m_state;
+    int      m_length;      // bytes of the current line so far
+    int      m_prefix;      // characters of "ANG:" matched
+    int      m_field;       // number being read, 0..2
+    float    m_values[3];
+    bool     m_signed;
+    bool     m_negative;
+    bool     m_seen;        // any digit yet
+    bool     m_fraction;    // past the point
+    uint32_t m_mantissa;
+    int      m_digits;      // significant digits in m_mantissa
+    int      m_scale;       // of those, how many follow the point
+    int      m_overflow;    // integer digits past SERIAL_MAX_DIGITS
+    int      m_errors;
+};
+
+// -----------------------------------------------------------------------------
+// Owns the port while the device is open. Reads as much as is waiting, decodes
+// it and queues the results, raising samplesReady() once per batch. Writes
+// come from the GUI thread and go straight to the port. If the port fails the
+// thread raises readFailed() on its way out.
+class SerialReaderThread: public QThread
+{
+    Q_OBJECT
+
+public:
+    SerialReaderThread(const QString &port, int baud, bool binary);
+    virtual ~SerialReaderThread();
+
+    bool open();
+    virtual void run();
+    virtual void stop();
+
+    // consumer side, GUI thread only
+    bool pop(SerialSample &sample) { return m_samples.pop(sample); }
+    bool pop(SerialPacket &packet) { return m_packets.pop(packet); }
+    void acknowledge() { m_notifyPending.fetchAndStoreOrdered(0); }
+    bool write(const char *data, int length);
+
+    int errors() const { return load(m_errors); }
+    int crcErrors() const { return load(m_crc_errors); }
+    int dropped() const { return load(m_dropped); }
+    int writeErrors() const { return load(m_write_errors); }
+    bool failed() const { return 0 != load(m_failed); }
+
+signals:
+    void samplesReady();
+    void readFailed();
+
+protected:
+    static int load(const QAtomicInt &value)
+    { return const_cast<QAtomicInt &>(value).fetchAndAddAcquire(0); }
+
+    void close();
+    void notifyFailed();
+    void parse(const char *data, int length, uint64_t timestamp);
+    void decode(const char *data, int length, uint64_t timestamp);
+
+    QString                  m_port;
+    int                      m_baud;
+    bool                     m_binary;
+#ifdef PLATFORM_UNIX_GCC
+    int                      m_fd;
+#else
+    QextSerialPort          *m_serial;
+    QMutex                   m_serial_lock; // reads and writes share the port
+#endif
+    SerialParser             m_parser;
+    SerialFramer             m_framer;
+    SpscQueue<SerialSample>  m_samples;
+    SpscQueue<SerialPacket>  m_packets;
+    QAtomicInt               m_notifyPending;
+    QAtomicInt               m_errors;      // lines or frames thrown away
+    QAtomicInt               m_crc_errors;  // frames that failed their crc
+    QAtomicInt               m_dropped;     // lost to a full queue
+    QAtomicInt               m_write_errors;
+    QAtomicInt               m_active;
+    QAtomicInt               m_failed;      // gave up on the port
+};
+
+// -----------------------------------------------------------------------------
+class SerialDeviceController: public VehicleController
 {
     Q_OBJECT
 
@@ -27,22 +169,38 @@ public:
 
     virtual QString device() const { return m_device; }
     virtual QString controllerType() const { return QString("serial"); }
-    
+
+    virtual void processPacket(const uint32_t *packet,
+            const PacketTiming &timing);
+
     static const char *m_description;
     static const bool m_takesDevice;
 
 public slots:
-    void onSerialDataReady();
+    void onSamplesReady();
+    void onReadFailed();
+    void onTelemetryTick();
 
 protected:
-    void processSingleLine(const std::string &line);
+    using VehicleController::sendPacket;
+    virtual bool sendPacket(uint32_t *buffer, int length) const;
+    void drainSamples();
+    void drainPackets();
+    void reportErrors(bool summary);
 
-    QString            m_device;
-    QextSerialPort    *m_serial;
-    std::vector<char>  m_buffer;
-    unsigned int       m_offset;
-    bool               m_validLine;
+    QString             m_device;
+    DeviceOptions       m_options;
+    SerialReaderThread *m_reader;
+    bool                m_binary;
+    int                 m_telem_rate;
+    bool                m_subscribed;
+    QTimer             *m_telem_timer;  // polls until the vehicle can push
+    mutable std::vector<char> m_frame;  // reused to encode outgoing packets
+    mutable QMutex      m_frame_lock;   // the control thread sends too
+    int                 m_errors;       // already reported
+    int                 m_crc_errors;
+    int                 m_dropped;
+    int                 m_write_errors;
 };
 
 #endif // _HELIVIEW_SERIALDEVICECONTROLLER__H_
-
@@ -0,0 +1,59 @@
+// -----------------------------------------------------------------------------
+// File:    SerialFramer.h
+// Created: 10-17-2026
+//
+// Framing for protocol packets on a byte stream with no error detection of its
+// own (a serial line or radio modem). Each packet is followed by its CRC-16,
+// COBS encoded so it contains no zero bytes, and sent between zero delimiters.
+// A damaged frame is dropped at the next delimiter and decoding carries on
+// from there, so corruption never costs more than the frame it hit.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_SERIALFRAMER__H_
+#define _HELIVIEW_SERIALFRAMER__H_
+
+#include <cstddef>
+#include <vector>
+#include "PacketFramer.h"
+#include "Utility.h"
+
+#define SERIAL_CRC_SIZE         2
+#define SERIAL_FRAME_DELIMITER  0
+
+// CRC-16/CCITT-FALSE (poly 0x1021, initial 0xFFFF)
+uint16_t SerialCrc16(const char *data, size_t length, uint16_t crc = 0xFFFF);
+
+class SerialFramer
+{
+public:
+    SerialFramer(uint32_t max_packet = FRAMER_MAX_PACKET);
+
+    // consume bytes from data up to end, stopping after the first good frame.
+    // true if one was found, it is in view until the next call
+    bool decode(const char *&data, const char *end, PacketView &view);
+
+    // append the framed packet to out, delimiters included
+    static void encode(const char *packet, size_t length, std::vector<char> &out);
+
+    void reset();
+
+    uint64_t frames() const { return m_frames; }
+    uint64_t crcErrors() const { return m_crc_errors; }
+    uint64_t framingErrors() const { return m_framing_errors; }
+
+protected:
+    bool endFrame(PacketView &view);
+    void append(char c);
+
+    std::vector<uint32_t> m_data;       // words, so a packet's view is aligned
+    size_t                m_size;       // decoded bytes of the current frame
+    size_t                m_max_size;   // largest packet plus its crc
+    int                   m_code;       // code byte of the current block
+    int                   m_remaining;  // data bytes left in the block
+    bool                  m_overflow;   // frame too long, skip to delimiter
+    uint64_t              m_frames;
+    uint64_t              m_crc_errors;
+    uint64_t              m_framing_errors;
+};
+
+#endif // _HELIVIEW_SERIALFRAMER__H_
@@ -12,6 +12,7 @@
 #include <QComboBox>
 #include "SettingsDialog.h"
 #include "DeviceController.h"
+#include "FlightRecorder.h"
 #include "Logger.h"
 #include "uav_protocol.h"
 
@@ -42,6 +43,15 @@ SettingsDialog::SettingsDialog(QWidget *pp, bool track_en, bool track_btn_en,
     connect(btnApply, SIGNAL(released()), this, SLOT(onApplyClicked()));
     connect(btnNewColor, SIGNAL(released()), this, SLOT(onNewColorClicked()));
 
+    // thresholds are previewed on the video as they're edited, the device
+    // only hears about them on apply
+    connect(sbR, SIGNAL(valueChanged(int)), this, SLOT(onTrackValueChanged()));
+    connect(sbG, SIGNAL(valueChanged(int)), this, SLOT(onTrackValueChanged()));
+    connect(sbB, SIGNAL(valueChanged(int)), this, SLOT(onTrackValueChanged()));
+    connect(sbHt, SIGNAL(valueChanged(int)), this, SLOT(onTrackValueChanged()));
+    connect(sbSt, SIGNAL(valueChanged(int)), this, SLOT(onTrackValueChanged()));
+    connect(sbFt, SIGNAL(valueChanged(int)), this, SLOT(onTrackValueChanged()));
+
     // assign specified color and threshold values to dialog widgets
     /*
     sbR->setValue(track.color.red());
@@ -249,7 +259,15 @@ void SettingsDialog::onApplyClicked()
     emit trackSettingsChanged(sbR->value(), sbG->value(), sbB->value(),
             sbHt->value(), sbSt->value(), sbFt->value(),sbTrackingFps->value());
 
-    emit logSettingsChanged(editLogFileName->text(), tr("telemetry.log"), sbLogBuffer->value());
+    emit logSettingsChanged(editLogFileName->text(),
+            FlightRecorder::defaultPath(), sbLogBuffer->value());
+}
+
+// -----------------------------------------------------------------------------
+void SettingsDialog::onTrackValueChanged()
+{
+    emit trackPreviewChanged(sbR->value(), sbG->value(), sbB->value(),
+            sbHt->value(), sbSt->value(), sbFt->value(), -1);
 }
 
 // -----------------------------------------------------------------------------
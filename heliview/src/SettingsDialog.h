@@ -25,6 +25,7 @@ public:
 signals:
     void updateColorTrackEnable(int track_en);
     void trackSettingsChanged(int r, int g, int b, int ht, int st, int ft, int fps);
+    void trackPreviewChanged(int r, int g, int b, int ht, int st, int ft, int fps);
     void logSettingsChanged(const QString &, const QString &, int);
     void deviceControlChanged(int id, int value);
     void trimSettingsChanged(int axis, int value);
@@ -56,6 +57,7 @@ public slots:
     void onApplyClicked();
     void onNewColorClicked();
     void onColorTrackingClicked();
+    void onTrackValueChanged();
 
     // slider track events
     void onTrimSliderChanged(int value);
@@ -0,0 +1,138 @@
+// -----------------------------------------------------------------------------
+// File:    SpscQueue.h
+// Created: 10-17-2026
+//
+// Bounded lock-free single producer / single consumer queue.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_SPSCQUEUE__H_
+#define _HELIVIEW_SPSCQUEUE__H_
+
+#include <QAtomicInt>
+#include <cassert>
+
+#define SPSC_CACHE_LINE 64
+
+// -----------------------------------------------------------------------------
+// Fixed capacity ring of T. Exactly one thread may call push() and exactly one
+// (possibly different) thread may call pop(). Each side keeps a private copy of
+// the other side's index so the shared indices are only re-read when the queue
+// appears to be full (producer) or empty (consumer).
+template <typename T>
+class SpscQueue
+{
+public:
+    SpscQueue(int capacity);
+    ~SpscQueue();
+
+    bool push(const T &item);
+    bool pop(T &item);
+
+    bool empty() const;
+    int size() const;
+    int capacity() const { return m_mask; }
+
+protected:
+    static int loadAcquire(const QAtomicInt &value);
+
+    T                  *m_items;
+    int                 m_mask;
+    char                m_pad0[SPSC_CACHE_LINE];
+    mutable QAtomicInt  m_head;     // next slot written by the producer
+    int                 m_tailCache;
+    char                m_pad1[SPSC_CACHE_LINE];
+    mutable QAtomicInt  m_tail;     // next slot read by the consumer
+    int                 m_headCache;
+    char                m_pad2[SPSC_CACHE_LINE];
+
+private:
+    SpscQueue(const SpscQueue &);
+    SpscQueue &operator=(const SpscQueue &);
+};
+
+// -----------------------------------------------------------------------------
+template <typename T>
+SpscQueue<T>::SpscQueue(int capacity)
+: m_items(NULL), m_mask(0), m_head(0), m_tailCache(0), m_tail(0),
+  m_headCache(0)
+{
+    // round up to a power of two, one slot is always left empty
+    int size = 2;
+    while (size < capacity + 1)
+        size <<= 1;
+
+    m_items = new T[size];
+    m_mask = size - 1;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T>
+SpscQueue<T>::~SpscQueue()
+{
+    delete[] m_items;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T>
+int SpscQueue<T>::loadAcquire(const QAtomicInt &value)
+{
+    return const_cast<QAtomicInt &>(value).fetchAndAddAcquire(0);
+}
+
+// -----------------------------------------------------------------------------
+template <typename T>
+bool SpscQueue<T>::push(const T &item)
+{
+    int head = (int)m_head;
+    int next = (head + 1) & m_mask;
+
+    if (next == m_tailCache)
+    {
+        // looks full, refresh our view of the consumer before giving up
+        m_tailCache = loadAcquire(m_tail);
+        if (next == m_tailCache)
+            return false;
+    }
+
+    m_items[head] = item;
+    m_head.fetchAndStoreRelease(next);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T>
+bool SpscQueue<T>::pop(T &item)
+{
+    int tail = (int)m_tail;
+
+    if (tail == m_headCache)
+    {
+        // looks empty, refresh our view of the producer before giving up
+        m_headCache = loadAcquire(m_head);
+        if (tail == m_headCache)
+            return false;
+    }
+
+    // hand the item over and release the slot's contents immediately so that
+    // large payloads (frames) don't linger in the ring
+    item = m_items[tail];
+    m_items[tail] = T();
+    m_tail.fetchAndStoreRelease((tail + 1) & m_mask);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+template <typename T>
+bool SpscQueue<T>::empty() const
+{
+    return loadAcquire(m_head) == loadAcquire(m_tail);
+}
+
+// -----------------------------------------------------------------------------
+template <typename T>
+int SpscQueue<T>::size() const
+{
+    return (loadAcquire(m_head) - loadAcquire(m_tail)) & m_mask;
+}
+
+#endif // _HELIVIEW_SPSCQUEUE__H_
@@ -0,0 +1,172 @@
+// -----------------------------------------------------------------------------
+// File:    TelemetryStore.cpp
+// Created: 10-17-2026
+//
+// Shared columnar telemetry store and its snapshot views.
+// -----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <QMutexLocker>
+#include <QObject>
+#include "FlightRecorder.h"
+#include "Logger.h"
+#include "TelemetryStore.h"
+
+#define CHUNK_MASK  (TELEMETRY_CHUNK_SIZE - 1)
+
+// -----------------------------------------------------------------------------
+TelemetryView::TelemetryView()
+: m_firstChunk(0), m_begin(0), m_end(0), m_generation(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+double TelemetryView::time(size_t i) const
+{
+    return chunk(i).time[i & CHUNK_MASK];
+}
+
+// -----------------------------------------------------------------------------
+float TelemetryView::value(int channel, size_t i) const
+{
+    return chunk(i).value[channel][i & CHUNK_MASK];
+}
+
+// -----------------------------------------------------------------------------
+const float *TelemetryView::column(int channel, size_t i, size_t &count) const
+{
+    if (i < m_begin || i >= m_end)
+    {
+        count = 0;
+        return NULL;
+    }
+
+    size_t offset = i & CHUNK_MASK;
+    count = std::min((size_t)TELEMETRY_CHUNK_SIZE - offset, m_end - i);
+    return &chunk(i).value[channel][offset];
+}
+
+// -----------------------------------------------------------------------------
+size_t TelemetryView::lowerBound(double t) const
+{
+    // receive times only ever grow
+    size_t lo = m_begin, hi = m_end;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (time(mid) < t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+// -----------------------------------------------------------------------------
+TelemetryStore *TelemetryStore::instance()
+{
+    static TelemetryStore store;
+    return &store;
+}
+
+// -----------------------------------------------------------------------------
+TelemetryStore::TelemetryStore()
+: m_firstChunk(0), m_end(0), m_start(0), m_latest(0), m_generation(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+TelemetryStore::~TelemetryStore()
+{
+}
+
+// -----------------------------------------------------------------------------
+void TelemetryStore::append(uint64_t timestamp, const float values[TELEM_CHANNELS])
+{
+    // the slot is written before it is published, readers never look past
+    // the end of their snapshot so they can't see it half done
+    size_t offset = m_end & CHUNK_MASK;
+    if (0 == offset)
+    {
+        TelemetryChunkPtr chunk(new TelemetryChunk);
+        bool discarding = false;
+        {
+            QMutexLocker locker(&m_lock);
+            m_chunks.push_back(chunk);
+            if (m_chunks.size() > TELEMETRY_MAX_CHUNKS)
+            {
+                // views still holding the chunk keep it alive until they go
+                m_chunks.pop_front();
+                discarding = (0 == m_firstChunk++);
+            }
+        }
+
+        // said once, the first time a chunk goes
+        if (discarding && FlightRecorder::instance()->isOpen())
+        {
+            Logger::info(QObject::tr("TelemetryStore: memory full, the graphs "
+                    "only keep an outline of older samples, replay %1 for "
+                    "all of them\n").arg(FlightRecorder::instance()->fileName()));
+        }
+        else if (discarding)
+        {
+            Logger::warn(QObject::tr("TelemetryStore: memory full and not "
+                    "recording, older samples are being discarded\n"));
+        }
+    }
+
+    // times must never run backwards, lowerBound() searches on them, and a
+    // stamp from before the first sample would wrap the unsigned difference
+    if (0 == m_start)
+        m_start = m_latest = timestamp;
+    else if (timestamp < m_latest)
+        timestamp = m_latest;
+    m_latest = timestamp;
+
+    TelemetryChunk &chunk = *m_chunks.back();
+    chunk.time[offset] = (timestamp - m_start) / 1e6;
+    for (int c = 0; c < TELEM_CHANNELS; ++c)
+        chunk.value[c][offset] = values[c];
+
+    QMutexLocker locker(&m_lock);
+    ++m_end;
+}
+
+// -----------------------------------------------------------------------------
+void TelemetryStore::reset(uint64_t start)
+{
+    QMutexLocker locker(&m_lock);
+    m_chunks.clear();
+    m_firstChunk = 0;
+    m_end = 0;
+    m_start = m_latest = start;
+    ++m_generation;
+}
+
+// -----------------------------------------------------------------------------
+TelemetryView TelemetryStore::snapshot() const
+{
+    TelemetryView view;
+
+    QMutexLocker locker(&m_lock);
+    view.m_chunks.assign(m_chunks.begin(), m_chunks.end());
+    view.m_firstChunk = m_firstChunk;
+    view.m_begin = m_firstChunk << TELEMETRY_CHUNK_BITS;
+    view.m_end = m_end;
+    view.m_generation = m_generation;
+    return view;
+}
+
+// -----------------------------------------------------------------------------
+size_t TelemetryStore::size() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_end - (m_firstChunk << TELEMETRY_CHUNK_BITS);
+}
+
+// -----------------------------------------------------------------------------
+size_t TelemetryStore::discarded() const
+{
+    QMutexLocker locker(&m_lock);
+    return m_firstChunk << TELEMETRY_CHUNK_BITS;
+}
@@ -0,0 +1,118 @@
+// -----------------------------------------------------------------------------
+// File:    TelemetryStore.h
+// Created: 10-17-2026
+//
+// Shared, append-only, columnar store of every telemetry sample received.
+// Samples live in fixed size chunks holding one contiguous array per channel,
+// so a chunk never moves once written. Readers take a TelemetryView snapshot,
+// which shares the chunks rather than copying them. Once the store reaches
+// TELEMETRY_MAX_CHUNKS the oldest chunk is discarded, nothing reads it back:
+// the graphs keep only their coarser levels for that span (see GraphHistory).
+// A flight recording, when one is open, still has every sample for replay.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_TELEMETRYSTORE__H_
+#define _HELIVIEW_TELEMETRYSTORE__H_
+
+#include <deque>
+#include <vector>
+#include <QMutex>
+#include <QSharedPointer>
+#include "Utility.h"
+
+#define TELEMETRY_CHUNK_BITS    12          // 4096 samples, ~150 KB a chunk
+#define TELEMETRY_CHUNK_SIZE    (1 << TELEMETRY_CHUNK_BITS)
+#define TELEMETRY_MAX_CHUNKS    512         // ~75 MB, ~5.8 hours at 100 Hz
+
+enum TelemetryChannel
+{
+    TELEM_YAW,
+    TELEM_PITCH,
+    TELEM_ROLL,
+    TELEM_ALT,
+    TELEM_RSSI,
+    TELEM_BATT,
+    TELEM_AUX,
+    TELEM_CPU,
+    TELEM_CHANNELS,
+    TELEM_NONE = TELEM_CHANNELS
+};
+
+struct TelemetryChunk
+{
+    double time[TELEMETRY_CHUNK_SIZE];      // seconds since the first sample
+    float  value[TELEM_CHANNELS][TELEMETRY_CHUNK_SIZE];
+};
+
+typedef QSharedPointer<TelemetryChunk> TelemetryChunkPtr;
+
+// -----------------------------------------------------------------------------
+// Read-only snapshot of the store. Samples are addressed by their absolute
+// index since the first one; [begin(), end()) are the ones still held.
+// A view keeps its chunks alive, so it stays valid however long it is kept
+// and whatever the store does meanwhile.
+class TelemetryView
+{
+public:
+    TelemetryView();
+
+    size_t begin() const { return m_begin; }
+    size_t end() const { return m_end; }
+    int generation() const { return m_generation; }
+    bool empty() const { return m_begin == m_end; }
+
+    double time(size_t i) const;
+    float value(int channel, size_t i) const;
+
+    // the longest contiguous run of a channel starting at sample i
+    const float *column(int channel, size_t i, size_t &count) const;
+
+    // first held sample at or after t (end() if none)
+    size_t lowerBound(double t) const;
+
+protected:
+    friend class TelemetryStore;
+
+    const TelemetryChunk &chunk(size_t i) const
+    { return *m_chunks[(i >> TELEMETRY_CHUNK_BITS) - m_firstChunk]; }
+
+    std::vector<TelemetryChunkPtr> m_chunks;
+    size_t                         m_firstChunk;
+    size_t                         m_begin;
+    size_t                         m_end;
+    int                            m_generation;   // store resets so far
+};
+
+// -----------------------------------------------------------------------------
+// Writer side. A singleton like the Logger; one thread appends (the GUI, as
+// telemetry arrives), any thread may take snapshots.
+class TelemetryStore
+{
+public:
+    static TelemetryStore *instance();
+
+    void append(uint64_t timestamp, const float values[TELEM_CHANNELS]);
+
+    // drop everything for a new session. times count from start, or from the
+    // session's first sample if it's 0. writer thread only, views taken
+    // before keep the old samples
+    void reset(uint64_t start = 0);
+
+    TelemetryView snapshot() const;
+    size_t size() const;
+    size_t discarded() const;
+
+protected:
+    TelemetryStore();
+    ~TelemetryStore();
+
+    mutable QMutex                m_lock;
+    std::deque<TelemetryChunkPtr> m_chunks;
+    size_t                        m_firstChunk;   // absolute number of m_chunks[0]
+    size_t                        m_end;          // absolute index of next sample
+    uint64_t                      m_start;        // timestamp at time 0
+    uint64_t                      m_latest;       // newest timestamp stored
+    int                           m_generation;
+};
+
+#endif // _HELIVIEW_TELEMETRYSTORE__H_
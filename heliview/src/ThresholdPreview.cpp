@@ -0,0 +1,123 @@
+// -----------------------------------------------------------------------------
+// File:    ThresholdPreview.cpp
+// Created: 10-17-2026
+//
+// Worker that marks the pixels the current tracking thresholds would select.
+// -----------------------------------------------------------------------------
+
+#include <vector>
+#include "ThresholdPreview.h"
+
+// -----------------------------------------------------------------------------
+ThresholdPreview::ThresholdPreview()
+: m_matched(0), m_hasImage(false), m_hasOverlay(false), m_active(true),
+  m_notifyPending(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+ThresholdPreview::~ThresholdPreview()
+{
+    stop();
+    wait();
+}
+
+// -----------------------------------------------------------------------------
+void ThresholdPreview::submit(const QImage &image,
+        const ColorThreshold &threshold)
+{
+    QMutexLocker lock(&m_lock);
+    m_image = image;
+    m_threshold = threshold;
+    m_hasImage = true;
+    m_wake.wakeOne();
+}
+
+// -----------------------------------------------------------------------------
+bool ThresholdPreview::takeOverlay(QImage &overlay, int &matched)
+{
+    // re-arm before looking so an overlay published meanwhile notifies again
+    m_notifyPending.fetchAndStoreOrdered(0);
+
+    QMutexLocker lock(&m_lock);
+    if (!m_hasOverlay)
+        return false;
+
+    overlay = m_overlay;
+    matched = m_matched;
+    m_overlay = QImage();
+    m_hasOverlay = false;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void ThresholdPreview::stop()
+{
+    QMutexLocker lock(&m_lock);
+    m_active = false;
+    m_wake.wakeOne();
+}
+
+// -----------------------------------------------------------------------------
+QImage ThresholdPreview::overlay(const QImage &image,
+        const ColorThreshold &threshold, int *matched)
+{
+    // the kernels read 0xAARRGGBB words, anything else is converted once
+    bool native = image.format() == QImage::Format_RGB32 ||
+                  image.format() == QImage::Format_ARGB32;
+    const QImage source = native ? image :
+        image.convertToFormat(QImage::Format_RGB32);
+
+    int width = source.width(), height = source.height(), total = 0;
+    QImage result(width, height, QImage::Format_ARGB32_Premultiplied);
+    std::vector<uint8_t> mask(width);
+
+    for (int y = 0; y < height; ++y)
+    {
+        const uint32_t *in = (const uint32_t *)source.scanLine(y);
+        uint32_t *out = (uint32_t *)result.scanLine(y);
+
+        total += ColorThresholdRow(in, width, threshold, &mask[0]);
+        for (int x = 0; x < width; ++x)
+            out[x] = PREVIEW_TINT & (0u - (mask[x] >> 7));
+    }
+
+    if (matched)
+        *matched = total;
+    return result;
+}
+
+// -----------------------------------------------------------------------------
+void ThresholdPreview::run()
+{
+    for (;;)
+    {
+        QImage image;
+        ColorThreshold threshold;
+        {
+            QMutexLocker lock(&m_lock);
+            while (m_active && !m_hasImage)
+                m_wake.wait(&m_lock);
+            if (!m_active)
+                return;
+
+            image = m_image;
+            threshold = m_threshold;
+            m_image = QImage();
+            m_hasImage = false;
+        }
+
+        int matched = 0;
+        QImage result = overlay(image, threshold, &matched);
+
+        {
+            QMutexLocker lock(&m_lock);
+            m_overlay = result;
+            m_matched = matched;
+            m_hasOverlay = true;
+        }
+
+        if (m_notifyPending.testAndSetOrdered(0, 1))
+            emit overlayReady();
+    }
+}
@@ -0,0 +1,61 @@
+// -----------------------------------------------------------------------------
+// File:    ThresholdPreview.h
+// Created: 10-17-2026
+//
+// Worker that marks the pixels the current tracking thresholds would select,
+// so they can be tuned against live video before being sent to the vehicle.
+// Like the decoder, each end holds a single slot and the newest image wins.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_THRESHOLDPREVIEW__H_
+#define _HELIVIEW_THRESHOLDPREVIEW__H_
+
+#include <QAtomicInt>
+#include <QImage>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include "ColorThreshold.h"
+
+#define PREVIEW_TINT    0x80800080  // premultiplied half transparent magenta
+
+class ThresholdPreview: public QThread
+{
+    Q_OBJECT
+
+public:
+    ThresholdPreview();
+    virtual ~ThresholdPreview();
+
+    // producer side, returns straight away
+    void submit(const QImage &image, const ColorThreshold &threshold);
+
+    // consumer side, false if nothing new since the last call. the overlay
+    // is the size of the submitted image, transparent where nothing matched.
+    bool takeOverlay(QImage &overlay, int &matched);
+
+    // mark an image on the calling thread
+    static QImage overlay(const QImage &image, const ColorThreshold &threshold,
+            int *matched = NULL);
+
+    void stop();
+
+signals:
+    void overlayReady();
+
+protected:
+    virtual void run();
+
+    QMutex          m_lock;
+    QWaitCondition  m_wake;
+    QImage          m_image;        // newest unprocessed image
+    ColorThreshold  m_threshold;
+    QImage          m_overlay;      // newest finished overlay
+    int             m_matched;
+    bool            m_hasImage;
+    bool            m_hasOverlay;
+    bool            m_active;
+    QAtomicInt      m_notifyPending;
+};
+
+#endif // _HELIVIEW_THRESHOLDPREVIEW__H_
@@ -11,6 +11,18 @@
 
 #include <stdint.h>
 
+#ifdef PLATFORM_WIN_MSVC
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
 #define SafeDelete(x)       do { if (x) { delete (x); (x) = NULL; }}  while (0)
 #define SafeDeleteArray(x)  do { if (x) { delete[] (x); (x) = NULL; }} while (0)
 
@@ -24,5 +36,21 @@
 // macro inverts the bit (y) in the number (x)
 #define BIT_INV(x,y) ((((x) & (y)) ^ (y)) | ((x) & ~(y)))
 
+// monotonic clock in microseconds for timestamps and latency measurements
+inline uint64_t MonotonicMicros()
+{
+#ifdef PLATFORM_WIN_MSVC
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)(now.QuadPart / freq.QuadPart) * 1000000 +
+           (uint64_t)(now.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
 #endif // _HELIVIEW_UTILITY__H_
 
@@ -0,0 +1,1040 @@
+// -----------------------------------------------------------------------------
+// File:    VehicleController.cpp
+// Created: 10-17-2026
+//
+// Link independent half of the vehicle protocol, commands going out and the
+// vehicle's packets coming in.
+// -----------------------------------------------------------------------------
+
+#include <cstring>
+#include <QMutexLocker>
+#include "FlightRecorder.h"
+#include "Logger.h"
+#include "VehicleController.h"
+#include "uav_protocol_ext.h"
+
+#ifdef PLATFORM_UNIX_GCC
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#endif
+
+// -----------------------------------------------------------------------------
+VehicleController::VehicleController()
+: m_control(NULL), m_gamepad(NULL), m_control_rate(VEHICLE_CONTROL_HZ),
+  m_control_priority(0), m_throttle_en(false), m_state(STATE_AUTONOMOUS),
+  m_axes(AXIS_ALL), m_track(QColor(159, 39, 100), 10, 20, 10, 5, 1),
+  m_track_en(false), m_tce(-1), m_cte(-1), m_timings_next(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+VehicleController::~VehicleController()
+{
+    stopControl();
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::startControl(const DeviceOptions &options)
+{
+    // "ctl=100" runs the control loop at 100 Hz, "rt" or "rt=N" asks for
+    // SCHED_FIFO so a loaded machine doesn't stretch the period either
+    m_control_rate = VEHICLE_CONTROL_HZ;
+    if (options.contains("ctl"))
+    {
+        m_control_rate = qBound(VEHICLE_CONTROL_MIN_HZ,
+                options.value("ctl").toInt(), VEHICLE_CONTROL_MAX_HZ);
+    }
+
+    m_control_priority = 0;
+    if (options.contains("rt"))
+    {
+        int priority = options.value("rt").toInt();
+        m_control_priority = (priority > 0) ? priority : VEHICLE_RT_PRIORITY;
+    }
+
+    m_tce = m_cte = -1;
+    m_throttle_en = false;
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::stopControl()
+{
+    enableControl(false);
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::enableControl(bool enable)
+{
+    if (enable && !m_control)
+    {
+        Logger::info(tr("Vehicle: flight control at %1 Hz\n").arg(m_control_rate));
+        m_control = new VehicleControlThread(this, m_control_rate,
+                m_control_priority);
+        m_control->setGamepad(m_gamepad);
+        updateControlMode();
+        m_control->start();
+    }
+    else if (!enable && m_control)
+    {
+        m_control->stop();
+        m_control->wait();
+        SafeDelete(m_control);
+    }
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::updateControlMode()
+{
+    if (m_control)
+    {
+        m_control->setMode(STATE_MIXED_CONTROL == m_state, m_axes,
+                m_throttle_en);
+    }
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::setGamepad(Gamepad *gamepad)
+{
+    m_gamepad = gamepad;
+    if (m_control)
+        m_control->setGamepad(gamepad);
+}
+
+// -----------------------------------------------------------------------------
+ControlLatency VehicleController::controlLatency() const
+{
+    QMutexLocker locker(&m_latency_lock);
+    return m_latency;
+}
+
+// -----------------------------------------------------------------------------
+QVector<ControlTiming> VehicleController::controlTimings() const
+{
+    QMutexLocker locker(&m_latency_lock);
+    if (m_timings.size() < CONTROL_LATENCY_SAMPLES)
+        return m_timings;
+
+    // the ring has wrapped, the oldest is the next one to be overwritten
+    return m_timings.mid(m_timings_next) + m_timings.mid(0, m_timings_next);
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::recordControl(const ControlTiming &timing)
+{
+    QMutexLocker locker(&m_latency_lock);
+    m_latency.record(timing);
+
+    if (m_timings.size() < CONTROL_LATENCY_SAMPLES)
+    {
+        m_timings.append(timing);
+    }
+    else
+    {
+        m_timings[m_timings_next] = timing;
+        m_timings_next = (m_timings_next + 1) % CONTROL_LATENCY_SAMPLES;
+    }
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::sendControl(uint32_t *buffer, int length,
+        ControlTiming &timing)
+{
+    if (!sendPacket(buffer, length))
+        return false;
+
+    if (timing.event)
+    {
+        timing.written = MonotonicMicros();
+        recordControl(timing);
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::requestControlMode(DeviceState state,
+        int axes) const
+{
+    uint32_t vcm_type;
+    switch (state)
+    {
+    case STATE_RADIO_CONTROL: vcm_type = VCM_TYPE_RADIO; break;
+    case STATE_MIXED_CONTROL: vcm_type = VCM_TYPE_MIXED; break;
+    case STATE_AUTONOMOUS:    vcm_type = VCM_TYPE_AUTO;  break;
+    case STATE_KILLED:        vcm_type = VCM_TYPE_KILL;  break;
+    default:
+        // lockout is the vehicle's call, not ours
+        return false;
+    }
+
+    int vcm_axes = 0;
+    if (axes & AXIS_ALT)   vcm_axes |= VCM_AXIS_ALT;
+    if (axes & AXIS_YAW)   vcm_axes |= VCM_AXIS_YAW;
+    if (axes & AXIS_PITCH) vcm_axes |= VCM_AXIS_PITCH;
+    if (axes & AXIS_ROLL)  vcm_axes |= VCM_AXIS_ROLL;
+
+    uint32_t cmd_buffer[PKT_VCM_NUM];
+    cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_SET_CTL_MODE;
+    cmd_buffer[PKT_LENGTH]   = PKT_VCM_LENGTH;
+    cmd_buffer[PKT_VCM_TYPE] = vcm_type;
+    cmd_buffer[PKT_VCM_AXES] = vcm_axes;
+    return sendPacket(cmd_buffer, PKT_VCM_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::subscribe(uint32_t channel, uint32_t rate) const
+{
+    uint32_t cmd_buffer[PKT_SUB_NUM];
+    cmd_buffer[PKT_COMMAND]     = CLIENT_REQ_SUBSCRIBE;
+    cmd_buffer[PKT_LENGTH]      = PKT_SUB_LENGTH;
+    cmd_buffer[PKT_SUB_CHANNEL] = channel;
+    cmd_buffer[PKT_SUB_RATE]    = rate;
+    return sendPacket(cmd_buffer, PKT_SUB_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::sendPacket(uint32_t command) const
+{
+    uint32_t cmd_buffer[] = { command, PKT_BASE_LENGTH };
+    return sendPacket(cmd_buffer, PKT_BASE_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::requestDeviceControls() const
+{
+    return sendPacket(CLIENT_REQ_CAM_DCI);
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::requestColors() const
+{    
+    return sendPacket(CLIENT_REQ_CAM_COLORS);
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::requestTrimSettings() const
+{
+    return sendPacket(CLIENT_REQ_GTS);
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::requestFilterSettings() const
+{
+    return sendPacket(CLIENT_REQ_GFS);
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::requestPIDSettings(int axis) const
+{    
+    uint32_t cmd_buffer[PKT_GPIDS_NUM];
+    cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_GPIDS;
+    cmd_buffer[PKT_LENGTH]   = PKT_GPIDS_LENGTH;
+    cmd_buffer[PKT_GPIDS_AXIS] = axis;
+    return sendPacket(cmd_buffer, PKT_GPIDS_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::requestTakeoff() const
+{
+    Logger::info("Vehicle: Request Takeoff\n");
+    return sendPacket(CLIENT_REQ_TAKEOFF);
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::requestLanding() const
+{
+    Logger::info("Vehicle: Request Landing\n");
+    return sendPacket(CLIENT_REQ_LANDING);
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::requestManualOverride() const
+{
+    Logger::info("Vehicle: Request Manual Override\n");
+    uint32_t cmd_buffer[PKT_VCM_NUM];
+    cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_SET_CTL_MODE;
+    cmd_buffer[PKT_LENGTH]   = PKT_VCM_LENGTH;
+    cmd_buffer[PKT_VCM_TYPE] = VCM_TYPE_RADIO;
+    cmd_buffer[PKT_VCM_AXES] = VCM_AXIS_ALL;
+    return sendPacket(cmd_buffer, PKT_VCM_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::requestAutonomous() const
+{
+    Logger::info("Vehicle: Request Autonomous\n");
+    uint32_t cmd_buffer[PKT_VCM_NUM];
+    cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_SET_CTL_MODE;
+    cmd_buffer[PKT_LENGTH]   = PKT_VCM_LENGTH;
+    cmd_buffer[PKT_VCM_TYPE] = VCM_TYPE_AUTO;
+    cmd_buffer[PKT_VCM_AXES] = VCM_AXIS_ALL;
+    return sendPacket(cmd_buffer, PKT_VCM_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+bool VehicleController::requestKillswitch() const
+{
+    Logger::info("Vehicle: Request Killswitch\n");
+    uint32_t cmd_buffer[PKT_VCM_NUM];
+    cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_SET_CTL_MODE;
+    cmd_buffer[PKT_LENGTH]   = PKT_VCM_LENGTH;
+    cmd_buffer[PKT_VCM_TYPE] = VCM_TYPE_KILL;
+    cmd_buffer[PKT_VCM_AXES] = VCM_AXIS_ALL;
+    return sendPacket(cmd_buffer, PKT_VCM_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::processPacket(const uint32_t *packet,
+        const PacketTiming &timing)
+{
+    int32_t rssi, battery, aux, framesz,cpu;
+    float x, y, z, h;
+    float kp, ki, kd, sp;
+    QString type;
+    QRect bbox;
+    QPoint point;
+    bool enabled;
+    FrameTiming frame_timing;
+
+    switch (packet[0])
+    {
+    case SERVER_ACK_IGNORED:
+        Logger::info("Vehicle: SERVER_ACK_IGNORED\n");
+        break;
+    case SERVER_ACK_TAKEOFF:
+        Logger::info("Vehicle: SERVER_ACK_TAKEOFF\n");
+        break;
+    case SERVER_ACK_LANDING:
+        Logger::info("Vehicle: SERVER_ACK_LANDING\n");
+        break;
+    case SERVER_ACK_TELEMETRY:
+        z = *(float *)&packet[PKT_VTI_YAW];
+        y = *(float *)&packet[PKT_VTI_PITCH];
+        x = *(float *)&packet[PKT_VTI_ROLL];
+        h = *(float *)&packet[PKT_VTI_ALT];
+       
+        rssi    = packet[PKT_VTI_RSSI];
+        battery = packet[PKT_VTI_BATT];
+        aux     = packet[PKT_VTI_AUX];
+        cpu     = packet[PKT_VTI_CPU];
+
+        emit telemetryReady(-z, -y, x, h, rssi, battery, aux, cpu,
+                timing.last_byte);
+        FlightRecorder::telemetry(-z, -y, x, h, rssi, battery, aux, cpu);
+        break;
+    case SERVER_ACK_MJPG_FRAME:
+        framesz = packet[PKT_LENGTH] - PKT_MJPG_LENGTH;
+        frame_timing.requested  = timing.requested;
+        frame_timing.first_byte = timing.first_byte;
+        frame_timing.last_byte  = timing.last_byte;
+        emit videoFrameReady((const char *)&packet[PKT_MJPG_IMG],
+                            (size_t)framesz, frame_timing);
+        FlightRecorder::videoFrame((const char *)&packet[PKT_MJPG_IMG],
+                                   (size_t)framesz);
+        break;
+    case SERVER_UPDATE_CTL_MODE:
+        // the throttle is only held in mixed mode, with altitude ours
+        m_throttle_en = false;
+
+        switch (packet[PKT_VCM_TYPE])
+        {
+        case VCM_TYPE_RADIO:
+            Logger::info("Vehicle: got UPDATE_CTL_MODE to radio\n");
+            m_state = STATE_RADIO_CONTROL;
+            break;
+        case VCM_TYPE_AUTO:
+            Logger::info("Vehicle: got UPDATE_CTL_MODE to auto\n");
+            m_state = STATE_AUTONOMOUS;
+            break;
+        case VCM_TYPE_MIXED:
+            Logger::info("Vehicle: got UPDATE_CTL_MODE to mixed\n");
+            m_state = STATE_MIXED_CONTROL;
+            break;
+        case VCM_TYPE_KILL: 
+            Logger::info("Vehicle: got UPDATE_CTL_MODE to killed\n");
+            m_state = STATE_KILLED;
+            break;
+        case VCM_TYPE_LOCKOUT:
+            Logger::info("Vehicle: got UPDATE_CTL_MODE to lockout\n");
+            m_state = STATE_LOCKOUT;
+            break;
+        default:
+            Logger::info("Vehicle: got UPDATE_CTL_MODE !! invalid !!\n");
+            m_state = STATE_KILLED;
+            break;
+        }
+
+        m_axes = 0;
+        if (packet[PKT_VCM_AXES] & VCM_AXIS_ALT)   m_axes |= AXIS_ALT;
+        if (packet[PKT_VCM_AXES] & VCM_AXIS_YAW)   m_axes |= AXIS_YAW;
+        if (packet[PKT_VCM_AXES] & VCM_AXIS_PITCH) m_axes |= AXIS_PITCH;
+        if (packet[PKT_VCM_AXES] & VCM_AXIS_ROLL)  m_axes |= AXIS_ROLL;
+
+        if (m_state == STATE_MIXED_CONTROL)
+            m_throttle_en = (0 != (m_axes & AXIS_ALT));
+        updateControlMode();
+
+        emit controlStateChanged((int)m_state);
+        FlightRecorder::controlState((int)m_state, m_axes);
+        break;
+    case SERVER_UPDATE_STATE:
+        emit flightStateChanged((int)packet[PKT_FCS_STATE]);
+        FlightRecorder::flightState((int)packet[PKT_FCS_STATE]);
+        break;
+    case SERVER_UPDATE_TRACKING:
+        bbox.setCoords(packet[PKT_CTS_X1], packet[PKT_CTS_Y1], 
+                       packet[PKT_CTS_X2], packet[PKT_CTS_Y2]);
+        point = QPoint(packet[PKT_CTS_XC], packet[PKT_CTS_YC]);
+        enabled = packet[PKT_CTS_STATE] == CTS_STATE_DETECTED;
+        emit trackStatusUpdate(enabled, bbox, point);
+        FlightRecorder::trackStatus(enabled, bbox, point);
+        break;
+    case SERVER_UPDATE_COLOR:
+        //Logger::info("Vehicle: received Update color\n");
+        //R G B, ht, st, ft, fps
+        emit colorValuesUpdate(TrackSettings(
+            QColor((int)packet[PKT_CAM_TC_CH0], 
+                    (int)packet[PKT_CAM_TC_CH1], 
+                    (int)packet[PKT_CAM_TC_CH2]),
+             (int)packet[PKT_CAM_TC_TH0], 
+             (int)packet[PKT_CAM_TC_TH1], 
+             (int)packet[PKT_CAM_TC_FILTER], 
+             (int)packet[PKT_CAM_TC_FPS],
+             (int)packet[PKT_CAM_TC_ENABLE]));
+        break;
+    case SERVER_UPDATE_CAM_DCI:
+        // convert the type to a string for genericness
+        switch (packet[PKT_CAM_DCI_TYPE])
+        {
+        case CAM_DCI_TYPE_BOOL: type = "bool"; break;
+        case CAM_DCI_TYPE_INT:  type = "int"; break;
+        case CAM_DCI_TYPE_MENU: type = "menu"; break;
+        default:
+            // bad pie
+            return;
+        }
+        emit deviceControlUpdated(QString((char *)&packet[PKT_CAM_DCI_NAME]),
+                type, packet[PKT_CAM_DCI_ID],
+                packet[PKT_CAM_DCI_MIN], packet[PKT_CAM_DCI_MAX],
+                packet[PKT_CAM_DCI_STEP], packet[PKT_CAM_DCI_DEFAULT], 
+                packet[PKT_CAM_DCI_CURRENT]);
+        break;
+    case SERVER_UPDATE_CAM_DCM:
+        emit deviceMenuUpdated(QString((char *)&packet[PKT_CAM_DCM_NAME]),
+                packet[PKT_CAM_DCM_ID], packet[PKT_CAM_DCM_INDEX]);
+        break;
+    case SERVER_ACK_TCE:
+        Logger::info(tr("Vehicle: received \
+                New Track Control Enable: %1\n").arg(packet[PKT_TE_STATUS]));
+        m_tce = packet[PKT_TE_STATUS];
+        emit updateTrackControlEnable(packet[PKT_TE_STATUS]);
+        break;
+    case SERVER_ACK_CTE:
+        Logger::info(tr("Vehicle: received \
+                New Color Track Enable: %1\n").arg(packet[PKT_TE_STATUS]));
+        m_cte = packet[PKT_TE_STATUS];
+        emit updateColorTrackEnable(packet[PKT_TE_STATUS]);
+        break;
+    case SERVER_ACK_GTS:
+        emit trimSettingsUpdated(packet[PKT_GTS_YAW], packet[PKT_GTS_PITCH],
+                packet[PKT_GTS_ROLL], packet[PKT_GTS_ALT]);
+        break;
+    case SERVER_ACK_GFS:
+        emit filterSettingsUpdated(packet[PKT_GFS_IMU], packet[PKT_GFS_ALT],
+                packet[PKT_GFS_AUX], packet[PKT_GFS_BATT]);
+        break;
+    case SERVER_ACK_GPIDS:
+        memcpy(&kp, &packet[PKT_GPIDS_KP], 4);
+        memcpy(&ki, &packet[PKT_GPIDS_KI], 4);
+        memcpy(&kd, &packet[PKT_GPIDS_KD], 4);
+        memcpy(&sp, &packet[PKT_GPIDS_SP], 4);
+
+        Logger::info(tr("Vehicle: Recieved GPID axis:%1 Kp:%2 Ki:%3 Kd:%4 SP:%5\n")
+                .arg(packet[PKT_GPIDS_AXIS]).arg(kp).arg(ki).arg(kd).arg(sp));
+        
+        emit pidSettingsUpdated(packet[PKT_GPIDS_AXIS], kp, ki, kd, sp);
+        break;
+
+    default:
+        Logger::err(tr("Vehicle: bad server cmd: %1\n").arg(packet[0]));
+        break;
+    }
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::onInputReady(
+        GamepadEvent event, int index, float value)
+{
+    //Button 4 - A
+    //Button 5 - B
+    //Button 6 - X
+    //Button 7 - Y
+    //Button 8 - LB
+    //Button 9 - RB
+    //Button 10 - Back
+    //Button 11 - Start
+    uint32_t cmd_buffer[32];
+
+    if (GP_EVENT_BUTTON == event)
+    {
+        
+        if ((12 == index) && (value > 0.0))
+        {
+            int vcm_type;
+            if (STATE_MIXED_CONTROL == m_state)
+            {
+                Logger::info("Vehicle: requesting switch to autonomous\n");
+                vcm_type = VCM_TYPE_AUTO;
+            }
+            else
+            {
+                Logger::info("Vehicle: requesting switch to mixed mode\n");
+                vcm_type = VCM_TYPE_MIXED;
+            }
+
+            // request server to set new control mode
+            cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_SET_CTL_MODE;
+            cmd_buffer[PKT_LENGTH]   = PKT_VCM_LENGTH;
+            cmd_buffer[PKT_VCM_TYPE] = vcm_type;
+            cmd_buffer[PKT_VCM_AXES] = VCM_AXIS_ALL;
+            sendPacket(cmd_buffer, PKT_VCM_LENGTH);
+        }
+        else if ((STATE_MIXED_CONTROL == m_state) && (value > 0.0) && 
+                (index >= 4) && (index <= 7))
+        {
+            // update the mixed mode controlled axes
+            int vcm_axes = 0;
+            if (m_axes & AXIS_ALT)   vcm_axes |= VCM_AXIS_ALT;
+            if (m_axes & AXIS_YAW)   vcm_axes |= VCM_AXIS_YAW;
+            if (m_axes & AXIS_PITCH) vcm_axes |= VCM_AXIS_PITCH;
+            if (m_axes & AXIS_ROLL)  vcm_axes |= VCM_AXIS_ROLL;
+
+            switch (index)
+            {
+            case 4: // A
+                vcm_axes = BIT_INV(vcm_axes, VCM_AXIS_ALT);
+                m_throttle_en = (0 != (vcm_axes & VCM_AXIS_ALT));
+                updateControlMode();
+                break;
+            case 5: // B
+                vcm_axes = BIT_INV(vcm_axes, VCM_AXIS_ROLL);
+                break;
+            case 6: // X
+                vcm_axes = BIT_INV(vcm_axes, VCM_AXIS_YAW);
+                break;
+            case 7: // Y
+                vcm_axes = BIT_INV(vcm_axes, VCM_AXIS_PITCH);
+                break;
+            default:
+                Logger::warn("Vehicle: \
+                        unknown controller button - Axis\n");
+                break;
+            }
+
+            // tell server which axes are manually controlled by mixed mode
+            cmd_buffer[PKT_COMMAND]  = CLIENT_REQ_SET_CTL_MODE;
+            cmd_buffer[PKT_LENGTH]   = PKT_VCM_LENGTH;
+            cmd_buffer[PKT_VCM_TYPE] = VCM_TYPE_MIXED;
+            cmd_buffer[PKT_VCM_AXES] = vcm_axes;
+            sendPacket(cmd_buffer, PKT_VCM_LENGTH);
+        }
+        else if ((value > 0.0) && (index >= 8) && (index <= 11))
+        {
+           
+
+            switch (index)
+            {
+            case 8: // LB - Take off
+                requestTakeoff();
+                break;
+            case 9: // RB - Land
+                requestLanding();
+                break;
+            case 10: // Back - Kill
+                requestKillswitch();
+                break;
+            case 11: // Start - Enable color tracking
+                Logger::info("Xbox - Enable Color Tracking\n");
+                break;
+            default:
+                Logger::warn("Vehicle: unknown controller \
+                            button - Commands\n");
+                break;
+            }
+        }
+    }
+
+    // sticks are left to the control thread, which samples them straight
+    // from the gamepad every tick
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::onUpdateTrackControlEnable(int track_en)
+{
+    uint32_t cmd_buffer[16];
+    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_TCE;
+    cmd_buffer[PKT_LENGTH]  = PKT_TE_LENGTH ;
+    
+    switch (track_en) {
+    case 0:
+        Logger::info("Vehicle: requesting track control disable\n");
+        break;
+    case 1:
+        Logger::info("Vehicle: requesting track control enable\n");
+        break;
+    case 2:
+        Logger::info("Vehicle: requesting track control value\n");
+        break;              
+    }
+    
+    cmd_buffer[PKT_TE_STATUS] = track_en;
+    sendPacket(cmd_buffer, PKT_TE_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::onUpdateColorTrackEnable(int track_en)
+{
+    uint32_t cmd_buffer[16];
+    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_CTE;
+    cmd_buffer[PKT_LENGTH]  = PKT_TE_LENGTH ;
+    
+    switch (track_en)
+    {
+    case 0:
+        Logger::info("Vehicle: requesting color track disable\n");
+        break;
+    case 1:
+        Logger::info("Vehicle: requesting color track enable\n");
+        break;
+    case 2:
+        Logger::info("Vehicle: requesting color track value\n");
+        break;              
+    }
+    
+    cmd_buffer[PKT_TE_STATUS] = track_en;
+    sendPacket(cmd_buffer, PKT_TE_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::updateTrackSettings(
+        int r, int g, int b, int ht, int st, int ft, int fps)
+{
+    uint32_t cmd_buffer[16];
+
+    m_track.color = QColor(r, g, b);
+    if (ht  >= 0) m_track.ht = ht;
+    if (st  >= 0) m_track.st = st;
+    if (ft  >= 0) m_track.ft = ft;
+    if (fps >= 0) m_track.fps = fps;
+
+    cmd_buffer[PKT_COMMAND]       = CLIENT_REQ_CAM_TC;
+    cmd_buffer[PKT_LENGTH]        = PKT_CAM_TC_LENGTH;
+    cmd_buffer[PKT_CAM_TC_ENABLE] = (uint32_t)m_track_en;
+    cmd_buffer[PKT_CAM_TC_FMT]    = CAM_TC_FMT_RGB;
+    cmd_buffer[PKT_CAM_TC_CH0]    = m_track.color.red();
+    cmd_buffer[PKT_CAM_TC_CH1]    = m_track.color.green();
+    cmd_buffer[PKT_CAM_TC_CH2]    = m_track.color.blue();
+    cmd_buffer[PKT_CAM_TC_TH0]    = m_track.ht;
+    cmd_buffer[PKT_CAM_TC_TH1]    = m_track.st;
+    cmd_buffer[PKT_CAM_TC_TH2]    = 0;
+    cmd_buffer[PKT_CAM_TC_FILTER] = m_track.ft;
+    cmd_buffer[PKT_CAM_TC_FPS]    = m_track.fps;
+
+    Logger::info(tr("req track color [%1 %2 %3], thresh [%4 %5], fps %6\n")
+            .arg(r).arg(g).arg(b).arg(m_track.ht)
+            .arg(m_track.st).arg(m_track.fps));
+
+    sendPacket(cmd_buffer, PKT_CAM_TC_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::updateDeviceControl(int id, int value)
+{
+    uint32_t cmd_buffer[PKT_CAM_DCC_NUM];
+    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_CAM_DCC;
+    cmd_buffer[PKT_LENGTH]  = PKT_CAM_DCC_LENGTH;
+    cmd_buffer[PKT_CAM_DCC_ID] = id;
+    cmd_buffer[PKT_CAM_DCC_VALUE] = value;
+    sendPacket(cmd_buffer, PKT_CAM_DCC_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::updateTrimSettings(int axes, int value)
+{
+    uint32_t cmd_buffer[PKT_STS_NUM];
+    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_STS;
+    cmd_buffer[PKT_LENGTH]  = PKT_STS_LENGTH;
+
+    int vcm_axes = 0;
+    if (axes & AXIS_ALT)   vcm_axes |= VCM_AXIS_ALT;
+    if (axes & AXIS_YAW)   vcm_axes |= VCM_AXIS_YAW;
+    if (axes & AXIS_PITCH) vcm_axes |= VCM_AXIS_PITCH;
+    if (axes & AXIS_ROLL)  vcm_axes |= VCM_AXIS_ROLL;
+
+    cmd_buffer[PKT_STS_AXES] = vcm_axes;
+    cmd_buffer[PKT_STS_VALUE] = value;
+    sendPacket(cmd_buffer, PKT_STS_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::updateFilterSettings(int signal, int samples)
+{
+    uint32_t cmd_buffer[PKT_SFS_NUM];
+    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_SFS;
+    cmd_buffer[PKT_LENGTH]  = PKT_SFS_LENGTH;
+
+    uint32_t sfs_sig;
+    switch (signal)
+    {
+    case SIGNAL_ORIENTATION:
+        sfs_sig = SFS_IMU;
+        break;
+    case SIGNAL_ALTITUDE:
+        sfs_sig = SFS_ALT;
+        break;
+    case SIGNAL_AUXILIARY:
+        sfs_sig = SFS_AUX;
+        break;
+    case SIGNAL_BATTERY:
+        sfs_sig = SFS_BATT;
+        break;
+    }
+
+    cmd_buffer[PKT_SFS_SIGNAL] = sfs_sig;
+    cmd_buffer[PKT_SFS_SAMPLES] = samples;
+    sendPacket(cmd_buffer, PKT_SFS_LENGTH);
+}
+
+// -----------------------------------------------------------------------------
+void VehicleController::updatePIDSettings(int axis, int signal, 
+                                                float value)
+{
+    uint32_t cmd_buffer[PKT_SPIDS_NUM];
+
+    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_SPIDS;
+    cmd_buffer[PKT_LENGTH]  = PKT_SPIDS_LENGTH;
+
+    uint32_t spids_sig;
+    switch (signal)
+    {
+        case SIGNAL_KP:
+            spids_sig = SPIDS_KP;
+            break;
+        case SIGNAL_KI:
+            spids_sig = SPIDS_KI;
+            break;
+        case SIGNAL_KD:
+            spids_sig = SPIDS_KD;
+            break;
+        case SIGNAL_SP:
+            spids_sig = SPIDS_SP;
+            break;
+    }
+
+    cmd_buffer[PKT_SPIDS_PARAM] = spids_sig;
+    memcpy(&cmd_buffer[PKT_SPIDS_VALUE], &value, 4);
+    cmd_buffer[PKT_SPIDS_AXIS] = axis;
+    sendPacket(cmd_buffer, PKT_SPIDS_LENGTH);
+}
+
+
+// -----------------------------------------------------------------------------
+VehicleControlThread::VehicleControlThread(VehicleController *vehicle,
+        int rate, int priority)
+: m_vehicle(vehicle), m_rate(rate), m_period(1000000 / rate),
+  m_priority(priority),
+#ifdef PLATFORM_UNIX_GCC
+  m_timer_fd(-1), m_stop_fd(-1),
+#endif
+  m_gamepad(NULL), m_mode(0), m_active(1), m_last_mode(0), m_hold_elapsed(0),
+  m_failing(false), m_ticks(0), m_overruns(0), m_worst_late(0), m_sent(0)
+{
+    m_prev.alt = 0.0f;
+    m_prev.pitch = 0.0f;
+    m_prev.roll = 0.0f;
+    m_prev.yaw = 0.0f;
+
+#ifdef PLATFORM_UNIX_GCC
+    m_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+    m_stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (m_timer_fd < 0 || m_stop_fd < 0)
+    {
+        Logger::warn(tr("Vehicle: no timerfd/eventfd (%1), pacing the control "
+                    "loop with sleeps\n").arg(strerror(errno)));
+    }
+#endif
+}
+
+// -----------------------------------------------------------------------------
+VehicleControlThread::~VehicleControlThread()
+{
+#ifdef PLATFORM_UNIX_GCC
+    if (m_timer_fd >= 0)
+        ::close(m_timer_fd);
+    if (m_stop_fd >= 0)
+        ::close(m_stop_fd);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+void VehicleControlThread::setGamepad(Gamepad *gamepad)
+{
+    QMutexLocker locker(&m_gamepad_lock);
+    m_gamepad = gamepad;
+}
+
+// -----------------------------------------------------------------------------
+void VehicleControlThread::setMode(bool mixed, int axes, bool throttle)
+{
+    int mode = axes & AXIS_ALL;
+    if (mixed)
+        mode |= CONTROL_MODE_MIXED;
+    if (throttle)
+        mode |= CONTROL_MODE_THROTTLE;
+    m_mode.fetchAndStoreRelease(mode);
+}
+
+// -----------------------------------------------------------------------------
+void VehicleControlThread::run()
+{
+    raisePriority();
+
+#ifdef PLATFORM_UNIX_GCC
+    if (m_timer_fd >= 0 && m_stop_fd >= 0)
+        runTimer();
+    else
+        runSleep();
+#else
+    runSleep();
+#endif
+
+    Logger::info(tr("Vehicle: control loop ran %1 ticks at %2 Hz, %3 missed, "
+                "worst %4 us late, %5 packets sent\n").arg(m_ticks).arg(m_rate)
+            .arg(m_overruns).arg(m_worst_late).arg(m_sent));
+}
+
+#ifdef PLATFORM_UNIX_GCC
+// -----------------------------------------------------------------------------
+void VehicleControlThread::runTimer()
+{
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = 0;
+    spec.it_interval.tv_nsec = m_period * 1000;
+    spec.it_value = spec.it_interval;
+
+    uint64_t expected = MonotonicMicros();
+    if (timerfd_settime(m_timer_fd, 0, &spec, NULL) < 0)
+    {
+        Logger::err(tr("Vehicle: failed to arm the control timer: %1\n")
+                .arg(strerror(errno)));
+        return;
+    }
+
+    struct pollfd pfd[2];
+    pfd[0].fd = m_timer_fd;
+    pfd[0].events = POLLIN;
+    pfd[1].fd = m_stop_fd;
+    pfd[1].events = POLLIN;
+
+    while (m_active.fetchAndAddAcquire(0))
+    {
+        int rc = poll(pfd, 2, -1);
+        if (rc < 0 && EINTR != errno)
+        {
+            Logger::err(tr("Vehicle: control poll failed: %1\n")
+                    .arg(strerror(errno)));
+            break;
+        }
+        else if (rc <= 0)
+        {
+            continue;
+        }
+
+        if (pfd[1].revents & POLLIN)
+            break;
+
+        // the timer counts expirations, more than one means we slept
+        // through a tick. those are skipped, never sent late in a burst
+        uint64_t expirations = 0;
+        if (read(m_timer_fd, &expirations, sizeof(expirations)) !=
+                sizeof(expirations) || 0 == expirations)
+        {
+            continue;
+        }
+
+        uint64_t now = MonotonicMicros();
+        expected += expirations * m_period;
+        m_overruns += expirations - 1;
+        if (now > expected)
+            m_worst_late = qMax(m_worst_late, now - expected);
+
+        tick();
+    }
+}
+#endif
+
+// -----------------------------------------------------------------------------
+void VehicleControlThread::runSleep()
+{
+    uint64_t next = MonotonicMicros() + m_period;
+
+    while (m_active.fetchAndAddAcquire(0))
+    {
+        uint64_t now = MonotonicMicros();
+        if (now < next)
+        {
+            usleep((unsigned long)(next - now));
+            continue;
+        }
+
+        // deadlines stay on the original grid, missed ones are skipped
+        uint64_t missed = (now - next) / m_period;
+        m_overruns += missed;
+        m_worst_late = qMax(m_worst_late, now - next);
+        next += (missed + 1) * m_period;
+
+        tick();
+    }
+}
+
+// -----------------------------------------------------------------------------
+void VehicleControlThread::stop()
+{
+    m_active.fetchAndStoreRelease(0);
+#ifdef PLATFORM_UNIX_GCC
+    if (m_stop_fd >= 0)
+    {
+        uint64_t one = 1;
+        if (write(m_stop_fd, &one, sizeof(one)) != sizeof(one))
+            Logger::err("Vehicle: failed to wake the control thread\n");
+    }
+#endif
+}
+
+// -----------------------------------------------------------------------------
+void VehicleControlThread::raisePriority()
+{
+    if (m_priority <= 0)
+        return;
+
+#ifdef PLATFORM_UNIX_GCC
+    struct sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = qBound(sched_get_priority_min(SCHED_FIFO),
+            m_priority, sched_get_priority_max(SCHED_FIFO));
+
+    // needs CAP_SYS_NICE or an rtprio limit, carry on without it otherwise
+    int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+    if (0 != rc)
+    {
+        Logger::warn(tr("Vehicle: SCHED_FIFO %1 refused (%2), control loop "
+                    "at normal priority\n").arg(param.sched_priority)
+                .arg(strerror(rc)));
+        return;
+    }
+    Logger::info(tr("Vehicle: control loop at SCHED_FIFO %1\n")
+            .arg(param.sched_priority));
+#else
+    setPriority(QThread::TimeCriticalPriority);
+#endif
+}
+
+// -----------------------------------------------------------------------------
+void VehicleControlThread::tick()
+{
+    ++m_ticks;
+
+    int mode = m_mode.fetchAndAddAcquire(0);
+    if (mode != m_last_mode)
+    {
+        // a new mode or axis set, the throttle starts again from center
+        m_last_mode = mode;
+        m_prev.alt = 0.0f;
+        m_hold_elapsed = 0;
+    }
+
+    if (!(mode & CONTROL_MODE_MIXED))
+        return;
+
+    GamepadState state;
+    {
+        QMutexLocker locker(&m_gamepad_lock);
+        if (!m_gamepad || !m_gamepad->snapshot(state))
+            return;
+    }
+    uint64_t sampled = MonotonicMicros();
+
+    // left stick yaw and altitude (up is negative), right stick roll, pitch
+    ctl_sigs_t ctl;
+    ctl.yaw = state.axes[0];
+    ctl.alt = -state.axes[1];
+    ctl.roll = state.axes[2];
+    ctl.pitch = state.axes[3];
+
+    bool moved = ((mode & AXIS_PITCH) && (ctl.pitch != m_prev.pitch)) ||
+                 ((mode & AXIS_ROLL) && (ctl.roll != m_prev.roll)) ||
+                 ((mode & AXIS_YAW) && (ctl.yaw != m_prev.yaw));
+    bool send = moved;
+    m_prev.pitch = ctl.pitch;
+    m_prev.roll = ctl.roll;
+    m_prev.yaw = ctl.yaw;
+
+    // the vehicle keeps ramping the throttle while it hears the stick held
+    // off center, once per VEHICLE_CONTROL_MS whatever the loop rate. not
+    // while the stick is on its way back to center
+    if (mode & CONTROL_MODE_THROTTLE)
+    {
+        m_hold_elapsed += m_period;
+        if (m_hold_elapsed >= VEHICLE_CONTROL_MS * 1000)
+        {
+            m_hold_elapsed -= VEHICLE_CONTROL_MS * 1000;
+
+            bool returning =
+                ((ctl.alt < m_prev.alt) && (m_prev.alt > 0.0f) && (ctl.alt > 0.0f)) ||
+                ((ctl.alt > m_prev.alt) && (m_prev.alt < 0.0f) && (ctl.alt < 0.0f));
+            if (!returning && ((ctl.alt >= 0.1f) || (ctl.alt <= -0.1f)))
+                send = true;
+            m_prev.alt = ctl.alt;
+        }
+    }
+
+    if (!send)
+        return;
+
+    uint32_t cmd_buffer[PKT_MCM_AXIS_NUM];
+    cmd_buffer[PKT_COMMAND] = CLIENT_REQ_FLIGHT_CTL;
+    cmd_buffer[PKT_LENGTH]  = PKT_MCM_LENGTH;
+    memcpy(&cmd_buffer[PKT_MCM_AXIS_YAW],   &ctl.yaw,   4);
+    memcpy(&cmd_buffer[PKT_MCM_AXIS_PITCH], &ctl.pitch, 4);
+    memcpy(&cmd_buffer[PKT_MCM_AXIS_ROLL],  &ctl.roll,  4);
+    memcpy(&cmd_buffer[PKT_MCM_AXIS_ALT],   &ctl.alt,   4);
+
+    // only a stick change is timed, a throttle hold repeats an old input and
+    // would measure nothing but how long the stick has been held
+    ControlTiming timing;
+    if (moved)
+    {
+        timing.event = state.timestamp;
+        timing.read = state.received;
+        timing.sampled = sampled;
+    }
+
+    // report a failing link once, not at the loop rate
+    if (m_vehicle->sendControl(cmd_buffer, PKT_MCM_LENGTH, timing))
+    {
+        ++m_sent;
+        if (m_failing)
+            Logger::info("Vehicle: flight control requests going out again\n");
+        m_failing = false;
+    }
+    else if (!m_failing)
+    {
+        Logger::err("Vehicle: failed to send flight control request\n");
+        m_failing = true;
+    }
+}
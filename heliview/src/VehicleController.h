@@ -0,0 +1,177 @@
+// -----------------------------------------------------------------------------
+// File:    VehicleController.h
+// Created: 10-17-2026
+//
+// Controller for a vehicle that speaks the uav_protocol.h packet set. Builds
+// the commands and handles the vehicle's packets, whatever carries them; the
+// link itself (tcp, serial) belongs to the subclass. Flight control goes out
+// from a thread of its own at a fixed rate, each packet carrying a stick change
+// is timed from the pad's event to the write.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_VEHICLECONTROLLER__H_
+#define _HELIVIEW_VEHICLECONTROLLER__H_
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include "ControlLatency.h"
+#include "DeviceController.h"
+#include "PacketFramer.h"
+#include "Utility.h"
+
+#define VEHICLE_CONTROL_MS      50      // throttle hold resend period
+#define VEHICLE_CONTROL_HZ      50      // default control loop rate
+#define VEHICLE_CONTROL_MIN_HZ  50
+#define VEHICLE_CONTROL_MAX_HZ  200
+#define VEHICLE_RT_PRIORITY     20      // SCHED_FIFO priority for "rt"
+
+#define CONTROL_MODE_MIXED      0x100   // above the AXIS_* bits
+#define CONTROL_MODE_THROTTLE   0x200
+
+typedef struct ctl_sigs
+{
+    float alt, pitch, roll, yaw;
+} ctl_sigs_t;
+
+class VehicleController;
+
+// -----------------------------------------------------------------------------
+// Samples the gamepad at a fixed rate and sends the vehicle at most one flight
+// control packet per tick. Paced by a timerfd where there is one, so the period
+// doesn't depend on how busy the GUI thread is.
+class VehicleControlThread: public QThread
+{
+public:
+    VehicleControlThread(VehicleController *vehicle, int rate, int priority);
+    virtual ~VehicleControlThread();
+
+    virtual void run();
+    virtual void stop();
+
+    // any thread
+    void setGamepad(Gamepad *gamepad);
+    void setMode(bool mixed, int axes, bool throttle);
+
+protected:
+    void runTimer();
+    void runSleep();
+    void raisePriority();
+    void tick();
+
+    VehicleController *m_vehicle;
+    int                m_rate;
+    uint64_t           m_period;        // usec
+    int                m_priority;      // SCHED_FIFO, 0 for none
+#ifdef PLATFORM_UNIX_GCC
+    int                m_timer_fd;
+    int                m_stop_fd;       // eventfd, written to stop
+#endif
+    QMutex             m_gamepad_lock;  // held only to swap or sample the pad
+    Gamepad           *m_gamepad;
+    QAtomicInt         m_mode;          // AXIS_* | CONTROL_MODE_*
+    QAtomicInt         m_active;
+
+    // loop thread only
+    int                m_last_mode;
+    ctl_sigs_t         m_prev;          // what the vehicle last heard
+    uint64_t           m_hold_elapsed;  // usec since the last throttle hold
+    bool               m_failing;
+    uint64_t           m_ticks;
+    uint64_t           m_overruns;      // ticks missed entirely
+    uint64_t           m_worst_late;    // usec past a tick before waking
+    uint64_t           m_sent;
+};
+
+// -----------------------------------------------------------------------------
+class VehicleController: public DeviceController, public PacketHandler,
+    public ControlTimingSink
+{
+    Q_OBJECT
+
+public:
+    VehicleController();
+    virtual ~VehicleController();
+
+    virtual DeviceState currentState() const { return m_state; }
+    virtual int currentAxes() const { return m_axes; }
+    virtual TrackSettings currentTrackSettings() const { return m_track; }
+    virtual bool getTrackEnabled() const { return m_track_en; }
+
+    virtual bool requestDeviceControls() const;
+    virtual bool requestFilterSettings() const;
+    virtual bool requestTrimSettings() const;
+    virtual bool requestPIDSettings(int axis) const;
+
+    virtual bool requestTakeoff() const;
+    virtual bool requestLanding() const;
+    virtual bool requestManualOverride() const;
+    virtual bool requestAutonomous() const;
+    virtual bool requestKillswitch() const;
+    virtual bool requestColors() const;
+
+    virtual void setGamepad(Gamepad *gamepad);
+
+    virtual ControlLatency controlLatency() const;
+    virtual QVector<ControlTiming> controlTimings() const;
+
+    // any thread, once a timed flight control packet has been written
+    virtual void recordControl(const ControlTiming &timing);
+
+    // the packets any link delivers alike, subclasses take their own first
+    virtual void processPacket(const uint32_t *packet,
+            const PacketTiming &timing);
+
+public slots:
+    void onInputReady(GamepadEvent event, int index, float value);
+
+    void updateTrackSettings(int r, int g, int b, int ht, int st, int ft, int fps);
+    void onUpdateTrackControlEnable(int track_en);
+    void onUpdateColorTrackEnable(int track_en);
+    void updateDeviceControl(int id, int value);
+    void updateTrimSettings(int axes, int value);
+    void updateFilterSettings(int signal, int samples);
+    void updatePIDSettings(int axis, int signal, float value);
+
+protected:
+    friend class VehicleControlThread;
+
+    // hand a complete packet to the link, false if it can't be sent. also
+    // called from the control thread, for CLIENT_REQ_FLIGHT_CTL only
+    virtual bool sendPacket(uint32_t *buffer, int length) const = 0;
+    bool sendPacket(uint32_t command) const;
+
+    // a flight control packet, stamping timing.written once it's on the
+    // link and recording it. links that write later record it themselves
+    virtual bool sendControl(uint32_t *buffer, int length,
+            ControlTiming &timing);
+
+    // startControl() when the link opens, enableControl() while the vehicle
+    // is there to listen, stopControl() before the link goes away
+    void startControl(const DeviceOptions &options);
+    void stopControl();
+    void enableControl(bool enable);
+    void updateControlMode();
+    bool requestControlMode(DeviceState state, int axes) const;
+    bool subscribe(uint32_t channel, uint32_t rate) const;
+
+    VehicleControlThread *m_control;
+    Gamepad          *m_gamepad;
+    int               m_control_rate;
+    int               m_control_priority;
+    bool              m_throttle_en;
+    DeviceState       m_state;
+    int               m_axes;
+    TrackSettings     m_track;
+    bool              m_track_en;
+    int               m_tce;
+    int               m_cte;
+
+    mutable QMutex    m_latency_lock;   // control, link and GUI threads
+    ControlLatency    m_latency;
+    QVector<ControlTiming> m_timings;   // ring of the latest, for export
+    int               m_timings_next;
+};
+
+#endif // _HELIVIEW_VEHICLECONTROLLER__H_
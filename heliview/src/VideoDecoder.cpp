@@ -0,0 +1,180 @@
+// -----------------------------------------------------------------------------
+// File:    VideoDecoder.cpp
+// Created: 10-17-2026
+//
+// Worker thread mjpg decoder with latest-frame-wins dropping.
+// -----------------------------------------------------------------------------
+
+#include <QBuffer>
+#include <QImageReader>
+#include <QTransform>
+#include "Logger.h"
+#include "VideoDecoder.h"
+
+// -----------------------------------------------------------------------------
+VideoDecoder::VideoDecoder()
+: m_hasFrame(false), m_hasImage(false), m_active(true), m_angle(0),
+  m_notifyPending(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+VideoDecoder::~VideoDecoder()
+{
+    stop();
+    wait();
+}
+
+// -----------------------------------------------------------------------------
+void VideoDecoder::submit(const QByteArray &frame, const FrameTiming &timing)
+{
+    QMutexLocker lock(&m_lock);
+    m_stats.received++;
+    if (m_hasFrame)
+        m_stats.dropped++;
+    m_frame = frame;
+    m_timing = timing;
+    m_hasFrame = true;
+    m_wake.wakeOne();
+}
+
+// -----------------------------------------------------------------------------
+void VideoDecoder::setRotation(int angle)
+{
+    QMutexLocker lock(&m_lock);
+    m_angle = angle;
+}
+
+// -----------------------------------------------------------------------------
+void VideoDecoder::setTargetSize(const QSize &size)
+{
+    QMutexLocker lock(&m_lock);
+    m_target = size;
+}
+
+// -----------------------------------------------------------------------------
+bool VideoDecoder::takeFrame(VideoFrame &frame)
+{
+    // re-arm before looking so an image published meanwhile notifies again
+    m_notifyPending.fetchAndStoreOrdered(0);
+
+    QMutexLocker lock(&m_lock);
+    if (!m_hasImage)
+        return false;
+
+    frame = m_decoded;
+    m_decoded = VideoFrame();
+    m_hasImage = false;
+    m_stats.displayed++;
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+VideoDecodeStats VideoDecoder::stats() const
+{
+    QMutexLocker lock(&m_lock);
+    return m_stats;
+}
+
+// -----------------------------------------------------------------------------
+void VideoDecoder::stop()
+{
+    QMutexLocker lock(&m_lock);
+    m_active = false;
+    m_wake.wakeOne();
+}
+
+// -----------------------------------------------------------------------------
+void VideoDecoder::run()
+{
+    for (;;)
+    {
+        VideoFrame frame;
+        QSize target;
+        {
+            QMutexLocker lock(&m_lock);
+            while (m_active && !m_hasFrame)
+                m_wake.wait(&m_lock);
+            if (!m_active)
+                return;
+
+            frame.data = m_frame;
+            m_frame = QByteArray();
+            frame.timing = m_timing;
+            m_hasFrame = false;
+            frame.angle = m_angle;
+            target = m_target;
+        }
+
+        uint64_t start = MonotonicMicros();
+        frame.image = decode(frame.data, frame.angle, target, &frame.size);
+        frame.timing.decoded = MonotonicMicros();
+        uint64_t elapsed = frame.timing.decoded - start;
+
+        {
+            QMutexLocker lock(&m_lock);
+            if (frame.image.isNull())
+            {
+                m_stats.failed++;
+                continue;
+            }
+
+            m_stats.decoded++;
+            m_stats.decode_time.record(elapsed);
+            if (m_hasImage)
+                m_stats.dropped++;
+            m_decoded = frame;
+            m_hasImage = true;
+        }
+
+        // one notification in flight at a time, the view always takes the
+        // newest image whenever it gets around to it
+        if (m_notifyPending.testAndSetOrdered(0, 1))
+            emit imageReady();
+    }
+}
+
+// -----------------------------------------------------------------------------
+QImage VideoDecoder::decode(const QByteArray &data, int angle,
+        const QSize &target, QSize *full)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer, "jpeg");
+
+    // the target is in screen orientation, the jpeg isn't rotated yet
+    QSize size = reader.size();
+    bool sideways = (90 == angle || 270 == angle);
+    QSize scaled = sideways ? QSize(target.height(), target.width()) : target;
+    if (size.isValid() && scaled.isValid() && !scaled.isEmpty() &&
+        scaled.width() < size.width() && scaled.height() < size.height())
+    {
+        // qt's jpeg handler turns this into libjpeg's scale_num/scale_denom,
+        // so most of the reduction happens before the idct, not after it
+        reader.setScaledSize(scaled);
+    }
+
+    QImage image;
+    if (!reader.read(&image))
+    {
+        Logger::err("Video: failed to load image data\n");
+        return QImage();
+    }
+
+    // only a handler that can't report its size leaves this to the decode,
+    // and then nothing was scaled either
+    if (!size.isValid())
+        size = image.size();
+
+    if (full)
+        *full = sideways ? QSize(size.height(), size.width()) : size;
+
+    if (0 != angle)
+    {
+        QTransform trans;
+        trans.rotate(angle);
+        image = image.transformed(trans);
+    }
+    return image;
+}
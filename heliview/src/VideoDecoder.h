@@ -0,0 +1,94 @@
+// -----------------------------------------------------------------------------
+// File:    VideoDecoder.h
+// Created: 10-17-2026
+//
+// Decodes mjpg frames on a worker thread. Both ends hold a single slot, so a
+// frame that arrives before the last one was decoded replaces it, and a decoded
+// image the view hasn't picked up yet is replaced by a newer one. Frames are
+// decoded straight to the display size; the jpeg decoder scales in the DCT
+// domain, so a downscaled decode costs a fraction of a full one.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_VIDEODECODER__H_
+#define _HELIVIEW_VIDEODECODER__H_
+
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QImage>
+#include <QMutex>
+#include <QSize>
+#include <QThread>
+#include <QWaitCondition>
+#include "LatencyHistogram.h"
+#include "VideoLatency.h"
+
+struct VideoDecodeStats
+{
+    VideoDecodeStats()
+    : received(0), decoded(0), displayed(0), failed(0), dropped(0) { }
+
+    uint64_t received;      // frames handed to submit()
+    uint64_t decoded;
+    uint64_t displayed;     // images taken by the view
+    uint64_t failed;        // frames that weren't valid images
+    uint64_t dropped;       // replaced before decode or before display
+    LatencyHistogram decode_time;
+};
+
+// a decoded frame along with what's needed to decode it again at full size
+struct VideoFrame
+{
+    VideoFrame() : angle(0) { }
+
+    QByteArray data;        // the jpeg as received
+    QImage     image;       // decoded at (or just above) the target size
+    QSize      size;        // full resolution size, after rotation
+    int        angle;
+    FrameTiming timing;
+};
+
+class VideoDecoder: public QThread
+{
+    Q_OBJECT
+
+public:
+    VideoDecoder();
+    virtual ~VideoDecoder();
+
+    // producer side, returns straight away
+    void submit(const QByteArray &frame,
+            const FrameTiming &timing = FrameTiming());
+    void setRotation(int angle);
+    void setTargetSize(const QSize &size);
+
+    // consumer side, false if nothing new was decoded since the last call
+    bool takeFrame(VideoFrame &frame);
+
+    // decode and rotate, scaled down towards target if it's valid and smaller
+    static QImage decode(const QByteArray &data, int angle,
+            const QSize &target = QSize(), QSize *full = NULL);
+
+    VideoDecodeStats stats() const;
+    void stop();
+
+signals:
+    void imageReady();
+
+protected:
+    virtual void run();
+
+    mutable QMutex  m_lock;
+    QWaitCondition  m_wake;
+    QByteArray      m_frame;        // newest undecoded frame
+    FrameTiming     m_timing;       // and how it got here
+    VideoFrame      m_decoded;      // newest decoded frame
+    QSize           m_target;
+    bool            m_hasFrame;
+    bool            m_hasImage;
+    bool            m_active;
+    int             m_angle;
+    QAtomicInt      m_notifyPending;
+    VideoDecodeStats m_stats;
+};
+
+#endif // _HELIVIEW_VIDEODECODER__H_
@@ -0,0 +1,63 @@
+// -----------------------------------------------------------------------------
+// File:    VideoLatency.cpp
+// Created: 10-17-2026
+//
+// Video pipeline latency breakdown.
+// -----------------------------------------------------------------------------
+
+#include <QObject>
+#include "VideoLatency.h"
+
+// -----------------------------------------------------------------------------
+VideoLatency::VideoLatency()
+: m_frames(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+void VideoLatency::reset()
+{
+    for (int i = 0; i < STAGE_COUNT; ++i)
+        m_stages[i].reset();
+    m_frames = 0;
+}
+
+// -----------------------------------------------------------------------------
+void VideoLatency::record(const FrameTiming &timing)
+{
+    // each stage needs both of its ends, and clocks only move forwards
+    const uint64_t points[] = { timing.requested, timing.first_byte,
+        timing.last_byte, timing.received, timing.decoded, timing.painted };
+
+    for (int i = STAGE_REQUEST; i < STAGE_TOTAL; ++i)
+    {
+        if (points[i] && points[i + 1] && points[i + 1] >= points[i])
+            m_stages[i].record(points[i + 1] - points[i]);
+    }
+
+    for (int i = 0; i < STAGE_TOTAL; ++i)
+    {
+        if (points[i] && timing.painted >= points[i])
+        {
+            m_stages[STAGE_TOTAL].record(timing.painted - points[i]);
+            break;
+        }
+    }
+    m_frames++;
+}
+
+// -----------------------------------------------------------------------------
+const char *VideoLatency::stageName(int stage)
+{
+    static const char *names[STAGE_COUNT] = {
+        "request", "transfer", "dispatch", "decode", "paint", "total"
+    };
+    return names[stage];
+}
+
+// -----------------------------------------------------------------------------
+QString VideoLatency::summary() const
+{
+    return LatencySummary(QObject::tr("Video latency over %1 frames (ms):\n")
+            .arg(m_frames), m_stages, STAGE_COUNT, stageName);
+}
@@ -0,0 +1,63 @@
+// -----------------------------------------------------------------------------
+// File:    VideoLatency.h
+// Created: 10-17-2026
+//
+// Per-frame timestamps through the video pipeline (poll, first and last byte
+// off the socket, handed to the view, decoded, painted) and histograms of the
+// time spent between each pair of them.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_VIDEOLATENCY__H_
+#define _HELIVIEW_VIDEOLATENCY__H_
+
+#include <QString>
+#include "LatencyHistogram.h"
+
+// MonotonicMicros() at each point a frame passed, 0 where it's not known
+// (pushed frames have no request, replayed frames no socket)
+struct FrameTiming
+{
+    FrameTiming()
+    : requested(0), first_byte(0), last_byte(0), received(0), decoded(0),
+      painted(0) { }
+
+    uint64_t requested;
+    uint64_t first_byte;
+    uint64_t last_byte;
+    uint64_t received;
+    uint64_t decoded;
+    uint64_t painted;
+};
+
+enum VideoLatencyStage
+{
+    STAGE_REQUEST,      // poll sent to first byte back
+    STAGE_TRANSFER,     // first byte to last byte
+    STAGE_DISPATCH,     // last byte to the view (framing, queues, signals)
+    STAGE_DECODE,       // view to decoded image, waiting for the worker too
+    STAGE_PAINT,        // decoded image to painted
+    STAGE_TOTAL,        // earliest known point to painted
+    STAGE_COUNT,
+};
+
+class VideoLatency
+{
+public:
+    VideoLatency();
+
+    void record(const FrameTiming &timing);
+    void reset();
+
+    uint64_t frames() const { return m_frames; }
+    const LatencyHistogram &stage(int stage) const { return m_stages[stage]; }
+    static const char *stageName(int stage);
+
+    // one line per stage with p50/p95/p99/max in milliseconds
+    QString summary() const;
+
+protected:
+    LatencyHistogram m_stages[STAGE_COUNT];
+    uint64_t         m_frames;
+};
+
+#endif // _HELIVIEW_VIDEOLATENCY__H_
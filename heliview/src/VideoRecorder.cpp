@@ -0,0 +1,256 @@
+// -----------------------------------------------------------------------------
+// File:    VideoRecorder.cpp
+// Created: 10-17-2026
+//
+// Background writer for raw mjpg recordings and frame snapshots.
+// -----------------------------------------------------------------------------
+
+#include <QDateTime>
+#include <cstring>
+#include "Logger.h"
+#include "VideoRecorder.h"
+
+// -----------------------------------------------------------------------------
+VideoRecorder::VideoRecorder()
+: m_pending(0), m_dropped(0), m_open(false), m_active(true), m_offset(0),
+  m_bytes(0)
+{
+}
+
+// -----------------------------------------------------------------------------
+VideoRecorder::~VideoRecorder()
+{
+    close();
+    stop();
+    wait();
+}
+
+// -----------------------------------------------------------------------------
+void VideoRecorder::open(const QString &path)
+{
+    Job job;
+    job.type = JOB_OPEN;
+    job.path = path;
+    job.timestamp = 0;
+
+    QMutexLocker lock(&m_lock);
+    m_open = true;
+    m_dropped = 0;
+    m_jobs.enqueue(job);
+    m_wake.wakeOne();
+}
+
+// -----------------------------------------------------------------------------
+void VideoRecorder::close()
+{
+    Job job;
+    job.type = JOB_CLOSE;
+    job.timestamp = 0;
+
+    QMutexLocker lock(&m_lock);
+    if (!m_open)
+        return;
+    m_open = false;
+    m_jobs.enqueue(job);
+    m_wake.wakeOne();
+}
+
+// -----------------------------------------------------------------------------
+void VideoRecorder::append(const QByteArray &frame, uint64_t timestamp)
+{
+    Job job;
+    job.type = JOB_FRAME;
+    job.data = frame;
+    job.timestamp = timestamp;
+
+    QMutexLocker lock(&m_lock);
+    if (!m_open)
+        return;
+
+    // a disk that can't keep up costs frames, never gui time or memory
+    if (m_pending + frame.size() > VIDEOREC_MAX_PENDING)
+    {
+        m_dropped++;
+        return;
+    }
+
+    m_pending += frame.size();
+    m_jobs.enqueue(job);
+    m_wake.wakeOne();
+}
+
+// -----------------------------------------------------------------------------
+void VideoRecorder::saveFrame(const QByteArray &frame, const QString &path)
+{
+    Job job;
+    job.type = JOB_SNAPSHOT;
+    job.data = frame;
+    job.path = path;
+    job.timestamp = 0;
+    queue(job);
+}
+
+// -----------------------------------------------------------------------------
+void VideoRecorder::queue(const Job &job)
+{
+    QMutexLocker lock(&m_lock);
+    m_jobs.enqueue(job);
+    m_wake.wakeOne();
+}
+
+// -----------------------------------------------------------------------------
+bool VideoRecorder::isOpen() const
+{
+    QMutexLocker lock(&m_lock);
+    return m_open;
+}
+
+// -----------------------------------------------------------------------------
+uint64_t VideoRecorder::dropped() const
+{
+    QMutexLocker lock(&m_lock);
+    return m_dropped;
+}
+
+// -----------------------------------------------------------------------------
+void VideoRecorder::stop()
+{
+    QMutexLocker lock(&m_lock);
+    m_active = false;
+    m_wake.wakeOne();
+}
+
+// -----------------------------------------------------------------------------
+void VideoRecorder::run()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            // finish whatever is queued before honouring a stop
+            QMutexLocker lock(&m_lock);
+            while (m_active && m_jobs.isEmpty())
+                m_wake.wait(&m_lock);
+            if (m_jobs.isEmpty())
+                break;
+
+            job = m_jobs.dequeue();
+            if (JOB_FRAME == job.type)
+                m_pending -= job.data.size();
+        }
+
+        switch (job.type)
+        {
+        case JOB_OPEN:
+            openFile(job.path);
+            break;
+        case JOB_CLOSE:
+            closeFile();
+            break;
+        case JOB_FRAME:
+            writeFrame(job);
+            break;
+        case JOB_SNAPSHOT:
+            writeSnapshot(job);
+            break;
+        }
+    }
+
+    closeFile();
+}
+
+// -----------------------------------------------------------------------------
+void VideoRecorder::openFile(const QString &path)
+{
+    closeFile();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+    {
+        Logger::err(QObject::tr("Video: unable to record to %1\n").arg(path));
+        QMutexLocker lock(&m_lock);
+        m_open = false;
+        return;
+    }
+
+    VideoFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, VIDEOREC_MAGIC, sizeof(header.magic));
+    header.version = VIDEOREC_VERSION;
+    header.created = (uint64_t)QDateTime::currentDateTime().toTime_t() * 1000;
+    m_file.write((const char *)&header, sizeof(header));
+
+    m_index.clear();
+    m_offset = sizeof(header);
+    m_bytes = 0;
+    Logger::info(QObject::tr("Video: recording to %1\n").arg(path));
+}
+
+// -----------------------------------------------------------------------------
+void VideoRecorder::closeFile()
+{
+    if (!m_file.isOpen())
+        return;
+
+    VideoFileTrailer trailer;
+    memcpy(trailer.magic, VIDEOREC_INDEX_MAGIC, sizeof(trailer.magic));
+    trailer.index_offset = m_offset;
+    trailer.count = m_index.size();
+
+    m_file.write((const char *)m_index.constData(),
+                 m_index.size() * sizeof(VideoIndexEntry));
+    m_file.write((const char *)&trailer, sizeof(trailer));
+    m_file.close();
+
+    Logger::info(QObject::tr("Video: recorded %1 frames (%2 MB) to %3, "
+                "%4 dropped\n").arg(m_index.size())
+            .arg(m_bytes / 1048576.0, 0, 'f', 1).arg(m_file.fileName())
+            .arg(dropped()));
+    m_index.clear();
+}
+
+// -----------------------------------------------------------------------------
+void VideoRecorder::writeFrame(const Job &job)
+{
+    if (!m_file.isOpen())
+        return;
+
+    VideoFrameHeader header;
+    header.timestamp = job.timestamp;
+    header.length = (uint32_t)job.data.size();
+    header.reserved = 0;
+
+    if ((qint64)sizeof(header) !=
+            m_file.write((const char *)&header, sizeof(header)) ||
+        job.data.size() != m_file.write(job.data))
+    {
+        Logger::err(QObject::tr("Video: write to %1 failed, recording stopped\n")
+                .arg(m_file.fileName()));
+        closeFile();
+        QMutexLocker lock(&m_lock);
+        m_open = false;
+        return;
+    }
+
+    VideoIndexEntry entry;
+    entry.timestamp = job.timestamp;
+    entry.offset = m_offset;
+    m_index.append(entry);
+
+    m_offset += sizeof(header) + job.data.size();
+    m_bytes += job.data.size();
+}
+
+// -----------------------------------------------------------------------------
+void VideoRecorder::writeSnapshot(const Job &job)
+{
+    QFile file(job.path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) ||
+        job.data.size() != file.write(job.data))
+    {
+        Logger::warn(QObject::tr("Video: failed to save frame as %1\n")
+                .arg(job.path));
+        return;
+    }
+    Logger::info(QObject::tr("Video: saved frame as %1\n").arg(job.path));
+}
@@ -0,0 +1,119 @@
+// -----------------------------------------------------------------------------
+// File:    VideoRecorder.h
+// Created: 10-17-2026
+//
+// Writes received mjpg frames, byte for byte, to an indexed video file on a
+// background thread, and saves single frames the same way.
+//
+// File layout, all integers little endian:
+//   VideoFileHeader
+//   per frame: VideoFrameHeader followed by the jpeg bytes
+//   on close:  VideoIndexEntry per frame, then VideoFileTrailer
+// A file whose recording was cut short lacks the index and trailer, but the
+// length-prefixed frames can still be walked from the start.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_VIDEORECORDER__H_
+#define _HELIVIEW_VIDEORECORDER__H_
+
+#include <QByteArray>
+#include <QFile>
+#include <QMutex>
+#include <QQueue>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+#include "Utility.h"
+
+#define VIDEOREC_MAGIC          "HVVID01"
+#define VIDEOREC_INDEX_MAGIC    "HVVIDX1"
+#define VIDEOREC_VERSION        1
+#define VIDEOREC_MAX_PENDING    (32 * 1024 * 1024)  // queued bytes before drops
+
+struct VideoFileHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t reserved;
+    uint64_t created;       // wall clock, ms since the epoch
+};
+
+struct VideoFrameHeader
+{
+    uint64_t timestamp;     // MonotonicMicros() when the frame arrived
+    uint32_t length;        // jpeg bytes that follow
+    uint32_t reserved;
+};
+
+struct VideoIndexEntry
+{
+    uint64_t timestamp;
+    uint64_t offset;        // of the frame's VideoFrameHeader
+};
+
+struct VideoFileTrailer
+{
+    char     magic[8];
+    uint64_t index_offset;
+    uint64_t count;
+};
+
+class VideoRecorder: public QThread
+{
+    Q_OBJECT
+
+public:
+    VideoRecorder();
+    virtual ~VideoRecorder();
+
+    // all of these queue work for the writer and return straight away
+    void open(const QString &path);
+    void close();
+    void append(const QByteArray &frame, uint64_t timestamp);
+    void saveFrame(const QByteArray &frame, const QString &path);
+
+    bool isOpen() const;
+    uint64_t dropped() const;
+    void stop();
+
+protected:
+    enum JobType
+    {
+        JOB_OPEN,
+        JOB_CLOSE,
+        JOB_FRAME,
+        JOB_SNAPSHOT,
+    };
+
+    struct Job
+    {
+        JobType    type;
+        QByteArray data;
+        QString    path;
+        uint64_t   timestamp;
+    };
+
+    virtual void run();
+    void queue(const Job &job);
+    void openFile(const QString &path);
+    void closeFile();
+    void writeFrame(const Job &job);
+    void writeSnapshot(const Job &job);
+
+    // shared with the gui thread, guarded by m_lock
+    mutable QMutex          m_lock;
+    QWaitCondition          m_wake;
+    QQueue<Job>             m_jobs;
+    qint64                  m_pending;      // frame bytes in m_jobs
+    uint64_t                m_dropped;
+    bool                    m_open;
+    bool                    m_active;
+
+    // writer thread only
+    QFile                   m_file;
+    QVector<VideoIndexEntry> m_index;
+    uint64_t                m_offset;
+    uint64_t                m_bytes;
+};
+
+#endif // _HELIVIEW_VIDEORECORDER__H_
@@ -8,6 +8,7 @@
 // -----------------------------------------------------------------------------
 
 #include <QDebug>
+#include <QBuffer>
 #include <QDateTime>
 #include <QPainter>
 #include <QTimer>
@@ -17,30 +18,69 @@
 
 // -----------------------------------------------------------------------------
 VideoView::VideoView(QWidget *parent)
-: QWidget(parent), m_image(":/data/test_pattern.jpg"), m_angle(0), m_ticks(0),
-  m_maxTicks(25), m_showBox(false), m_dragging(false), m_colorTrack(false), 
-  m_bbox(0, 0, 0, 0), m_dp(0, 0, 0, 0)
+: QWidget(parent), m_overlayMatched(0), m_preview(NULL),
+  m_groundTracker(NULL), m_decoder(NULL), m_recorder(NULL),
+  m_latencyLogged(0), m_angle(0), m_ticks(0), m_maxTicks(25),
+  m_statsTicks(0), m_latencyTicks(0), m_showBox(false), m_dragging(false),
+  m_colorTrack(false), m_framePainted(true), m_showThreshold(false),
+  m_groundTracking(false), m_bbox(0, 0, 0, 0), m_dp(0, 0, 0, 0)
 {
+    // frames are decoded off the gui thread, we only ever see the newest
+    m_decoder = new VideoDecoder();
+    connect(m_decoder, SIGNAL(imageReady()), this, SLOT(onImageReady()),
+            Qt::QueuedConnection);
+    m_decoder->start();
+
+    // recordings and snapshots are written off the gui thread too
+    m_recorder = new VideoRecorder();
+    m_recorder->start();
+
+    // threshold previews are worked out off the gui thread as well
+    m_preview = new ThresholdPreview();
+    connect(m_preview, SIGNAL(overlayReady()), this, SLOT(onOverlayReady()),
+            Qt::QueuedConnection);
+    m_preview->start();
+
+    // and so is the ground side tracker, which spreads big frames over
+    // the thread pool
+    m_groundTracker = new GroundTracker();
+    connect(m_groundTracker, SIGNAL(resultReady()), this,
+            SLOT(onGroundResult()), Qt::QueuedConnection);
+    m_groundTracker->start();
+
     // create a timer to serve as a simple video feed heartbeat check
     m_timer = new QTimer(this);
     connect(m_timer, SIGNAL(timeout()), this, SLOT(onStatusTick()));
     m_timer->start(100);
 
+    // every paint covers its whole region with the retained frame
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
     m_dragBrush.setStyle(Qt::SolidPattern);
     m_bboxBrush.setStyle(Qt::SolidPattern);
     
     m_bboxPen.setWidth(3);
 
+    // the ground tracker's box sits beside the vehicle's, dashed to tell
+    // the two apart
+    m_groundPen.setWidth(2);
+    m_groundPen.setStyle(Qt::DashLine);
+    m_groundPen.setColor(Qt::cyan);
+
     setDragBoxColor(255, 0, 0, 25);
     setBoundingBoxColor(255, 0, 0, 0);
 
-    repaint();
+    showTestPattern();
 }
 
 // -----------------------------------------------------------------------------
 VideoView::~VideoView()
 {
     SafeDelete(m_timer);
+    SafeDelete(m_decoder);
+    SafeDelete(m_recorder);
+    SafeDelete(m_preview);
+    SafeDelete(m_groundTracker);
 }
 
 // -----------------------------------------------------------------------------
@@ -61,6 +101,18 @@ int VideoView::timeoutTicks()
     return m_maxTicks;
 }
 
+// -----------------------------------------------------------------------------
+VideoDecodeStats VideoView::decodeStats() const
+{
+    return m_decoder->stats();
+}
+
+// -----------------------------------------------------------------------------
+GroundTrackStats VideoView::groundStats() const
+{
+    return m_groundTracker->stats();
+}
+
 // -----------------------------------------------------------------------------
 int VideoView::rotation()
 {
@@ -88,65 +140,147 @@ void VideoView::setTimeoutTicks(int ticks)
     m_maxTicks = ticks;
 }
 
+// -----------------------------------------------------------------------------
+bool VideoView::trackOverlay(QRect &box, QPoint &center)
+{
+    if (!m_showBox || !m_colorTrack || m_frame.size.isEmpty())
+        return false;
+
+    // tracking coordinates are in the vehicle's full resolution frame
+    int x_s, y_s, w_s, h_s, xc_s, yc_s;
+    float xscale = width() / (float)m_frame.size.width();
+    float yscale = height() / (float)m_frame.size.height();
+
+    // scale coordinates from client to jpeg image dimensions
+    if (m_angle == 90)
+    {
+        w_s = (int)(m_bbox.height() * xscale);
+        h_s = (int)(m_bbox.width() * yscale);
+        x_s = width() - (int)(m_bbox.y() * xscale) - w_s;
+        y_s = (int)(m_bbox.x() * yscale);
+        xc_s = width() - (int)(m_center.y() * xscale);
+        yc_s = (int)(m_center.x() * yscale);
+    }
+    else if (m_angle == 180)
+    {
+        w_s = (int)(m_bbox.width() * xscale);
+        h_s = (int)(m_bbox.height() * yscale);
+        x_s = width() - (int)(m_bbox.x() * xscale) - w_s;
+        y_s = height() - (int)(m_bbox.y() * yscale) - h_s;
+        xc_s = width() - (int)(m_center.x() * xscale);
+        yc_s = height() - (int)(m_center.y() * yscale);
+    }
+    else if (m_angle == 270)
+    {
+        w_s = (int)(m_bbox.height() * xscale);
+        h_s = (int)(m_bbox.width() * yscale);
+        x_s = (int)(m_bbox.y() * xscale);
+        y_s = height() - (int)(m_bbox.x() * yscale) - h_s;
+        xc_s = (int)(m_center.y() * xscale);
+        yc_s = height() - (int)(m_center.x() * yscale);
+    }
+    else
+    {
+        x_s = (int)(m_bbox.x() * xscale);
+        y_s = (int)(m_bbox.y() * yscale);
+        w_s = (int)(m_bbox.width() * xscale);
+        h_s = (int)(m_bbox.height() * yscale);
+        xc_s = (int)(m_center.x() * xscale);
+        yc_s = (int)(m_center.y() * yscale);
+    }
+
+    box.setRect(x_s, y_s, w_s, h_s);
+    center = QPoint(xc_s, yc_s);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+QRect VideoView::trackDirtyRect()
+{
+    QRect box;
+    QPoint center;
+    if (!trackOverlay(box, center))
+        return QRect();
+
+    // the pen straddles the outline and the cross may poke past a thin box
+    int margin = m_bboxPen.width() + std::min(box.width(), box.height()) / 20;
+    return box.united(QRect(center, center))
+              .adjusted(-margin, -margin, margin + 1, margin + 1);
+}
+
+// -----------------------------------------------------------------------------
+bool VideoView::groundOverlay(QRect &box, QPoint &center)
+{
+    if (!m_groundTracking || !m_ground.found || m_groundSize.isEmpty())
+        return false;
+
+    // ground results are in the decoded (already rotated) frame
+    float xscale = width() / (float)m_groundSize.width();
+    float yscale = height() / (float)m_groundSize.height();
+    box.setCoords((int)(m_ground.x1 * xscale), (int)(m_ground.y1 * yscale),
+            (int)((m_ground.x2 + 1) * xscale), (int)((m_ground.y2 + 1) * yscale));
+    center = QPoint((int)(m_ground.xc * xscale), (int)(m_ground.yc * yscale));
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+QRect VideoView::groundDirtyRect()
+{
+    QRect box;
+    QPoint center;
+    if (!groundOverlay(box, center))
+        return QRect();
+
+    // room for the pen, the cross and the label above the box
+    int margin = m_groundPen.width() + std::min(box.width(), box.height()) / 20;
+    QRect label(box.left(), box.top() - fontMetrics().height() - 2,
+            fontMetrics().width(tr("ground")) + 2, fontMetrics().height() + 2);
+    return box.united(QRect(center, center)).united(label)
+              .adjusted(-margin, -margin, margin + 1, margin + 1);
+}
+
 // -----------------------------------------------------------------------------
 void VideoView::paintEvent(QPaintEvent *e)
 {
-    // first render the video feed (or test image) into the client area
+    // the frame is retained as a widget sized pixmap, so only the damaged
+    // part of it is copied back before the overlays go on top
     QPainter painter(this);
+    painter.drawPixmap(e->rect(), m_pixmap, e->rect());
+    if (m_showThreshold && !m_overlayPixmap.isNull())
+    {
+        painter.drawPixmap(e->rect(), m_overlayPixmap, e->rect());
+        painter.setPen(Qt::white);
+        painter.drawText(rect().adjusted(4, 4, -4, -4),
+                Qt::AlignLeft | Qt::AlignTop, tr("%1% selected").arg(
+                    100.0 * m_overlayMatched / std::max(1, m_overlay.width() *
+                        m_overlay.height()), 0, 'f', 1));
+    }
     painter.setRenderHint(QPainter::Antialiasing, true);
-    painter.drawImage(0, 0, m_image.scaled(width(), height()));
 
-    if (m_showBox && m_colorTrack)
+    QRect box;
+    QPoint c;
+    if (trackOverlay(box, c))
     {
-        int x_s, y_s, w_s, h_s, xc_s, yc_s, ln_m;
-        float xscale = width() / (float)m_image.width();
-        float yscale = height() / (float)m_image.height();
-
-        // scale coordinates from client to jpeg image dimensions
-        if (m_angle == 90)
-        {
-            w_s = (int)(m_bbox.height() * xscale);
-            h_s = (int)(m_bbox.width() * yscale);
-            x_s = width() - (int)(m_bbox.y() * xscale) - w_s;
-            y_s = (int)(m_bbox.x() * yscale);
-            xc_s = width() - (int)(m_center.y() * xscale);
-            yc_s = (int)(m_center.x() * yscale);
-        }
-        else if (m_angle == 180)
-        {
-            w_s = (int)(m_bbox.width() * xscale);
-            h_s = (int)(m_bbox.height() * yscale);
-            x_s = width() - (int)(m_bbox.x() * xscale) - w_s;
-            y_s = height() - (int)(m_bbox.y() * yscale) - h_s;
-            xc_s = width() - (int)(m_center.x() * xscale);
-            yc_s = height() - (int)(m_center.y() * yscale);
-        }
-        else if (m_angle == 270)
-        {
-            w_s = (int)(m_bbox.height() * xscale);
-            h_s = (int)(m_bbox.width() * yscale);
-            x_s = (int)(m_bbox.y() * xscale);
-            y_s = height() - (int)(m_bbox.x() * yscale) - h_s;
-            xc_s = (int)(m_center.y() * xscale);
-            yc_s = height() - (int)(m_center.x() * yscale);
-        }
-        else
-        {
-            x_s = (int)(m_bbox.x() * xscale);
-            y_s = (int)(m_bbox.y() * yscale);
-            w_s = (int)(m_bbox.width() * xscale);
-            h_s = (int)(m_bbox.height() * yscale);
-            xc_s = (int)(m_center.x() * xscale);
-            yc_s = (int)(m_center.y() * yscale);
-        }
-        ln_m = std::min(w_s, h_s) / 20;
+        int ln_m = std::min(box.width(), box.height()) / 20;
 
         // render a wireframe rectangle around the region of interest
         painter.setPen(m_bboxPen);
         painter.setBrush(m_bboxBrush);
-        painter.drawRect(x_s, y_s, w_s, h_s);
-        painter.drawLine(xc_s - ln_m, yc_s - ln_m, xc_s + ln_m, yc_s + ln_m);
-        painter.drawLine(xc_s - ln_m, yc_s + ln_m, xc_s + ln_m, yc_s - ln_m);
+        painter.drawRect(box);
+        painter.drawLine(c.x() - ln_m, c.y() - ln_m, c.x() + ln_m, c.y() + ln_m);
+        painter.drawLine(c.x() - ln_m, c.y() + ln_m, c.x() + ln_m, c.y() - ln_m);
+    }
+
+    if (groundOverlay(box, c))
+    {
+        int ln_m = std::min(box.width(), box.height()) / 20;
+
+        painter.setPen(m_groundPen);
+        painter.setBrush(Qt::NoBrush);
+        painter.drawRect(box);
+        painter.drawLine(c.x() - ln_m, c.y(), c.x() + ln_m, c.y());
+        painter.drawLine(c.x(), c.y() - ln_m, c.x(), c.y() + ln_m);
+        painter.drawText(box.left(), box.top() - 2, tr("ground"));
     }
 
     if (m_dragging)
@@ -156,12 +290,82 @@ void VideoView::paintEvent(QPaintEvent *e)
         painter.setBrush(m_dragBrush);
         painter.drawRect(m_dp.x(), m_dp.y(), m_dp.width(), m_dp.height());
     }
+
+    // the first paint after a new frame is the one that put it on screen
+    if (!m_framePainted)
+    {
+        m_framePainted = true;
+        m_frame.timing.painted = MonotonicMicros();
+        m_latency.record(m_frame.timing);
+    }
 }
 
 // -----------------------------------------------------------------------------
 void VideoView::resizeEvent(QResizeEvent *e)
 {
-    repaint();
+    // the next frame is decoded at the new size, until then stretch this one
+    m_decoder->setTargetSize(size());
+    updatePixmap();
+    updateOverlay();
+    update();
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::updatePixmap()
+{
+    // scaling happens here once per frame (or resize), never per paint
+    if (m_frame.image.size() == size())
+        m_pixmap = QPixmap::fromImage(m_frame.image);
+    else
+        m_pixmap = QPixmap::fromImage(m_frame.image.scaled(size()));
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::updateOverlay()
+{
+    if (m_overlay.isNull())
+        m_overlayPixmap = QPixmap();
+    else if (m_overlay.size() == size())
+        m_overlayPixmap = QPixmap::fromImage(m_overlay);
+    else
+        m_overlayPixmap = QPixmap::fromImage(m_overlay.scaled(size()));
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::submitPreview()
+{
+    if (!m_showThreshold || m_frame.image.isNull())
+        return;
+
+    m_preview->submit(m_frame.image, trackThreshold());
+}
+
+// -----------------------------------------------------------------------------
+ColorThreshold VideoView::trackThreshold() const
+{
+    return ColorThreshold(m_track.color.red(), m_track.color.green(),
+            m_track.color.blue(), m_track.ht, m_track.st);
+}
+
+// -----------------------------------------------------------------------------
+const QImage &VideoView::fullImage()
+{
+    if (m_full.isNull() && !m_frame.data.isEmpty())
+        m_full = VideoDecoder::decode(m_frame.data, m_frame.angle);
+    return m_full;
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::showTestPattern()
+{
+    m_frame = VideoFrame();
+    m_framePainted = true;
+    m_full.load(":/data/test_pattern.jpg");
+    m_frame.image = m_full;
+    m_frame.size = m_full.size();
+    updatePixmap();
+    submitPreview();
+    update();
 }
 
 // -----------------------------------------------------------------------------
@@ -171,12 +375,42 @@ bool VideoView::saveFrame()
     datetime = QDateTime::currentDateTime();
 
     const char *format = "MMM-dd-yyyy_hh-mm-ss-zzz";
-    const char *tstamp = datetime.toString(format).toAscii().constData();
+    QString tstamp = datetime.toString(format);
 
     QString filename = QString("heliview_%1.jpg").arg(tstamp);
     Logger::info(tr("Video: Attempting to save frame as %1\n").arg(filename));
 
-    return (m_image.save(QString(filename)));
+    // the bytes as the vehicle sent them, no decode and no re-encode. only
+    // the test pattern, which never came over the wire, has to be encoded
+    QByteArray data = m_frame.data;
+    if (data.isEmpty())
+    {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        if (!fullImage().save(&buffer, "JPG"))
+            return false;
+    }
+
+    m_recorder->saveFrame(data, filename);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::startRecording(const QString &path)
+{
+    m_recorder->open(path);
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::stopRecording()
+{
+    m_recorder->close();
+}
+
+// -----------------------------------------------------------------------------
+bool VideoView::isRecording() const
+{
+    return m_recorder->isOpen();
 }
 
 // -----------------------------------------------------------------------------
@@ -188,10 +422,10 @@ void VideoView::mouseMoveEvent(QMouseEvent *e)
         int bottom = std::max(0, std::min(e->y(), height() - 1));
 
         // repaint only the union of the old and new drag rectangles
-        QRect old_rect = m_dp;
+        QRect old_rect = m_dp.normalized();
         m_dp.setRight(right);
         m_dp.setBottom(bottom);
-        repaint(old_rect.united(m_dp).adjusted(-1, -1, 1, 1));
+        update(old_rect.united(m_dp.normalized()).adjusted(-1, -1, 1, 1));
     }
 }
 
@@ -210,94 +444,220 @@ void VideoView::mouseReleaseEvent(QMouseEvent *e)
 {
     if (m_dragging && Qt::LeftButton == e->button())
     {
-        // determine the average color of the selected region
-        long avg_r = 0, avg_b = 0, avg_g = 0;
-        float xscale = (float)m_image.width() / width();
-        float yscale = (float)m_image.height() / height();
+        // determine the average color of the selected region, sampled from
+        // the full resolution frame rather than the scaled down display copy
+        const QImage &full = fullImage();
+        bool native = full.format() == QImage::Format_RGB32 ||
+                      full.format() == QImage::Format_ARGB32;
+        const QImage image = native ? full :
+            full.convertToFormat(QImage::Format_RGB32);
+        float xscale = (float)image.width() / width();
+        float yscale = (float)image.height() / height();
 
         QRect coord = m_dp.normalized();
-        int x1 = (int)(xscale * coord.left());
-        int y1 = (int)(yscale * coord.top());
-        int x2 = (int)(xscale * coord.right());
-        int y2 = (int)(yscale * coord.bottom());
-        float inv_pixels = 1.0f / ((y2 - y1 + 1) * (x2 - x1 + 1));
+        int x1 = std::max((int)(xscale * coord.left()), 0);
+        int y1 = std::max((int)(yscale * coord.top()), 0);
+        int x2 = std::min((int)(xscale * coord.right()), image.width() - 1);
+        int y2 = std::min((int)(yscale * coord.bottom()), image.height() - 1);
 
-        for (int y = y1; y <= y2; ++y)
+        if (!image.isNull() && x2 >= x1 && y2 >= y1)
         {
-            for (int x = x1; x <= x2; ++x)
-            {
-                QRgb rgb = m_image.pixel(x, y);
-                avg_r += qRed(rgb);
-                avg_g += qGreen(rgb);
-                avg_b += qBlue(rgb);
-            }
+            // whole rows at a time straight out of the image memory
+            uint64_t sums[3] = { 0, 0, 0 };
+            uint64_t pixels = (uint64_t)(y2 - y1 + 1) * (x2 - x1 + 1);
+            ColorSum((const uint32_t *)image.bits(),
+                    image.bytesPerLine() / 4, x1, y1,
+                    x2 - x1 + 1, y2 - y1 + 1, sums);
+
+            // ping listeners of the updated tracking color
+            int avg_r = (int)(sums[0] / pixels);
+            int avg_g = (int)(sums[1] / pixels);
+            int avg_b = (int)(sums[2] / pixels);
+            setTrackSettings(avg_r, avg_g, avg_b, -1, -1, -1, -1);
+            emit trackSettingsChanged(avg_r, avg_g, avg_b, -1, -1, -1, -1);
         }
-
-        // ping listeners of the updated tracking color
-        avg_r = (int)(avg_r * inv_pixels);
-        avg_g = (int)(avg_g * inv_pixels);
-        avg_b = (int)(avg_b * inv_pixels);
-        emit trackSettingsChanged(avg_r, avg_g, avg_b, -1, -1, -1, -1);
         
         // disable the dragging rectangle and force an update of the widget
         m_dragging = false;
-        repaint(m_dp.normalized().adjusted(-1, -1, 1, 1));
+        update(m_dp.normalized().adjusted(-1, -1, 1, 1));
     }
 }
 
 // -----------------------------------------------------------------------------
-void VideoView::setVideoFrame(const char *data, size_t length)
+void VideoView::setVideoFrame(const char *data, size_t length,
+        const FrameTiming &timing)
 {
-    Logger::extraDebug(tr("loading image size %1\n").arg(length));
-    if (m_image.loadFromData((const uchar *)data, (int)length))
-    {
-        if (0 != m_angle)
-        {
-            QTransform trans;
-            trans.rotate(m_angle);
-            m_image = m_image.transformed(trans);
-        }
+    Logger::extraDebug("loading image size %1\n", length);
 
-        // reset the heartbeat timeout and force a redraw of the client area
+    FrameTiming received = timing;
+    received.received = MonotonicMicros();
+
+    // the sender's buffer only lives for the duration of the signal, this
+    // one copy is shared by the decoder and the recorder
+    QByteArray frame(data, (int)length);
+    m_decoder->submit(frame, received);
+    if (m_recorder->isOpen())
+        m_recorder->append(frame, MonotonicMicros());
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::onImageReady()
+{
+    if (m_decoder->takeFrame(m_frame))
+    {
+        m_full = QImage();
+        m_framePainted = false;
+        updatePixmap();
+        submitPreview();
+        if (m_groundTracking)
+            m_groundTracker->submit(m_frame, trackThreshold(), m_track.ft);
+
+        // reset the heartbeat timeout, any number of frames arriving before
+        // the next paint still cost only one
         m_ticks = 0;
-        repaint();
+        update();
     }
-    else
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::onOverlayReady()
+{
+    if (m_preview->takeOverlay(m_overlay, m_overlayMatched))
     {
-        // uh oh
-        Logger::err("Video: failed to load image data\n");
+        updateOverlay();
+        if (m_showThreshold)
+            update();
     }
 }
 
+// -----------------------------------------------------------------------------
+void VideoView::onGroundResult()
+{
+    TrackResult result;
+    QSize size;
+    if (!m_groundTracker->takeResult(result, size) || !m_groundTracking)
+        return;
+
+    // like the vehicle's box, only where it was and where it is now
+    QRect dirty = groundDirtyRect();
+    m_ground = result;
+    m_groundSize = size;
+    update(dirty.united(groundDirtyRect()));
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::setGroundTracking(bool enable)
+{
+    QRect dirty = groundDirtyRect();
+    m_groundTracking = enable;
+    m_ground = TrackResult();
+    update(dirty);
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::setThresholdPreview(bool enable)
+{
+    m_showThreshold = enable;
+    m_overlay = QImage();
+    m_overlayPixmap = QPixmap();
+    submitPreview();
+    update();
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::setTrackSettings(int r, int g, int b, int ht, int st, int ft,
+        int fps)
+{
+    // negative values leave a setting as it was, same as the controllers
+    if (r >= 0 && g >= 0 && b >= 0)
+        m_track.color = QColor(r, g, b);
+    if (ht  >= 0) m_track.ht = ht;
+    if (st  >= 0) m_track.st = st;
+    if (ft  >= 0) m_track.ft = ft;
+    if (fps >= 0) m_track.fps = fps;
+
+    // the preview follows straight away, not just on the next frame
+    submitPreview();
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::onColorValuesUpdated(TrackSettings track)
+{
+    m_track = track;
+    submitPreview();
+}
+
 // -----------------------------------------------------------------------------
 void VideoView::setTrackStatus(bool en, const QRect &bb, const QPoint &cp)
 {
+    // the box moves on its own, without waiting for the next frame, and
+    // only where it was and where it is now gets redrawn
+    QRect dirty = trackDirtyRect();
     m_showBox = en;
     m_bbox = bb;
     m_center = cp;
+    update(dirty.united(trackDirtyRect()));
 }
 
 // -----------------------------------------------------------------------------
 void VideoView::setRotation(int angle)
 {
     m_angle = angle;
+    m_decoder->setRotation(angle);
 }
 
 // -----------------------------------------------------------------------------
 void VideoView::onStatusTick()
 {
     ++m_ticks;
+    if (++m_statsTicks >= VIDEO_STATS_TICKS)
+    {
+        m_statsTicks = 0;
+        updateStats();
+    }
+
+    if (++m_latencyTicks >= VIDEO_LATENCY_TICKS)
+    {
+        m_latencyTicks = 0;
+        logLatency();
+    }
 
     // if we exceed the max tick count without receiving a new image from the
     // device, display a test image to bring attention to the operator
     if (m_ticks > m_maxTicks)
     {
-        m_image.load(":/data/test_pattern.jpg");
-        repaint();
+        showTestPattern();
         m_ticks = 0;
     }
 }
 
+// -----------------------------------------------------------------------------
+void VideoView::updateStats()
+{
+    VideoDecodeStats stats = m_decoder->stats();
+    double seconds = m_timer->interval() * VIDEO_STATS_TICKS / 1000.0;
+    double fps = (stats.displayed - m_lastStats.displayed) / seconds;
+    const LatencyHistogram &decode = stats.decode_time;
+
+    emit videoStatsUpdated(tr("Video: %1 fps, %2 dropped, %3 failed, "
+                "decode p50 %4 ms p99 %5 ms")
+            .arg(fps, 0, 'f', 1).arg(stats.dropped).arg(stats.failed)
+            .arg(decode.percentile(0.50) / 1000.0, 0, 'f', 1)
+            .arg(decode.percentile(0.99) / 1000.0, 0, 'f', 1));
+    m_lastStats = stats;
+}
+
+// -----------------------------------------------------------------------------
+void VideoView::logLatency()
+{
+    // nothing new to say while the feed is down
+    if (m_latency.frames() == m_latencyLogged)
+        return;
+
+    Logger::info(m_latency.summary());
+    m_latencyLogged = m_latency.frames();
+}
+
 // -----------------------------------------------------------------------------
 void VideoView::onUpdateTrackControlEnable(int enable)
 {
@@ -311,10 +671,12 @@ void VideoView::onUpdateTrackControlEnable(int enable)
         setBoundingBoxColor(255, 0, 0, 0);
         Logger::info(tr("Video: Box Set to RED\n"));
     }
+    update(trackDirtyRect());
 }
 // -----------------------------------------------------------------------------
 void VideoView::onUpdateColorTrackEnable(int enable)
 {
+    QRect dirty = trackDirtyRect();
     if(!enable){
         m_colorTrack = false;
         Logger::info(tr("Video: track false\n"));
@@ -322,6 +684,6 @@ void VideoView::onUpdateColorTrackEnable(int enable)
         m_colorTrack = true;
         Logger::info(tr("Video: track true\n"));
     }
-    repaint();
+    update(dirty.united(trackDirtyRect()));
 }
 
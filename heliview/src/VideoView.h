@@ -13,9 +13,18 @@
 #include <QMouseEvent>
 #include <QImage>
 #include <QPainter>
+#include <QPixmap>
 #include <QTextEdit>
 #include <QUdpSocket>
 #include <QWidget>
+#include "DeviceController.h"
+#include "GroundTracker.h"
+#include "ThresholdPreview.h"
+#include "VideoDecoder.h"
+#include "VideoRecorder.h"
+
+#define VIDEO_STATS_TICKS   10      // status ticks between stats updates
+#define VIDEO_LATENCY_TICKS 100     // status ticks between latency log entries
 
 class VideoView: public QWidget
 {
@@ -30,37 +39,83 @@ public:
     int timeoutTicks();
     int rotation();
     bool saveFrame();
+    void startRecording(const QString &path);
+    void stopRecording();
+    bool isRecording() const;
+    VideoDecodeStats decodeStats() const;
+    const VideoLatency &latency() const { return m_latency; }
+    GroundTrackStats groundStats() const;
 
 signals:
     void trackSettingsChanged(int r, int g, int b,
             int ht, int st, int ft, int fps);
+    void videoStatsUpdated(const QString &summary);
 
 public slots:
     void setDragBoxColor(int r, int g, int b, int a);
     void setBoundingBoxColor(int r, int g, int b, int a);
     void setTimeoutTicks(int ticks);
-    void setVideoFrame(const char *data, size_t length);
+    void setVideoFrame(const char *data, size_t length,
+            const FrameTiming &timing);
     void setTrackStatus(bool track, const QRect &bb, const QPoint &cp);
     void setRotation(int angle);
+    void setTrackSettings(int r, int g, int b, int ht, int st, int ft, int fps);
+    void setThresholdPreview(bool enable);
+    void setGroundTracking(bool enable);
+    void onColorValuesUpdated(TrackSettings track);
     void onStatusTick();
     void onUpdateTrackControlEnable(int enable);
     void onUpdateColorTrackEnable(int enable);
 
+protected slots:
+    void onImageReady();
+    void onOverlayReady();
+    void onGroundResult();
+
 protected:
+    void updateStats();
+    void logLatency();
+    void showTestPattern();
+    void updatePixmap();
+    void updateOverlay();
+    void submitPreview();
+    ColorThreshold trackThreshold() const;
+    bool trackOverlay(QRect &box, QPoint &center);
+    QRect trackDirtyRect();
+    bool groundOverlay(QRect &box, QPoint &center);
+    QRect groundDirtyRect();
+    const QImage &fullImage();
+
     virtual void paintEvent(QPaintEvent *e);
     virtual void resizeEvent(QResizeEvent *e);
     virtual void mouseMoveEvent(QMouseEvent *e);
     virtual void mousePressEvent(QMouseEvent *e);
     virtual void mouseReleaseEvent(QMouseEvent *e);
 
-    QImage m_image;
+    VideoFrame m_frame;     // frame on screen, image at display size
+    QImage m_full;          // full resolution, decoded only when asked for
+    QPixmap m_pixmap;       // m_frame.image scaled to the widget
+    QImage m_overlay;       // threshold preview of m_frame.image
+    QPixmap m_overlayPixmap;
+    int m_overlayMatched;
+    TrackSettings m_track;
+    ThresholdPreview *m_preview;
+    GroundTracker *m_groundTracker;
+    TrackResult m_ground;   // latest ground side result
+    QSize m_groundSize;     // of the image it was found in
     QTimer *m_timer;
-    int m_angle, m_ticks, m_maxTicks;
-    bool m_showBox, m_dragging, m_colorTrack;
+    VideoDecoder *m_decoder;
+    VideoRecorder *m_recorder;
+    VideoDecodeStats m_lastStats;
+    VideoLatency m_latency;
+    uint64_t m_latencyLogged;
+    int m_angle, m_ticks, m_maxTicks, m_statsTicks, m_latencyTicks;
+    bool m_showBox, m_dragging, m_colorTrack, m_framePainted, m_showThreshold;
+    bool m_groundTracking;
     QRect m_bbox, m_dp;
     QPoint m_center;
     QBrush m_dragBrush, m_bboxBrush;
-    QPen m_dragPen, m_bboxPen;
+    QPen m_dragPen, m_bboxPen, m_groundPen;
 };
 
 #endif // _HELIVIEW_VIDEOVIEW__H_
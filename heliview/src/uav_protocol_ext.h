@@ -0,0 +1,70 @@
+// -----------------------------------------------------------------------------
+// File:    uav_protocol_ext.h
+// Created: 10-17-2026
+//
+// Ground station side protocol extensions that have not (yet) been merged into
+// the shared uav_protocol.h. Every definition is guarded so that the upstream
+// header wins once it carries the same names.
+// -----------------------------------------------------------------------------
+
+#ifndef _HELIVIEW_UAV_PROTOCOL_EXT__H_
+#define _HELIVIEW_UAV_PROTOCOL_EXT__H_
+
+#include "uav_protocol.h"
+
+// capability bits advertised by the vehicle in the version word of its
+// SERVER_REQ_IDENT packet (PKT_RCI_VERSION). older vehicles send a bare
+// header or a plain IDENT_VERSION, which reads back as "no capabilities".
+#ifndef IDENT_CAP_MASK
+#define IDENT_CAP_MASK          0xFFFF0000
+#define IDENT_CAP_SUBSCRIBE     0x00010000  // understands CLIENT_REQ_SUBSCRIBE
+#endif
+
+#ifndef IDENT_CAP_VIDEO_PORT
+#define IDENT_CAP_VIDEO_PORT    0x00020000  // serves video on its own socket
+#define IDENT_CAP_PING          0x00040000  // echoes CLIENT_REQ_PING
+#endif
+
+// -----------------------------------------------------------------------------
+// subscribe: ask the vehicle to push a channel at a fixed rate until told to
+// stop (rate of zero). samples arrive as the usual SERVER_ACK_* packets.
+#ifndef CLIENT_REQ_SUBSCRIBE
+#define CLIENT_REQ_SUBSCRIBE    0x8001
+
+#define SUB_CHANNEL_TELEMETRY   0           // SERVER_ACK_TELEMETRY
+#define SUB_CHANNEL_MJPG        1           // SERVER_ACK_MJPG_FRAME
+
+#define PKT_SUB_CHANNEL         (PKT_BASE + 0)
+#define PKT_SUB_RATE            (PKT_BASE + 1)  // samples per second, 0 = stop
+#define PKT_SUB_NUM             (PKT_BASE + 2)
+#define PKT_SUB_LENGTH          (PKT_SUB_NUM * 4)
+#endif
+
+// -----------------------------------------------------------------------------
+// video port: ask the vehicle where its video-only socket listens. once the
+// client connects there, every SERVER_ACK_MJPG_FRAME (pushed or requested on
+// that socket) is sent on it instead of the control socket.
+#ifndef CLIENT_REQ_VIDEO_PORT
+#define CLIENT_REQ_VIDEO_PORT   0x8002
+#define SERVER_ACK_VIDEO_PORT   0x8003
+
+#define PKT_VPORT_PORT          (PKT_BASE + 0)  // tcp port, 0 = unavailable
+#define PKT_VPORT_NUM           (PKT_BASE + 1)
+#define PKT_VPORT_LENGTH        (PKT_VPORT_NUM * 4)
+#endif
+
+// -----------------------------------------------------------------------------
+// ping: echoed back untouched as SERVER_ACK_PING on the socket it arrived on,
+// used to measure the round trip of each channel.
+#ifndef CLIENT_REQ_PING
+#define CLIENT_REQ_PING         0x8004
+#define SERVER_ACK_PING         0x8005
+
+#define PKT_PING_CHANNEL        (PKT_BASE + 0)  // SUB_CHANNEL_* it was sent on
+#define PKT_PING_TIME_LO        (PKT_BASE + 1)  // client timestamp, usec
+#define PKT_PING_TIME_HI        (PKT_BASE + 2)
+#define PKT_PING_NUM            (PKT_BASE + 3)
+#define PKT_PING_LENGTH         (PKT_PING_NUM * 4)
+#endif
+
+#endif // _HELIVIEW_UAV_PROTOCOL_EXT__H_
@@ -0,0 +1,115 @@
+// -----------------------------------------------------------------------------
+// File:    FramerTest.cpp
+// Created: 10-17-2026
+//
+// PacketFramer across its ring growing part way through a stream. Packets
+// must come out whole and in order, and the stream positions must carry on
+// counting rather than start over.
+// -----------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "PacketFramer.h"
+#include "uav_protocol.h"
+
+#define TEST_SMALL_WORDS    37      // odd sizes so packets straddle the wrap
+#define TEST_LARGE_BYTES    (FRAMER_INITIAL_SIZE + 4096)
+#define TEST_CHUNK          1000    // bytes handed over per commit at most
+
+#define CHECK(cond) \
+    do { if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        return false; } } while (0)
+
+// -----------------------------------------------------------------------------
+// a packet of length bytes whose body words all hold tag
+static void appendPacket(std::vector<char> &stream, uint32_t tag,
+        uint32_t length)
+{
+    std::vector<uint32_t> words(length / sizeof(uint32_t), tag);
+    words[PKT_COMMAND] = tag;
+    words[PKT_LENGTH]  = length;
+
+    const char *bytes = (const char *)&words[0];
+    stream.insert(stream.end(), bytes, bytes + length);
+}
+
+// -----------------------------------------------------------------------------
+static bool checkPacket(const PacketView &view, uint32_t tag, uint32_t length)
+{
+    CHECK(view.length == length);
+    CHECK(view.command() == tag);
+    for (uint32_t i = PKT_BASE; i < length / sizeof(uint32_t); ++i)
+        CHECK(view.words[i] == tag);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+static bool testGrowKeepsPositions()
+{
+    // enough small packets to lap the initial ring, then one that can't fit
+    // in it, then small ones again
+    std::vector<char> stream;
+    std::vector<uint32_t> lengths;
+    const uint32_t small = TEST_SMALL_WORDS * sizeof(uint32_t);
+    for (uint32_t i = 0; i < 3 * FRAMER_INITIAL_SIZE / small; ++i)
+        lengths.push_back(small);
+    lengths.push_back(TEST_LARGE_BYTES);
+    for (uint32_t i = 0; i < 100; ++i)
+        lengths.push_back(small);
+
+    for (size_t i = 0; i < lengths.size(); ++i)
+        appendPacket(stream, (uint32_t)i + 1, lengths[i]);
+
+    PacketFramer framer;
+    PacketView view;
+    size_t fed = 0, packets = 0;
+    uint64_t consumed = 0;
+    bool grew = false;
+    while (packets < lengths.size())
+    {
+        // what the network code remembers about each packet's start
+        uint64_t start = framer.readPosition();
+        if (framer.next(view))
+        {
+            CHECK(start == consumed);
+            CHECK(checkPacket(view, (uint32_t)packets + 1, lengths[packets]));
+            consumed += view.length;
+            CHECK(framer.readPosition() == consumed);
+            ++packets;
+            continue;
+        }
+        CHECK(!framer.error());
+        CHECK(fed < stream.size());
+
+        size_t capacity = framer.capacity(), avail;
+        char *dst = framer.prepare(avail);
+        grew = grew || (framer.capacity() != capacity);
+        CHECK(framer.readPosition() == consumed);
+        CHECK(framer.writePosition() == fed);
+
+        size_t count = std::min(std::min(avail, (size_t)TEST_CHUNK),
+                stream.size() - fed);
+        memcpy(dst, &stream[fed], count);
+        framer.commit(count);
+        fed += count;
+        CHECK(framer.writePosition() == fed);
+    }
+
+    CHECK(grew);
+    CHECK(fed == stream.size());
+    CHECK(framer.buffered() == 0);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+int main()
+{
+    int failed = 0;
+    failed += testGrowKeepsPositions() ? 0 : 1;
+
+    printf("%s\n", failed ? "FAILED" : "passed");
+    return failed ? 1 : 0;
+}
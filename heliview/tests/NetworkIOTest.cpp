@@ -0,0 +1,173 @@
+// -----------------------------------------------------------------------------
+// File:    NetworkIOTest.cpp
+// Created: 10-17-2026
+//
+// NetworkIO against a server on the loopback interface. Checks that what the
+// server reads back is what was sent, in the order it was sent, and that the
+// arrival times given to incoming packets stay current as the framer grows.
+// -----------------------------------------------------------------------------
+
+#include <vector>
+#include <QCoreApplication>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <cstdio>
+#include "NetworkIO.h"
+#include "Utility.h"
+#include "uav_protocol.h"
+
+#define TEST_WAIT_MS        5000    // longest wait for any one step
+#define TEST_CMD_PLAIN      0x7e000001
+#define TEST_CMD_COALESCED  0x7e000002
+#define TEST_CMD_COALESCED2 0x7e000003
+#define TEST_CMD_INBOUND    0x7e000004
+#define TEST_SMALL_PACKETS  50      // moves the stream well away from zero
+#define TEST_LARGE_BYTES    (FRAMER_INITIAL_SIZE + 4096)
+
+#define CHECK(cond) \
+    do { if (!(cond)) { \
+        fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+        return false; } } while (0)
+
+// -----------------------------------------------------------------------------
+// run the event loop until cond holds or we give up
+#define WAIT_FOR(cond) \
+    do { uint64_t deadline = MonotonicMicros() + TEST_WAIT_MS * 1000; \
+        while (!(cond) && MonotonicMicros() < deadline) \
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 10); \
+    } while (0)
+
+// -----------------------------------------------------------------------------
+// a header plus body words telling the packets apart
+static QByteArray makePacket(uint32_t command, uint32_t tag,
+        uint32_t length = PKT_BASE_LENGTH + sizeof(uint32_t))
+{
+    std::vector<uint32_t> words(length / sizeof(uint32_t), tag);
+    words[PKT_COMMAND] = command;
+    words[PKT_LENGTH]  = length;
+    return QByteArray((const char *)&words[0], length);
+}
+
+// -----------------------------------------------------------------------------
+// keeps the tag and timing of every packet the io hands over
+class TimingRecorder: public PacketHandler
+{
+public:
+    virtual void processPacket(const uint32_t *packet,
+            const PacketTiming &timing)
+    {
+        tags.push_back(packet[PKT_BASE]);
+        timings.push_back(timing);
+    }
+
+    std::vector<uint32_t>     tags;
+    std::vector<PacketTiming> timings;
+};
+
+// -----------------------------------------------------------------------------
+// connect io to a fresh server, returns the server's end
+static QTcpSocket *connectPair(QTcpServer &server, NetworkIO &io)
+{
+    if (!server.listen(QHostAddress::LocalHost))
+        return NULL;
+
+    io.connectSocket("127.0.0.1", server.serverPort());
+    WAIT_FOR(io.isConnected() && server.hasPendingConnections());
+    return server.nextPendingConnection();
+}
+
+// -----------------------------------------------------------------------------
+// coalesced commands take their place in line among the plain ones
+static bool testOutboundOrder()
+{
+    QTcpServer server;
+    NetworkIO io;
+    QTcpSocket *peer = connectPair(server, io);
+    CHECK(peer && io.isConnected());
+
+    // one event loop turn, so all of this leaves in a single flush
+    CHECK(io.enqueue(makePacket(TEST_CMD_PLAIN, 1)));
+    CHECK(io.enqueue(makePacket(TEST_CMD_COALESCED, 2), true));
+    CHECK(io.enqueue(makePacket(TEST_CMD_PLAIN, 3)));
+    CHECK(io.enqueue(makePacket(TEST_CMD_COALESCED2, 4), true));
+    CHECK(io.enqueue(makePacket(TEST_CMD_COALESCED, 5), true));
+    CHECK(io.enqueue(makePacket(TEST_CMD_PLAIN, 6)));
+    CHECK(io.enqueue(makePacket(TEST_CMD_COALESCED2, 7), true));
+
+    // 2 and 4 were superseded, 5 and 7 go out where they were sent
+    const uint32_t expected[] = { 1, 3, 5, 6, 7 };
+    const int count = sizeof(expected) / sizeof(expected[0]);
+    const int size = makePacket(0, 0).size();
+    WAIT_FOR(peer->bytesAvailable() >= count * size);
+
+    QByteArray data = peer->readAll();
+    CHECK(data.size() == count * size);
+    for (int i = 0; i < count; ++i)
+    {
+        const uint32_t *words = (const uint32_t *)(data.constData() + i * size);
+        CHECK(words[PKT_BASE] == expected[i]);
+    }
+
+    CHECK(io.stats().superseded == 2);
+    io.closeSocket();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// a packet too big for the framer's first ring makes it grow with data
+// buffered, the packets after it must still be timed by their own reads
+static bool testTimingAcrossGrow()
+{
+    QTcpServer server;
+    NetworkIO io;
+    TimingRecorder recorder;
+    io.setPacketHandler(&recorder);
+    QTcpSocket *peer = connectPair(server, io);
+    CHECK(peer && io.isConnected());
+
+    uint32_t tag = 0;
+    for (int i = 0; i < TEST_SMALL_PACKETS; ++i)
+        peer->write(makePacket(TEST_CMD_INBOUND, ++tag));
+    WAIT_FOR(recorder.tags.size() == tag);
+    CHECK(recorder.tags.size() == tag);
+
+    uint64_t sent = MonotonicMicros();
+    peer->write(makePacket(TEST_CMD_INBOUND, ++tag, TEST_LARGE_BYTES));
+    peer->write(makePacket(TEST_CMD_INBOUND, ++tag));
+    WAIT_FOR(recorder.tags.size() == tag);
+    CHECK(recorder.tags.size() == tag);
+
+    // and once more after the grow with nothing left buffered
+    uint64_t resent = MonotonicMicros();
+    peer->write(makePacket(TEST_CMD_INBOUND, ++tag));
+    WAIT_FOR(recorder.tags.size() == tag);
+    CHECK(recorder.tags.size() == tag);
+
+    for (size_t i = 0; i < recorder.tags.size(); ++i)
+    {
+        const PacketTiming &t = recorder.timings[i];
+        CHECK(recorder.tags[i] == i + 1);
+        CHECK(t.first_byte && t.last_byte >= t.first_byte);
+        if (i > 0)
+            CHECK(t.last_byte >= recorder.timings[i - 1].last_byte);
+        if (i >= TEST_SMALL_PACKETS)
+            CHECK(t.first_byte >= sent);
+    }
+    CHECK(recorder.timings.back().first_byte >= resent);
+
+    io.closeSocket();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    int failed = 0;
+    failed += testOutboundOrder() ? 0 : 1;
+    failed += testTimingAcrossGrow() ? 0 : 1;
+
+    printf("%s\n", failed ? "FAILED" : "passed");
+    return failed ? 1 : 0;
+}